@@ -1,10 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <string_view>
 #include <system_error>
 #include <type_traits>
+#include <vector>
 
 #include "pe_bliss2/bound_import/bound_library.h"
+#include "pe_bliss2/pe_types.h"
 
 namespace pe_bliss::image
 {
@@ -33,6 +38,55 @@ struct [[nodiscard]] loader_options
 std::optional<bound_library_details_list> load(const image::image& instance,
 	const loader_options& options = {});
 
+//Bound import list with library descriptors and names loaded,
+//whose forwarder references are loaded on first request.
+//The image must outlive this object.
+class [[nodiscard]] lazy_bound_library_list
+{
+public:
+	lazy_bound_library_list(const image::image& instance,
+		const loader_options& options);
+
+	//Libraries which were not resolved have empty reference lists
+	[[nodiscard]]
+	const bound_library_details_list& get_list() const noexcept
+	{
+		return list_;
+	}
+
+	[[nodiscard]]
+	std::size_t size() const noexcept
+	{
+		return list_.size();
+	}
+
+	[[nodiscard]]
+	bool is_resolved(std::size_t index) const
+	{
+		return resolved_.at(index);
+	}
+
+	//Case-insensitive search, returns the index of the first library found
+	[[nodiscard]]
+	std::optional<std::size_t> find_library(std::string_view name) const noexcept;
+
+	const bound_library_details& get(std::size_t index);
+	const bound_library_details_list& resolve_all();
+
+private:
+	const image::image& instance_;
+	loader_options options_;
+	rva_type start_rva_;
+	std::uint32_t descriptors_end_offset_{};
+	bound_library_details_list list_;
+	std::vector<rva_type> references_rvas_;
+	std::vector<bool> resolved_;
+};
+
+[[nodiscard]]
+std::optional<lazy_bound_library_list> load_lazy(const image::image& instance,
+	const loader_options& options = {});
+
 } //namespace pe_bliss::bound_import
 
 namespace std
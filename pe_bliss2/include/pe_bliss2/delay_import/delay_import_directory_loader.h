@@ -18,4 +18,11 @@ namespace pe_bliss::delay_import
 std::optional<delay_import_directory_details> load(const image::image& instance,
 	const imports::loader_options& options = {});
 
+using lazy_delay_import_directory
+	= imports::lazy_import_directory_base<delay_import_directory_details>;
+
+[[nodiscard]]
+std::optional<lazy_delay_import_directory> load_lazy(const image::image& instance,
+	const imports::loader_options& options = {});
+
 } //namespace pe_bliss::delay_import
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <optional>
 #include <system_error>
 #include <type_traits>
 
+#include "pe_bliss2/exceptions/arm_common/arm_common_exception_directory_loader.h"
 #include "pe_bliss2/exceptions/exception_directory.h"
+#include "pe_bliss2/exceptions/lazy_exception_directory.h"
 
 namespace pe_bliss::image
 {
@@ -29,6 +32,16 @@ struct [[nodiscard]] loader_options
 void load(const image::image& instance, const loader_options& options,
 	pe_bliss::exceptions::exception_directory_details& directory);
 
+using lazy_exception_directory = pe_bliss::exceptions::lazy_exception_directory<
+	runtime_function_details, loader_options,
+	arm_common::exception_directory_loader_errc>;
+
+//Reads only the raw runtime function array, unwind info
+//is decoded on first access to each runtime function
+[[nodiscard]]
+std::optional<lazy_exception_directory> load_lazy(const image::image& instance,
+	const loader_options& options);
+
 } //namespace pe_bliss::exceptions::arm
 
 namespace std
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <system_error>
 #include <type_traits>
 #include <variant>
@@ -216,6 +217,39 @@ void load_runtime_function(const image::image& instance, const LoaderOptions& op
 	}
 }
 
+template<typename PackedUnwindData, typename ExtendedUnwindRecord,
+	typename LoaderOptions, typename RuntimeFunction>
+void decode_runtime_function(const image::image& instance, const LoaderOptions& options,
+	rva_type current_rva, RuntimeFunction& func)
+{
+	try
+	{
+		load_runtime_function<PackedUnwindData, ExtendedUnwindRecord>(
+			instance, options, current_rva, func);
+	}
+	catch (const std::system_error&)
+	{
+		func.add_error(exception_directory_loader_errc::invalid_runtime_function_entry);
+	}
+}
+
+template<typename ExceptionDirectoryControl, typename PackedUnwindData,
+	typename ExtendedUnwindRecord, typename LazyExceptionDirectory, typename LoaderOptions>
+std::optional<LazyExceptionDirectory> load_lazy(const image::image& instance,
+	const LoaderOptions& options)
+{
+	std::optional<LazyExceptionDirectory> result;
+	auto [rva, size] = ExceptionDirectoryControl
+		::get_exception_directory(instance, options);
+	if (!rva)
+		return result;
+
+	result.emplace(instance, options,
+		&decode_runtime_function<PackedUnwindData, ExtendedUnwindRecord, LoaderOptions,
+			typename LazyExceptionDirectory::runtime_function_type>, rva, size);
+	return result;
+}
+
 template<typename ExceptionDirectoryControl, typename PackedUnwindData,
 	typename ExtendedUnwindRecord, typename ExceptionDirectory, typename LoaderOptions,
 	typename DirectoryContainer>
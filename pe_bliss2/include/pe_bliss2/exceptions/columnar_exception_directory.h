@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "pe_bliss2/exceptions/arm64/arm64_exception_directory.h"
+#include "pe_bliss2/exceptions/x64/x64_exception_directory.h"
+#include "pe_bliss2/pe_types.h"
+
+namespace pe_bliss::exceptions
+{
+
+//Exception directory storage, which keeps begin RVAs, end RVAs and
+//unwind data (unwind info RVAs for x64, raw unwind data for ARM64) of
+//runtime functions in separate contiguous arrays. Runtime functions
+//with decoded unwind info are kept in the side table with the same
+//order as the columns. Runtime functions are sorted by begin RVA
+//on construction. Functions, the end RVA of which can not be determined
+//(ARM64 functions without loaded unwind info), have the end RVA equal
+//to the begin RVA and are never found.
+template<typename RuntimeFunction>
+class [[nodiscard]] columnar_exception_directory
+{
+public:
+	using runtime_function_type = RuntimeFunction;
+	using runtime_function_list_type = std::vector<RuntimeFunction>;
+
+public:
+	columnar_exception_directory() = default;
+	explicit columnar_exception_directory(runtime_function_list_type&& list);
+
+	[[nodiscard]]
+	std::size_t size() const noexcept
+	{
+		return begin_rvas_.size();
+	}
+
+	[[nodiscard]]
+	bool empty() const noexcept
+	{
+		return begin_rvas_.empty();
+	}
+
+	[[nodiscard]]
+	std::span<const rva_type> get_begin_rvas() const noexcept
+	{
+		return begin_rvas_;
+	}
+
+	[[nodiscard]]
+	std::span<const rva_type> get_end_rvas() const noexcept
+	{
+		return end_rvas_;
+	}
+
+	[[nodiscard]]
+	std::span<const std::uint32_t> get_unwind_data() const noexcept
+	{
+		return unwind_data_;
+	}
+
+	[[nodiscard]]
+	const runtime_function_list_type& get_runtime_function_list() const noexcept
+	{
+		return runtime_functions_;
+	}
+
+	//Returns the position of the function, which contains the rva
+	[[nodiscard]]
+	std::optional<std::size_t> find(rva_type rva) const noexcept;
+
+	//Returns the number of bytes covered by runtime functions.
+	//Overlapping ranges are counted once.
+	[[nodiscard]]
+	std::uint64_t get_covered_size() const noexcept;
+
+	[[nodiscard]]
+	runtime_function_list_type release() && noexcept;
+
+private:
+	std::vector<rva_type> begin_rvas_;
+	std::vector<rva_type> end_rvas_;
+	std::vector<std::uint32_t> unwind_data_;
+	runtime_function_list_type runtime_functions_;
+};
+
+} //namespace pe_bliss::exceptions
+
+namespace pe_bliss::exceptions::x64
+{
+
+using columnar_exception_directory
+	= exceptions::columnar_exception_directory<runtime_function>;
+using columnar_exception_directory_details
+	= exceptions::columnar_exception_directory<runtime_function_details>;
+
+} //namespace pe_bliss::exceptions::x64
+
+namespace pe_bliss::exceptions::arm64
+{
+
+using columnar_exception_directory
+	= exceptions::columnar_exception_directory<runtime_function>;
+using columnar_exception_directory_details
+	= exceptions::columnar_exception_directory<runtime_function_details>;
+
+} //namespace pe_bliss::exceptions::arm64
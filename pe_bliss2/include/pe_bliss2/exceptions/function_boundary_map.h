@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/pe_types.h"
+
+#include "utilities/static_class.h"
+
+namespace pe_bliss::image
+{
+class image;
+} //namespace pe_bliss::image
+
+namespace pe_bliss::exceptions
+{
+
+enum class function_boundary_map_errc
+{
+	mismatched_end_rva_count = 1,
+	invalid_exception_directory,
+	invalid_load_config_directory,
+	invalid_export_directory
+};
+
+std::error_code make_error_code(function_boundary_map_errc) noexcept;
+
+struct function_start_source final : utilities::static_class
+{
+	enum value : std::uint8_t
+	{
+		runtime_function = 1u << 0u,
+		guard_cf_function = 1u << 1u,
+		exported_function = 1u << 2u
+	};
+};
+
+//Sorted (ascending) list of function start RVAs from a single source.
+//end_rvas is either empty or has the same size as begin_rvas.
+//End RVAs, which are not greater than the corresponding begin RVAs,
+//are treated as unknown. Unsorted lists are sorted before merging.
+struct [[nodiscard]] function_start_list
+{
+	std::span<const rva_type> begin_rvas;
+	std::span<const rva_type> end_rvas;
+	function_start_source::value source{};
+};
+
+struct [[nodiscard]] function_range
+{
+	rva_type begin{};
+	rva_type end{};
+
+	[[nodiscard]]
+	friend bool operator==(const function_range&, const function_range&) = default;
+};
+
+//Sorted deduplicated set of function start RVAs, merged from
+//several sources. Each function spans from its start RVA to its known
+//end RVA (if any), but never further than the next function start.
+//Functions without known end RVAs span up to the next function start,
+//the last one spans up to the image end RVA.
+class [[nodiscard]] function_boundary_map : public error_list
+{
+public:
+	function_boundary_map() = default;
+	function_boundary_map(std::span<const function_start_list> lists,
+		rva_type image_end_rva);
+
+	[[nodiscard]]
+	std::size_t size() const noexcept
+	{
+		return starts_.size();
+	}
+
+	[[nodiscard]]
+	bool empty() const noexcept
+	{
+		return starts_.empty();
+	}
+
+	[[nodiscard]]
+	std::span<const rva_type> get_starts() const noexcept
+	{
+		return starts_;
+	}
+
+	//Combination of function_start_source flags for each start RVA
+	[[nodiscard]]
+	std::span<const std::uint8_t> get_sources() const noexcept
+	{
+		return sources_;
+	}
+
+	[[nodiscard]]
+	function_range get_range(std::size_t index) const noexcept;
+
+	//Returns true if the rva is a function start
+	[[nodiscard]]
+	bool contains(rva_type rva) const noexcept;
+
+	//Returns the position of the function, the range of which contains the rva
+	[[nodiscard]]
+	std::optional<std::size_t> find(rva_type rva) const noexcept;
+
+	//Returns function starts in the [first, last) range
+	[[nodiscard]]
+	std::span<const rva_type> get_starts_in(rva_type first,
+		rva_type last) const noexcept;
+
+	//Returns the number of bytes covered by function ranges
+	[[nodiscard]]
+	std::uint64_t get_covered_size() const noexcept;
+
+private:
+	std::vector<rva_type> starts_;
+	std::vector<rva_type> ends_;
+	std::vector<std::uint8_t> sources_;
+};
+
+struct [[nodiscard]] function_boundary_map_options
+{
+	bool include_headers = true;
+	bool allow_virtual_data = false;
+	bool use_runtime_functions = true;
+	bool use_guard_cf_function_table = true;
+	bool use_exports = true;
+};
+
+//Merges x64 and ARM64 runtime functions, CF guard function table
+//entries and non-forwarded exported address RVAs of the image.
+//Directories, which fail to load, are reported as errors
+//of the resulting map.
+[[nodiscard]]
+function_boundary_map build_function_boundary_map(const image::image& instance,
+	const function_boundary_map_options& options = {});
+
+} //namespace pe_bliss::exceptions
+
+namespace std
+{
+template<>
+struct is_error_code_enum<pe_bliss::exceptions::function_boundary_map_errc> : true_type {};
+} //namespace std
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include "buffers/input_buffer_stateful_wrapper.h"
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/image/section_data_from_va.h"
+#include "pe_bliss2/image/struct_from_va.h"
+#include "pe_bliss2/pe_types.h"
+#include "utilities/math.h"
+
+namespace pe_bliss::exceptions
+{
+
+//Exception directory, which reads only the raw runtime function array
+//when loaded. Unwind info (with unwind codes, chained functions, exception
+//handlers and scope tables) of each runtime function is decoded on first
+//access and cached. Runtime functions are indexed exactly as they appear
+//in the directory, null entries included.
+//The image is referenced, not copied, and must outlive the directory.
+//Decoding is not thread-safe.
+template<typename RuntimeFunction, typename LoaderOptions, typename LoaderErrc>
+class [[nodiscard]] lazy_exception_directory : public error_list
+{
+public:
+	using runtime_function_type = RuntimeFunction;
+	using descriptor_type = typename RuntimeFunction::descriptor_type;
+	using underlying_struct_type = typename RuntimeFunction::underlying_struct_type;
+	using loader_options_type = LoaderOptions;
+	using decoder_type = void(*)(const image::image& instance,
+		const LoaderOptions& options, rva_type rva, RuntimeFunction& func);
+
+public:
+	lazy_exception_directory(const image::image& instance,
+		const LoaderOptions& options, decoder_type decoder,
+		rva_type rva, std::uint32_t size)
+		: instance_(&instance)
+		, options_(options)
+		, decoder_(decoder)
+		, rva_(rva)
+	{
+		if (!utilities::math::is_sum_safe(rva, size))
+		{
+			add_error(LoaderErrc::invalid_directory_size);
+			return;
+		}
+
+		if (size % descriptor_type::packed_size)
+			add_error(LoaderErrc::unmatched_directory_size);
+
+		load_descriptors(size / descriptor_type::packed_size);
+		functions_.resize(descriptors_.size());
+	}
+
+	[[nodiscard]]
+	std::size_t size() const noexcept
+	{
+		return descriptors_.size();
+	}
+
+	[[nodiscard]]
+	bool empty() const noexcept
+	{
+		return descriptors_.empty();
+	}
+
+	[[nodiscard]]
+	rva_type get_rva() const noexcept
+	{
+		return rva_;
+	}
+
+	//Returns the RVA of the runtime function entry
+	[[nodiscard]]
+	rva_type get_rva(std::size_t index) const noexcept
+	{
+		return rva_ + static_cast<rva_type>(index * descriptor_type::packed_size);
+	}
+
+	//Returns the raw runtime function entry without decoding its unwind info
+	[[nodiscard]]
+	const underlying_struct_type& get_descriptor(std::size_t index) const
+	{
+		return descriptors_.at(index);
+	}
+
+	//Decodes the runtime function on first access.
+	//Decoding errors are reported to the runtime function error list.
+	[[nodiscard]]
+	const runtime_function_type& get_runtime_function(std::size_t index) const
+	{
+		auto& func = functions_.at(index);
+		if (!func)
+		{
+			auto decoded = std::make_unique<runtime_function_type>();
+			decoder_(*instance_, options_, get_rva(index), *decoded);
+			func = std::move(decoded);
+		}
+		return *func;
+	}
+
+	[[nodiscard]]
+	bool is_decoded(std::size_t index) const
+	{
+		return functions_.at(index) != nullptr;
+	}
+
+private:
+	void load_descriptors(std::uint32_t count)
+	{
+		descriptors_.reserve(count);
+		try
+		{
+			auto data = image::section_data_from_rva(*instance_, rva_,
+				count * descriptor_type::packed_size, options_.include_headers,
+				options_.allow_virtual_data);
+			buffers::input_buffer_stateful_wrapper_ref wrapper(*data);
+			descriptor_type descriptor;
+			while (descriptors_.size() != count)
+			{
+				descriptor.deserialize(wrapper, options_.allow_virtual_data);
+				descriptors_.push_back(descriptor.get());
+			}
+		}
+		catch (const std::system_error&)
+		{
+			//Read the rest entry by entry to find the first invalid one
+		}
+
+		for (auto index = descriptors_.size(); index != count; ++index)
+		{
+			descriptor_type descriptor;
+			try
+			{
+				struct_from_rva(*instance_, get_rva(index), descriptor,
+					options_.include_headers, options_.allow_virtual_data);
+			}
+			catch (const std::system_error&)
+			{
+				add_error(LoaderErrc::invalid_runtime_function_entry, index);
+				break;
+			}
+			descriptors_.push_back(descriptor.get());
+		}
+	}
+
+private:
+	const image::image* instance_;
+	LoaderOptions options_;
+	decoder_type decoder_;
+	rva_type rva_;
+	std::vector<underlying_struct_type> descriptors_;
+	mutable std::vector<std::unique_ptr<runtime_function_type>> functions_;
+};
+
+} //namespace pe_bliss::exceptions
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/exceptions/arm64/arm64_exception_directory.h"
+#include "pe_bliss2/exceptions/x64/x64_exception_directory.h"
+#include "pe_bliss2/pe_types.h"
+
+namespace pe_bliss::exceptions
+{
+
+struct [[nodiscard]] runtime_function_index_options
+{
+	//Build the first-level table with the range of candidate
+	//functions for each 4K page. Takes 4 bytes per page.
+	bool build_page_table = false;
+};
+
+//Maps RVAs to the runtime functions containing them, using a binary
+//search over function begin RVAs. The runtime function list is
+//referenced, not copied, and must outlive the index. If the list is not
+//sorted by begin RVA (which is required by the PE format), the index
+//additionally stores the sorted order of the functions.
+//Functions, the end RVA of which can not be determined
+//(ARM64 functions without loaded unwind info), are never found.
+template<typename RuntimeFunction>
+class [[nodiscard]] runtime_function_index
+{
+public:
+	using runtime_function_type = RuntimeFunction;
+	using runtime_function_list_type = std::vector<RuntimeFunction>;
+
+public:
+	explicit runtime_function_index(const runtime_function_list_type& list,
+		const runtime_function_index_options& options = {});
+
+	//Returns the function, which contains the rva
+	[[nodiscard]]
+	const runtime_function_type* find(rva_type rva) const noexcept;
+
+	//Returns the function, which starts at the rva
+	[[nodiscard]]
+	const runtime_function_type* find_by_begin_rva(rva_type rva) const noexcept;
+
+	[[nodiscard]]
+	const runtime_function_list_type& get_runtime_function_list() const noexcept
+	{
+		return list_;
+	}
+
+	[[nodiscard]]
+	bool has_page_table() const noexcept
+	{
+		return !page_table_.empty();
+	}
+
+private:
+	[[nodiscard]]
+	const runtime_function_type& at(std::size_t position) const noexcept
+	{
+		return order_.empty() ? list_[position] : list_[order_[position]];
+	}
+
+	[[nodiscard]]
+	std::size_t upper_bound(rva_type rva) const noexcept;
+
+private:
+	const runtime_function_list_type& list_;
+	//Sorted positions, empty if the list is already sorted
+	std::vector<std::uint32_t> order_;
+	//Position of the first function starting at or after each page
+	std::vector<std::uint32_t> page_table_;
+	rva_type first_page_{};
+};
+
+[[nodiscard]]
+rva_type get_begin_rva(const x64::runtime_function& func) noexcept;
+[[nodiscard]]
+rva_type get_begin_rva(const x64::runtime_function_details& func) noexcept;
+[[nodiscard]]
+rva_type get_begin_rva(const arm64::runtime_function& func) noexcept;
+[[nodiscard]]
+rva_type get_begin_rva(const arm64::runtime_function_details& func) noexcept;
+
+//Returns the end RVA (exclusive) of the function, or the begin RVA
+//if the end RVA is unknown
+[[nodiscard]]
+rva_type get_end_rva(const x64::runtime_function& func) noexcept;
+[[nodiscard]]
+rva_type get_end_rva(const x64::runtime_function_details& func) noexcept;
+[[nodiscard]]
+rva_type get_end_rva(const arm64::runtime_function& func) noexcept;
+[[nodiscard]]
+rva_type get_end_rva(const arm64::runtime_function_details& func) noexcept;
+
+} //namespace pe_bliss::exceptions
+
+namespace pe_bliss::exceptions::x64
+{
+
+using runtime_function_index = exceptions::runtime_function_index<runtime_function>;
+using runtime_function_index_details
+	= exceptions::runtime_function_index<runtime_function_details>;
+
+//Follows chained unwind info (UNW_FLAG_CHAININFO) of the function
+//and returns the primary function from the index, or nullptr if the
+//chain is broken or the primary function is not in the index
+[[nodiscard]]
+const runtime_function* find_primary_function(
+	const runtime_function_index& index, const runtime_function& func) noexcept;
+[[nodiscard]]
+const runtime_function_details* find_primary_function(
+	const runtime_function_index_details& index,
+	const runtime_function_details& func) noexcept;
+
+//Returns the primary function for the function containing the rva
+[[nodiscard]]
+const runtime_function* find_primary_function(
+	const runtime_function_index& index, rva_type rva) noexcept;
+[[nodiscard]]
+const runtime_function_details* find_primary_function(
+	const runtime_function_index_details& index, rva_type rva) noexcept;
+
+} //namespace pe_bliss::exceptions::x64
+
+namespace pe_bliss::exceptions::arm64
+{
+
+using runtime_function_index = exceptions::runtime_function_index<runtime_function>;
+using runtime_function_index_details
+	= exceptions::runtime_function_index<runtime_function_details>;
+
+} //namespace pe_bliss::exceptions::arm64
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/exceptions/runtime_function_index.h"
+#include "pe_bliss2/exceptions/x64/x64_exception_directory.h"
+#include "pe_bliss2/exceptions/x64/x64_exception_directory_loader.h"
+#include "pe_bliss2/pe_types.h"
+
+namespace pe_bliss::image
+{
+class image;
+} //namespace pe_bliss::image
+
+namespace pe_bliss::exceptions::x64
+{
+
+enum class unwinder_errc
+{
+	overlapping_images = 1,
+	unknown_instruction_pointer,
+	unable_to_read_memory,
+	invalid_unwind_info,
+	invalid_stack_pointer,
+	unknown_runtime_function
+};
+
+std::error_code make_error_code(unwinder_errc) noexcept;
+
+struct [[nodiscard]] xmm_register
+{
+	std::uint64_t low{};
+	std::uint64_t high{};
+
+	[[nodiscard]]
+	friend bool operator==(const xmm_register&, const xmm_register&) = default;
+};
+
+struct [[nodiscard]] unwind_context
+{
+	std::uint64_t rip{};
+	//Indexed by register_id
+	std::array<std::uint64_t, 16u> registers{};
+	std::array<xmm_register, 16u> xmm{};
+
+	[[nodiscard]]
+	std::uint64_t& get_register(register_id id) noexcept
+	{
+		return registers[static_cast<std::size_t>(id)];
+	}
+
+	[[nodiscard]]
+	std::uint64_t get_register(register_id id) const noexcept
+	{
+		return registers[static_cast<std::size_t>(id)];
+	}
+
+	[[nodiscard]]
+	std::uint64_t& get_rsp() noexcept
+	{
+		return get_register(register_id::rsp);
+	}
+
+	[[nodiscard]]
+	std::uint64_t get_rsp() const noexcept
+	{
+		return get_register(register_id::rsp);
+	}
+};
+
+//Unwind code in the form, which is cheap to replay
+struct [[nodiscard]] unwind_operation
+{
+	enum class type : std::uint8_t
+	{
+		//register = [rsp], rsp += 8
+		push_register,
+		//rsp += value
+		allocate,
+		//rsp = register - value
+		set_frame,
+		//register = [rsp + value]
+		restore_register,
+		//xmm register = [rsp + value]
+		restore_xmm,
+		//rip = [rsp + value], rsp = [rsp + value + 24]
+		push_machine_frame
+	};
+
+	type operation{};
+	//Operations, the prolog offset of which is greater than the
+	//offset of the instruction pointer from the function start,
+	//have not yet been executed and are skipped
+	std::uint8_t offset_in_prolog{};
+	std::uint8_t reg{};
+	std::uint64_t value{};
+};
+
+//Unwind codes of the function, followed by the codes of all chained functions
+struct [[nodiscard]] unwind_program
+{
+	std::vector<unwind_operation> operations;
+	std::error_code error;
+};
+
+struct [[nodiscard]] stack_frame
+{
+	std::uint64_t rip{};
+	std::uint64_t rsp{};
+	//Runtime function containing rip, or nullptr for leaf functions
+	//and unknown instruction pointers
+	const runtime_function_details* function{};
+};
+
+class [[nodiscard]] stack_trace : public error_list
+{
+public:
+	using frame_list_type = std::vector<stack_frame>;
+
+public:
+	[[nodiscard]]
+	frame_list_type& get_frames() & noexcept
+	{
+		return frames_;
+	}
+
+	[[nodiscard]]
+	const frame_list_type& get_frames() const& noexcept
+	{
+		return frames_;
+	}
+
+	[[nodiscard]]
+	frame_list_type get_frames() && noexcept
+	{
+		return std::move(frames_);
+	}
+
+private:
+	frame_list_type frames_;
+};
+
+struct [[nodiscard]] stack_walk_options
+{
+	std::size_t max_frames = 1024u;
+};
+
+//Virtual x64 stack unwinder, which does not depend on the OS.
+//Images are registered together with their load addresses, runtime
+//functions are looked up using the runtime function index, and
+//unwind codes of each function are converted to unwind programs on
+//first use and cached. Stack memory is read using the callback, which
+//returns false if the memory is not available.
+//Epilogs are not emulated: the instruction pointer inside an epilog
+//is unwound as if it were in the function body.
+//The unwinder is not thread-safe.
+class [[nodiscard]] unwinder
+{
+public:
+	using memory_reader_type = std::function<bool(
+		std::uint64_t address, std::span<std::byte> data)>;
+
+public:
+	explicit unwinder(memory_reader_type memory_reader);
+	~unwinder();
+
+	unwinder(const unwinder&) = delete;
+	unwinder& operator=(const unwinder&) = delete;
+	unwinder(unwinder&&) noexcept;
+	unwinder& operator=(unwinder&&) noexcept;
+
+	//Loads the exception directory of the image and registers it
+	void add_image(const image::image& instance, std::uint64_t image_base,
+		const loader_options& options = {});
+	void add_image(std::uint64_t image_base, std::uint32_t image_size,
+		exception_directory_details&& directory);
+
+	[[nodiscard]]
+	std::size_t get_image_count() const noexcept;
+
+	//Unwinds one frame, updating the context to the state of the caller.
+	//Returns the runtime function of the unwound frame, or nullptr
+	//for the leaf function.
+	const runtime_function_details* unwind(unwind_context& context);
+
+	//Returns the unwind program of the runtime function of the registered image
+	[[nodiscard]]
+	const unwind_program& get_unwind_program(const runtime_function_details& func);
+
+	//Unwinds frames until the instruction pointer becomes zero,
+	//the frame limit is reached or unwinding fails
+	[[nodiscard]]
+	stack_trace walk(unwind_context context, const stack_walk_options& options = {});
+
+private:
+	struct loaded_image;
+
+private:
+	[[nodiscard]]
+	loaded_image* find_image(std::uint64_t address) const noexcept;
+	void add_image(std::unique_ptr<loaded_image> image);
+	std::uint64_t read_qword(std::uint64_t address) const;
+	xmm_register read_xmm(std::uint64_t address) const;
+
+private:
+	memory_reader_type memory_reader_;
+	//Sorted by image base
+	std::vector<std::unique_ptr<loaded_image>> images_;
+};
+
+} //namespace pe_bliss::exceptions::x64
+
+namespace std
+{
+template<>
+struct is_error_code_enum<pe_bliss::exceptions::x64::unwinder_errc> : true_type {};
+} //namespace std
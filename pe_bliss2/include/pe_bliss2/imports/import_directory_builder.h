@@ -27,6 +27,11 @@ struct builder_options
 	bool update_import_data_directory = true;
 	bool update_delayed_import_data_directory = false;
 	bool update_iat_data_directory = true;
+	//Write identical library names and hint/name entries only once
+	bool deduplicate_strings = false;
+	//Share lookup tables between libraries with identical import lists
+	//(libraries importing by name need deduplicate_strings)
+	bool share_lookup_tables = false;
 };
 
 struct build_result
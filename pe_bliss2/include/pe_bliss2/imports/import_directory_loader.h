@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <string_view>
 #include <system_error>
 #include <type_traits>
+#include <vector>
 
 #include "pe_bliss2/core/data_directories.h"
 #include "pe_bliss2/imports/import_directory.h"
@@ -29,7 +33,10 @@ enum class import_directory_loader_errc
 	invalid_imported_library_iat_ilt,
 	empty_library_name,
 	empty_import_name,
-	address_and_unload_table_thunks_differ //delay load specific
+	address_and_unload_table_thunks_differ, //delay load specific
+	too_many_libraries,
+	too_many_imports,
+	too_many_total_imports
 };
 
 std::error_code make_error_code(import_directory_loader_errc) noexcept;
@@ -40,12 +47,66 @@ struct [[nodiscard]] loader_options
 	bool allow_virtual_data = false;
 	core::data_directories::directory_type target_directory
 		= core::data_directories::directory_type::imports;
+	std::uint32_t max_libraries = 0xffffu;
+	std::uint32_t max_imports_per_library = 0xffffu;
+	std::uint32_t max_total_imports = 0xfffffu;
 };
 
 [[nodiscard]]
 std::optional<import_directory_details> load(const image::image& instance,
 	const loader_options& options = {});
 
+//Import directory with library descriptors and names loaded,
+//whose imports are loaded on first request.
+//The image must outlive this object.
+template<typename Directory>
+class [[nodiscard]] lazy_import_directory_base
+{
+public:
+	using directory_type = Directory;
+
+public:
+	lazy_import_directory_base(const image::image& instance,
+		const loader_options& options, directory_type&& directory);
+
+	//Libraries which were not resolved have empty import lists
+	[[nodiscard]]
+	const directory_type& get_directory() const noexcept
+	{
+		return directory_;
+	}
+
+	[[nodiscard]]
+	std::size_t get_library_count() const noexcept;
+
+	[[nodiscard]]
+	bool is_resolved(std::size_t index) const
+	{
+		return resolved_.at(index);
+	}
+
+	//Case-insensitive search, returns the index of the first library found
+	[[nodiscard]]
+	std::optional<std::size_t> find_library(std::string_view name) const noexcept;
+
+	const directory_type& resolve(std::size_t index);
+	const directory_type& resolve_all();
+
+private:
+	const image::image& instance_;
+	loader_options options_;
+	directory_type directory_;
+	std::vector<bool> resolved_;
+	std::uint32_t remaining_imports_;
+	bool stopped_ = false;
+};
+
+using lazy_import_directory = lazy_import_directory_base<import_directory_details>;
+
+[[nodiscard]]
+std::optional<lazy_import_directory> load_lazy(const image::image& instance,
+	const loader_options& options = {});
+
 } //namespace pe_bliss::imports
 
 namespace std
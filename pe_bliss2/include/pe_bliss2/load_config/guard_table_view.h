@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/load_config/load_config_directory.h"
+#include "pe_bliss2/load_config/load_config_directory_loader.h"
+#include "pe_bliss2/pe_types.h"
+
+namespace pe_bliss::image
+{
+class image;
+} //namespace pe_bliss::image
+
+namespace pe_bliss::load_config
+{
+
+//Compact view of a CF guard RVA table (guard CF function table,
+//longjump target table or export suppression table), which keeps
+//RVAs and gfids_flags of table entries in two sorted contiguous columns
+//instead of guard_function objects. The flags column is empty if the
+//table stride is zero. Errors are reported with
+//load_config_directory_loader_errc codes. Unlike the loader, which
+//only reports unsorted tables, the view sorts them on construction,
+//as lookups require sorted RVAs.
+class [[nodiscard]] guard_table_view : public error_list
+{
+public:
+	guard_table_view() = default;
+	//Decodes raw table data, which consists of entries of
+	//(sizeof(rva_type) + stride) bytes each. Throws pe_error
+	//with invalid_cf_guard_table_size if the data size is not a multiple
+	//of the entry size. Reports unsorted_table_error if the table is unsorted.
+	guard_table_view(std::span<const std::byte> data, std::uint8_t stride,
+		load_config_directory_loader_errc unsorted_table_error
+			= load_config_directory_loader_errc::unsorted_cf_guard_table);
+
+	[[nodiscard]]
+	std::size_t size() const noexcept
+	{
+		return rvas_.size();
+	}
+
+	[[nodiscard]]
+	bool empty() const noexcept
+	{
+		return rvas_.empty();
+	}
+
+	[[nodiscard]]
+	std::uint8_t get_stride() const noexcept
+	{
+		return stride_;
+	}
+
+	[[nodiscard]]
+	std::span<const rva_type> get_rvas() const noexcept
+	{
+		return rvas_;
+	}
+
+	[[nodiscard]]
+	std::span<const std::uint8_t> get_flags() const noexcept
+	{
+		return flags_;
+	}
+
+	[[nodiscard]]
+	bool contains(rva_type rva) const noexcept;
+
+	//Returns gfids_flags of the entry with the rva (zero if the table
+	//stride is zero), or an empty value if there is no such entry
+	[[nodiscard]]
+	std::optional<std::uint8_t> find_flags(rva_type rva) const noexcept;
+
+	//Returns true if the rva is present in the table and
+	//is not marked with the gfids_flags::fid_suppressed flag
+	[[nodiscard]]
+	bool is_valid_call_target(rva_type rva) const noexcept;
+
+	//Returns true if the rva is present in the table and
+	//is marked with the gfids_flags::export_suppressed flag
+	[[nodiscard]]
+	bool is_export_suppressed(rva_type rva) const noexcept;
+
+private:
+	std::vector<rva_type> rvas_;
+	std::vector<std::uint8_t> flags_;
+	std::uint8_t stride_{};
+};
+
+struct [[nodiscard]] guard_table_views
+{
+	std::optional<guard_table_view> cf_function_table;
+	std::optional<guard_table_view> longjump_table;
+	std::optional<guard_table_view> export_suppression_table;
+};
+
+//Reads CF guard tables of the loaded load config directory.
+//Tables are read if the corresponding loader option is set,
+//table size limits of the loader options are respected.
+//Table read errors are reported as errors of the corresponding views.
+[[nodiscard]]
+guard_table_views load_guard_table_views(const image::image& instance,
+	const load_config_directory_details& directory,
+	const loader_options& options = {});
+
+//Loads the load config directory descriptor without any additional
+//tables, then reads CF guard tables of the directory.
+[[nodiscard]]
+std::optional<guard_table_views> load_guard_table_views(
+	const image::image& instance, const loader_options& options = {});
+
+} //namespace pe_bliss::load_config
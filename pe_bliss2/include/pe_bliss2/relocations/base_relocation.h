@@ -7,6 +7,7 @@
 #include "pe_bliss2/error_list.h"
 #include "pe_bliss2/detail/packed_struct_base.h"
 #include "pe_bliss2/detail/relocations/image_base_relocation.h"
+#include "pe_bliss2/pe_types.h"
 #include "pe_bliss2/relocations/relocation_entry.h"
 
 namespace pe_bliss::relocations
@@ -20,6 +21,12 @@ public:
 	using entry_list_type = std::vector<RelocationEntry>;
 
 public:
+	[[nodiscard]]
+	rva_type get_virtual_address() const noexcept
+	{
+		return this->descriptor_->virtual_address;
+	}
+
 	[[nodiscard]]
 	const entry_list_type& get_relocations() const & noexcept
 	{
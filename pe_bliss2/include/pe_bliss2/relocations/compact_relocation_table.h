@@ -0,0 +1,329 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "pe_bliss2/core/file_header.h"
+#include "pe_bliss2/pe_types.h"
+#include "pe_bliss2/relocations/relocation_entry.h"
+
+namespace pe_bliss::relocations
+{
+
+//Relocation entry decoded on the fly from the raw type/offset word
+class [[nodiscard]] compact_relocation_entry
+{
+public:
+	using address_type = relocation_entry::address_type;
+
+public:
+	constexpr explicit compact_relocation_entry(std::uint16_t type_or_offset,
+		std::optional<std::uint16_t> param = {}) noexcept
+		: type_or_offset_(type_or_offset)
+		, param_(param)
+	{
+	}
+
+	[[nodiscard]]
+	constexpr std::uint16_t get_raw_value() const noexcept
+	{
+		return type_or_offset_;
+	}
+
+	[[nodiscard]]
+	constexpr const std::optional<std::uint16_t>& get_param() const noexcept
+	{
+		return param_;
+	}
+
+	[[nodiscard]]
+	constexpr relocation_type get_type() const noexcept
+	{
+		return static_cast<relocation_type>(type_or_offset_ >> 12u);
+	}
+
+	[[nodiscard]]
+	constexpr address_type get_address() const noexcept
+	{
+		return static_cast<address_type>(type_or_offset_ & 0xfffu);
+	}
+
+	[[nodiscard("Discarding relocated value")]]
+	std::uint64_t apply_to(std::uint64_t value,
+		std::uint64_t image_base_difference,
+		core::file_header::machine_type machine) const
+	{
+		return apply_relocation(get_type(), value,
+			image_base_difference, machine, param_);
+	}
+
+	[[nodiscard]]
+	std::uint8_t get_affected_size_in_bytes(
+		core::file_header::machine_type machine) const
+	{
+		return relocations::get_affected_size_in_bytes(get_type(), machine);
+	}
+
+	[[nodiscard]]
+	constexpr bool requires_parameter() const noexcept
+	{
+		return get_type() == relocation_type::highadj;
+	}
+
+private:
+	std::uint16_t type_or_offset_;
+	std::optional<std::uint16_t> param_;
+};
+
+//Iterates over raw type/offset words of a relocation block.
+//The word following a highadj entry is its parameter.
+class [[nodiscard]] compact_relocation_iterator
+{
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = compact_relocation_entry;
+	using difference_type = std::ptrdiff_t;
+	using pointer = void;
+	using reference = compact_relocation_entry;
+
+public:
+	constexpr compact_relocation_iterator() noexcept = default;
+	constexpr compact_relocation_iterator(const std::uint16_t* current,
+		const std::uint16_t* end) noexcept
+		: current_(current)
+		, end_(end)
+	{
+	}
+
+	[[nodiscard]]
+	constexpr compact_relocation_entry operator*() const noexcept
+	{
+		compact_relocation_entry entry(*current_);
+		if (entry.requires_parameter() && current_ + 1 != end_)
+			return compact_relocation_entry(*current_, current_[1]);
+		return entry;
+	}
+
+	constexpr compact_relocation_iterator& operator++() noexcept
+	{
+		if (compact_relocation_entry(*current_).requires_parameter()
+			&& current_ + 1 != end_)
+		{
+			++current_;
+		}
+		++current_;
+		return *this;
+	}
+
+	constexpr compact_relocation_iterator operator++(int) noexcept
+	{
+		auto result = *this;
+		++*this;
+		return result;
+	}
+
+	[[nodiscard]]
+	friend constexpr bool operator==(const compact_relocation_iterator& l,
+		const compact_relocation_iterator& r) noexcept
+	{
+		return l.current_ == r.current_;
+	}
+
+private:
+	const std::uint16_t* current_{};
+	const std::uint16_t* end_{};
+};
+
+class [[nodiscard]] compact_relocation_range
+{
+public:
+	using value_type = compact_relocation_entry;
+	using iterator = compact_relocation_iterator;
+	using const_iterator = compact_relocation_iterator;
+
+public:
+	constexpr explicit compact_relocation_range(
+		std::span<const std::uint16_t> words) noexcept
+		: words_(words)
+	{
+	}
+
+	[[nodiscard]]
+	constexpr iterator begin() const noexcept
+	{
+		return { words_.data(), words_.data() + words_.size() };
+	}
+
+	[[nodiscard]]
+	constexpr iterator end() const noexcept
+	{
+		return { words_.data() + words_.size(), words_.data() + words_.size() };
+	}
+
+	[[nodiscard]]
+	constexpr bool empty() const noexcept
+	{
+		return words_.empty();
+	}
+
+private:
+	std::span<const std::uint16_t> words_;
+};
+
+class [[nodiscard]] compact_base_relocation
+{
+public:
+	using entry_list_type = compact_relocation_range;
+
+public:
+	constexpr compact_base_relocation(rva_type virtual_address,
+		std::span<const std::uint16_t> words) noexcept
+		: virtual_address_(virtual_address)
+		, words_(words)
+	{
+	}
+
+	[[nodiscard]]
+	constexpr rva_type get_virtual_address() const noexcept
+	{
+		return virtual_address_;
+	}
+
+	//Raw type/offset words, including highadj parameters
+	[[nodiscard]]
+	constexpr std::span<const std::uint16_t> get_words() const noexcept
+	{
+		return words_;
+	}
+
+	[[nodiscard]]
+	constexpr compact_relocation_range get_relocations() const noexcept
+	{
+		return compact_relocation_range(words_);
+	}
+
+private:
+	rva_type virtual_address_;
+	std::span<const std::uint16_t> words_;
+};
+
+//Relocation blocks stored as page RVAs plus a single array
+//of raw type/offset words (2 bytes per entry)
+class [[nodiscard]] compact_relocation_table
+{
+private:
+	struct block_type
+	{
+		rva_type virtual_address;
+		std::uint32_t first_word;
+		std::uint32_t word_count;
+	};
+
+public:
+	using value_type = compact_base_relocation;
+
+	class [[nodiscard]] const_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = compact_base_relocation;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = compact_base_relocation;
+
+	public:
+		const_iterator() noexcept = default;
+		const_iterator(const compact_relocation_table* table, std::size_t index) noexcept
+			: table_(table)
+			, index_(index)
+		{
+		}
+
+		[[nodiscard]]
+		compact_base_relocation operator*() const noexcept
+		{
+			return (*table_)[index_];
+		}
+
+		const_iterator& operator++() noexcept
+		{
+			++index_;
+			return *this;
+		}
+
+		const_iterator operator++(int) noexcept
+		{
+			auto result = *this;
+			++index_;
+			return result;
+		}
+
+		[[nodiscard]]
+		friend bool operator==(const const_iterator& l,
+			const const_iterator& r) noexcept
+		{
+			return l.index_ == r.index_;
+		}
+
+	private:
+		const compact_relocation_table* table_{};
+		std::size_t index_{};
+	};
+
+	using iterator = const_iterator;
+
+public:
+	void reserve(std::size_t block_count, std::size_t word_count);
+
+	void add_block(rva_type virtual_address,
+		std::span<const std::uint16_t> words);
+
+	[[nodiscard]]
+	std::size_t size() const noexcept
+	{
+		return blocks_.size();
+	}
+
+	[[nodiscard]]
+	bool empty() const noexcept
+	{
+		return blocks_.empty();
+	}
+
+	//Total count of raw words in all blocks
+	[[nodiscard]]
+	std::size_t get_word_count() const noexcept
+	{
+		return words_.size();
+	}
+
+	[[nodiscard]]
+	compact_base_relocation operator[](std::size_t index) const noexcept
+	{
+		const auto& block = blocks_[index];
+		return { block.virtual_address, std::span<const std::uint16_t>(
+			words_.data() + block.first_word, block.word_count) };
+	}
+
+	[[nodiscard]]
+	const_iterator begin() const noexcept
+	{
+		return { this, 0u };
+	}
+
+	[[nodiscard]]
+	const_iterator end() const noexcept
+	{
+		return { this, blocks_.size() };
+	}
+
+private:
+	std::vector<block_type> blocks_;
+	std::vector<std::uint16_t> words_;
+};
+
+} //namespace pe_bliss::relocations
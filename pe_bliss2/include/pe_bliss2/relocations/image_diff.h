@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "pe_bliss2/pe_types.h"
+#include "pe_bliss2/relocations/base_relocation.h"
+
+namespace pe_bliss::image
+{
+class image;
+} //namespace pe_bliss::image
+
+namespace pe_bliss::relocations
+{
+
+class compact_relocation_table;
+
+enum class image_diff_errc
+{
+	section_layout_mismatch = 1
+};
+
+std::error_code make_error_code(image_diff_errc) noexcept;
+
+struct [[nodiscard]] image_difference
+{
+	rva_type rva{};
+	std::uint32_t size{};
+
+	[[nodiscard]]
+	friend bool operator==(const image_difference&, const image_difference&) = default;
+};
+
+using image_difference_list = std::vector<image_difference>;
+
+struct [[nodiscard]] image_diff_options
+{
+	//Stop after this count of differences is found, 0 to report all of them
+	std::size_t max_differences = 0;
+};
+
+//Compares section data of two images of the same binary, which may be
+//rebased to different image bases. Bytes affected by relocations are
+//masked out (using a bitmap built from the relocation list), so only
+//real differences are reported, as ranges of adjacent differing bytes.
+//Section data is compared in 64-byte chunks, one mask word per chunk.
+//Sections must have the same RVAs in both images. Physical data
+//missing in one of the images is compared as zeroes.
+//Throws pe_error for unsupported relocation types.
+[[nodiscard]]
+image_difference_list diff_images(const image::image& a, const image::image& b,
+	const base_relocation_details_list& relocs, const image_diff_options& options = {});
+[[nodiscard]]
+image_difference_list diff_images(const image::image& a, const image::image& b,
+	const base_relocation_list& relocs, const image_diff_options& options = {});
+[[nodiscard]]
+image_difference_list diff_images(const image::image& a, const image::image& b,
+	const compact_relocation_table& relocs, const image_diff_options& options = {});
+
+} //namespace pe_bliss::relocations
+
+namespace std
+{
+template<>
+struct is_error_code_enum<pe_bliss::relocations::image_diff_errc> : true_type {};
+} //namespace std
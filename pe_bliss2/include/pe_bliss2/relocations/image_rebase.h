@@ -14,6 +14,8 @@ class image;
 namespace pe_bliss::relocations
 {
 
+class compact_relocation_table;
+
 enum class rebase_errc
 {
 	unable_to_rebase_inexistent_data = 1,
@@ -34,6 +36,35 @@ void rebase(image::image& instance,
 void rebase(image::image& instance,
 	const base_relocation_list& relocs,
 	const rebase_options& options);
+void rebase(image::image& instance,
+	const compact_relocation_table& relocs,
+	const rebase_options& options);
+
+struct [[nodiscard]] page_rebase_options
+{
+	std::uint64_t new_base{};
+	bool ignore_virtual_data = true;
+	//Number of threads to apply relocation blocks with,
+	//0 or 1 to apply them on the calling thread.
+	//Blocks are applied on the calling thread if their RVAs
+	//are not strictly increasing by at least the page size
+	std::uint32_t thread_count = 1u;
+};
+
+//Produces the same result as rebase(), but processes every relocation
+//block as a single page: section data of the page is looked up once,
+//and all fixups of the block are applied directly to it.
+//Fixups, which do not fit into the physical section data of the page,
+//are applied the same way as with rebase().
+void rebase_pages(image::image& instance,
+	const base_relocation_details_list& relocs,
+	const page_rebase_options& options);
+void rebase_pages(image::image& instance,
+	const base_relocation_list& relocs,
+	const page_rebase_options& options);
+void rebase_pages(image::image& instance,
+	const compact_relocation_table& relocs,
+	const page_rebase_options& options);
 
 } //namespace pe_bliss::relocations
 
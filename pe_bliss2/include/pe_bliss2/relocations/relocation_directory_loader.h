@@ -6,6 +6,7 @@
 
 #include "pe_bliss2/error_list.h"
 #include "pe_bliss2/relocations/base_relocation.h"
+#include "pe_bliss2/relocations/compact_relocation_table.h"
 
 namespace pe_bliss::image
 {
@@ -37,10 +38,23 @@ struct [[nodiscard]] relocation_directory
 	error_list errors;
 };
 
+struct [[nodiscard]] compact_relocation_directory
+{
+	compact_relocation_table relocations;
+	//Error context is the relocation block index
+	error_list errors;
+};
+
 [[nodiscard]]
 std::optional<relocation_directory> load(const image::image& instance,
 	const loader_options& options = {});
 
+//Loads relocation blocks as raw type/offset words, without creating
+//per-entry objects. Performs the same checks as load().
+[[nodiscard]]
+std::optional<compact_relocation_directory> load_compact(
+	const image::image& instance, const loader_options& options = {});
+
 } //namespace pe_bliss::relocations
 
 namespace std
@@ -101,6 +101,17 @@ class [[nodiscard]] relocation_entry_details
 {
 };
 
+//Same as relocation_entry::apply_to, param is required for highadj relocations
+[[nodiscard("Discarding relocated value")]]
+std::uint64_t apply_relocation(relocation_type type, std::uint64_t value,
+	std::uint64_t image_base_difference,
+	core::file_header::machine_type machine,
+	std::optional<std::uint16_t> param);
+
+[[nodiscard]]
+std::uint8_t get_affected_size_in_bytes(relocation_type type,
+	core::file_header::machine_type machine);
+
 } //namespace pe_bliss::relocations
 
 namespace std
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "pe_bliss2/pe_types.h"
+#include "pe_bliss2/relocations/relocation_directory_builder.h"
+#include "pe_bliss2/relocations/relocation_entry.h"
+
+namespace pe_bliss::image
+{
+class image;
+} //namespace pe_bliss::image
+
+namespace pe_bliss::relocations
+{
+
+struct [[nodiscard]] relocation_fixup
+{
+	rva_type rva{};
+	relocation_type type{};
+	//Used for highadj fixups only
+	std::uint16_t param{};
+};
+
+//Builds the relocation directory from an unsorted list of fixups.
+//Fixups are radix-sorted by RVA (fixups with equal RVAs keep their order)
+//and grouped into 4K page blocks, which are laid out once, so the
+//exact directory size is known before anything is written.
+//The layout depends on builder_options::align_base_relocation_structures.
+class [[nodiscard]] relocation_fixup_builder
+{
+public:
+	explicit relocation_fixup_builder(std::span<const relocation_fixup> fixups,
+		const builder_options& options = {});
+	explicit relocation_fixup_builder(std::vector<relocation_fixup>&& fixups,
+		const builder_options& options = {});
+
+	[[nodiscard]]
+	const builder_options& get_options() const noexcept
+	{
+		return options_;
+	}
+
+	[[nodiscard]]
+	std::uint32_t get_built_size() const noexcept
+	{
+		return built_size_;
+	}
+
+	[[nodiscard]]
+	std::size_t get_block_count() const noexcept
+	{
+		return blocks_.size();
+	}
+
+	//Fixups sorted by RVA
+	[[nodiscard]]
+	const std::vector<relocation_fixup>& get_fixups() const noexcept
+	{
+		return fixups_;
+	}
+
+	//Writes exactly get_built_size() bytes, returns the number of bytes written
+	std::uint32_t build(std::span<std::byte> buf) const;
+
+	[[nodiscard]]
+	std::vector<std::byte> build() const;
+
+private:
+	struct block_type
+	{
+		rva_type virtual_address;
+		std::size_t first_fixup;
+		std::size_t fixup_count;
+		std::uint32_t size_of_block;
+	};
+
+private:
+	void layout();
+
+private:
+	builder_options options_;
+	std::vector<relocation_fixup> fixups_;
+	std::vector<block_type> blocks_;
+	std::uint32_t built_size_{};
+};
+
+//Builds the directory using the options passed to the builder
+std::uint32_t build_new(image::image& instance,
+	const relocation_fixup_builder& builder);
+
+} //namespace pe_bliss::relocations
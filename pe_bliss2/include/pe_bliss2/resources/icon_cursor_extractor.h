@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/resources/resource_index.h"
+#include "pe_bliss2/resources/resource_types.h"
+
+namespace buffers
+{
+class output_buffer_interface;
+} //namespace buffers
+
+namespace pe_bliss::resources
+{
+
+enum class icon_cursor_extractor_errc
+{
+	unable_to_read_group = 1,
+	invalid_group_header,
+	absent_image,
+	invalid_image,
+	too_large_file,
+	invalid_file
+};
+
+std::error_code make_error_code(icon_cursor_extractor_errc) noexcept;
+
+struct [[nodiscard]] icon_cursor_extract_options
+{
+	bool extract_icons = true;
+	bool extract_cursors = true;
+};
+
+//Resolves all icon and cursor groups of the resource index together
+//with the images they reference, and precomputes .ico/.cur file
+//headers and exact file sizes. Files are then written directly from
+//the resource data without building intermediate icon_group or
+//file_icon_group objects. Images are looked up in the group language
+//first, then in any other language.
+//Groups which can not be extracted are skipped. If error_list is one
+//of the Bases, corresponding errors are reported (context is the group
+//index in the resource index).
+//The resource directory must outlive the extractor. Only physical
+//data is written.
+template<typename... Bases>
+class [[nodiscard]] icon_cursor_extractor_base : public Bases...
+{
+public:
+	using index_type = resource_index_base<Bases...>;
+	using data_entry_type = typename index_type::data_entry_type;
+	using name_or_id_type = typename index_type::name_or_id_type;
+
+	struct file_type
+	{
+		resource_type group_type{};
+		name_or_id_type name_or_id;
+		resource_id_type language{};
+		std::uint32_t size{};
+
+		std::size_t header_offset{};
+		std::size_t first_image{};
+		std::uint16_t image_count{};
+	};
+
+	using file_list_type = std::vector<file_type>;
+
+public:
+	explicit icon_cursor_extractor_base(const index_type& index,
+		const icon_cursor_extract_options& options = {});
+
+	[[nodiscard]]
+	const file_list_type& get_files() const noexcept
+	{
+		return files_;
+	}
+
+	//Sum of all file sizes
+	[[nodiscard]]
+	std::uint64_t get_total_size() const noexcept
+	{
+		return total_size_;
+	}
+
+	//Writes exactly file.size bytes
+	void write(const file_type& file, buffers::output_buffer_interface& buf) const;
+	//Buffer must be at least file.size bytes long
+	void write(const file_type& file, std::span<std::byte> buf) const;
+
+private:
+	struct image_type
+	{
+		const data_entry_type* data{};
+		std::uint32_t offset{};
+		std::uint32_t size{};
+	};
+
+private:
+	void add_group(const index_type& index,
+		const typename index_type::entry_type& group,
+		std::size_t group_index, resource_type image_type);
+	void add_group_error(icon_cursor_extractor_errc error, std::size_t group_index);
+
+private:
+	file_list_type files_;
+	std::vector<std::byte> headers_;
+	std::vector<image_type> images_;
+	std::uint64_t total_size_{};
+};
+
+using icon_cursor_extractor = icon_cursor_extractor_base<>;
+using icon_cursor_extractor_details = icon_cursor_extractor_base<error_list>;
+
+} //namespace pe_bliss::resources
+
+namespace std
+{
+template<>
+struct is_error_code_enum<pe_bliss::resources::icon_cursor_extractor_errc> : true_type {};
+} //namespace std
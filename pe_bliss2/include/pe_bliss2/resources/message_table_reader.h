@@ -1,10 +1,18 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <system_error>
 #include <type_traits>
+#include <vector>
 
 #include "pe_bliss2/resources/message_table.h"
 
+#include "buffers/input_buffer_interface.h"
 #include "buffers/input_buffer_stateful_wrapper.h"
 
 namespace pe_bliss::resources
@@ -37,6 +45,106 @@ message_table_details message_table_from_resource(
 	buffers::input_buffer_stateful_wrapper_ref& buf,
 	const message_table_read_options& options = {});
 
+//Text of a single message table entry, which is decoded on request.
+//References the memory of the message_table_index it was found in.
+class [[nodiscard]] message_view
+{
+public:
+	message_view(message_encoding encoding,
+		std::span<const std::byte> text) noexcept
+		: encoding_(encoding)
+		, text_(text)
+	{
+	}
+
+	[[nodiscard]]
+	message_encoding get_encoding() const noexcept
+	{
+		return encoding_;
+	}
+
+	//Without the trailing null character
+	[[nodiscard]]
+	std::span<const std::byte> get_raw_text() const noexcept
+	{
+		return text_;
+	}
+
+	//Empty, if the message has a different encoding
+	[[nodiscard]]
+	std::string_view get_ansi() const noexcept;
+	[[nodiscard]]
+	std::u8string_view get_utf8() const noexcept;
+	[[nodiscard]]
+	std::u16string get_unicode() const;
+	//Reuses the capacity of result
+	void get_unicode(std::u16string& result) const;
+
+	[[nodiscard]]
+	message_entry::message_type decode() const;
+
+private:
+	message_encoding encoding_;
+	std::span<const std::byte> text_;
+};
+
+//Message table view, which is indexed by message ID. Only block
+//descriptors and entry lengths are read when the index is built,
+//message text is decoded on request. Invalid blocks and messages
+//are skipped, use message_table_from_resource() to get the details.
+//For overlapping blocks, the first block in the table wins.
+class [[nodiscard]] message_table_index
+{
+public:
+	//Throws pe_error, if the message table header can not be read
+	explicit message_table_index(const buffers::input_buffer_ptr& buf,
+		const message_table_read_options& options = {});
+
+	[[nodiscard]]
+	std::optional<message_view> find(std::uint32_t message_id) const noexcept;
+
+	[[nodiscard]]
+	std::size_t get_block_count() const noexcept
+	{
+		return blocks_.size();
+	}
+
+	[[nodiscard]]
+	bool has_overlapping_ids() const noexcept
+	{
+		return has_overlapping_ids_;
+	}
+
+private:
+	struct block
+	{
+		std::uint32_t low_id{};
+		std::uint32_t high_id{};
+		std::uint32_t first_entry{};
+	};
+
+	struct entry
+	{
+		std::uint32_t text_offset{};
+		std::uint32_t text_size{};
+		message_encoding encoding{};
+		bool is_valid = false;
+	};
+
+private:
+	void load_entries(std::uint32_t offset_to_entries,
+		std::uint32_t entry_count, bool allow_virtual_data);
+
+private:
+	buffers::input_buffer_ptr buf_;
+	std::vector<std::byte> copied_data_;
+	std::span<const std::byte> data_;
+	//Sorted by low_id, unless has_overlapping_ids_ is set
+	std::vector<block> blocks_;
+	std::vector<entry> entries_;
+	bool has_overlapping_ids_ = false;
+};
+
 } //namespace pe_bliss::resources
 
 namespace std
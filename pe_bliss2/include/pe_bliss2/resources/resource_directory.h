@@ -53,9 +53,12 @@ public:
 		return entries_;
 	}
 
+	//Clears the sorted flag, as entries may be modified
+	//in a way that breaks the order
 	[[nodiscard]]
 	entry_list_type& get_entries() & noexcept
 	{
+		sorted_ = false;
 		return entries_;
 	}
 
@@ -98,8 +101,32 @@ public:
 	entry_type& try_emplace_entry_by_name(directory_entry_contents contents,
 		std::u16string&& name);
 
+	//Returns true if entries are sorted as required by the PE format:
+	//named entries first, ordered by name, then ID entries, ordered by ID.
+	//Entries without a name or an ID are ordered between them.
+	[[nodiscard]]
+	bool has_sorted_entries() const noexcept;
+
+	//When set, entries are expected to be sorted (see has_sorted_entries()),
+	//and are looked up using binary search. Set by the loader,
+	//kept by try_emplace_entry_by_*. The mutable get_entries() overload
+	//clears the flag, so it must be set again after modifying
+	//the entries directly, if they are still sorted. Lookups verify
+	//the order in debug builds.
+	[[nodiscard]]
+	bool is_sorted() const noexcept
+	{
+		return sorted_;
+	}
+
+	void set_sorted(bool sorted) noexcept
+	{
+		sorted_ = sorted;
+	}
+
 private:
 	entry_list_type entries_;
+	bool sorted_ = false;
 };
 
 template<typename... Bases>
@@ -134,7 +161,7 @@ public:
 		resource_id_type, resource_name_type>;
 	using data_or_directory_type = std::variant<std::monostate,
 		resource_directory_base<Bases...>, resource_data_entry_base<Bases...>,
-		rva_type /* RVA of looped resource_directory_base */>;
+		rva_type /* RVA of looped or shared resource_directory_base */>;
 
 public:
 	[[nodiscard]]
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <system_error>
+#include <type_traits>
+
+#include "pe_bliss2/pe_types.h"
+#include "pe_bliss2/resources/resource_directory.h"
+
+namespace buffers
+{
+class output_buffer_interface;
+} //namespace buffers
+
+namespace pe_bliss::image
+{
+class image;
+} //namespace pe_bliss::image
+
+namespace pe_bliss::resources
+{
+
+enum class resource_directory_builder_errc
+{
+	invalid_entry = 1,
+	invalid_data_alignment,
+	too_large_directory
+};
+
+std::error_code make_error_code(resource_directory_builder_errc) noexcept;
+
+struct builder_options
+{
+	rva_type directory_rva = 0;
+	//Power of two, data of every resource is aligned to it
+	std::uint32_t data_alignment = 8u;
+	//Write resources with identical data only once
+	bool deduplicate_data = true;
+	bool update_data_directory = true;
+};
+
+//Layout: directory tables (breadth-first), data entries,
+//names, data. Entries of every directory are sorted (named entries
+//first, then ID entries) before building, and descriptors of all
+//directories, entries and data entries are updated.
+//Looped or shared directories (rva_type entries) are not supported.
+std::uint32_t build_new(image::image& instance, resource_directory_details& directory,
+	const builder_options& options);
+std::uint32_t build_new(image::image& instance, resource_directory& directory,
+	const builder_options& options);
+std::uint32_t build_new(buffers::output_buffer_interface& buf,
+	resource_directory_details& directory, const builder_options& options);
+std::uint32_t build_new(buffers::output_buffer_interface& buf,
+	resource_directory& directory, const builder_options& options);
+
+[[nodiscard]]
+std::uint32_t get_built_size(const resource_directory_details& directory,
+	const builder_options& options);
+[[nodiscard]]
+std::uint32_t get_built_size(const resource_directory& directory,
+	const builder_options& options);
+
+} //namespace pe_bliss::resources
+
+namespace std
+{
+template<>
+struct is_error_code_enum<pe_bliss::resources::resource_directory_builder_errc> : true_type {};
+} //namespace std
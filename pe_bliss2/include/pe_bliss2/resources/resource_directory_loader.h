@@ -1,9 +1,16 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <system_error>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "pe_bliss2/pe_types.h"
 #include "pe_bliss2/resources/resource_directory.h"
 
 namespace pe_bliss::image
@@ -25,7 +32,9 @@ enum class resource_directory_loader_errc
 	invalid_resource_data_entry,
 	invalid_resource_data_entry_raw_data,
 	unsorted_entries,
-	duplicate_entries
+	duplicate_entries,
+	too_many_entries,
+	too_deep_directory_tree
 };
 
 struct [[nodiscard]] loader_options
@@ -33,6 +42,14 @@ struct [[nodiscard]] loader_options
 	bool include_headers = true;
 	bool allow_virtual_data = false;
 	bool copy_raw_data = false;
+	std::uint32_t max_total_entries = 0x40000u;
+	std::uint32_t max_depth = 16u;
+	//When set, each directory is loaded once: entries pointing to
+	//an already loaded directory (a shared subtree) keep its RVA,
+	//like looped entries do. This bounds the loading time of crafted
+	//trees with many references to the same subtree, but shared subtrees
+	//are not resolvable through such entries.
+	bool load_shared_directories_once = false;
 };
 
 std::error_code make_error_code(resource_directory_loader_errc) noexcept;
@@ -41,6 +58,78 @@ std::error_code make_error_code(resource_directory_loader_errc) noexcept;
 std::optional<resource_directory_details> load(const image::image& instance,
 	const loader_options& options = {});
 
+//Resource directory tree, in which subdirectories and data entries
+//of directory entries are loaded on first request.
+//The image must outlive this object.
+class [[nodiscard]] lazy_resource_directory
+{
+public:
+	lazy_resource_directory(const image::image& instance,
+		const loader_options& options);
+
+	//Pending entries are referenced by their addresses,
+	//which are kept when the tree is moved, but not when it is copied
+	lazy_resource_directory(const lazy_resource_directory&) = delete;
+	lazy_resource_directory& operator=(const lazy_resource_directory&) = delete;
+	lazy_resource_directory(lazy_resource_directory&&) = default;
+	lazy_resource_directory& operator=(lazy_resource_directory&&) = delete;
+
+	//Entries which were not resolved have neither data nor directory
+	[[nodiscard]]
+	const resource_directory_details& get_root() const noexcept
+	{
+		return root_;
+	}
+
+	[[nodiscard]]
+	bool is_resolved(const resource_directory_entry_details& entry) const noexcept
+	{
+		return !pending_entries_.contains(&entry);
+	}
+
+	const resource_directory_entry_details::data_or_directory_type& resolve(
+		const resource_directory_entry_details& entry);
+	[[nodiscard]]
+	const resource_directory_details& get_directory(
+		const resource_directory_entry_details& entry);
+	[[nodiscard]]
+	const resource_data_entry_details& get_data(
+		const resource_directory_entry_details& entry);
+
+	const resource_directory_details& resolve_all();
+
+private:
+	struct pending_entry
+	{
+		resource_directory_entry_details* entry;
+		std::uint32_t depth;
+		std::size_t path;
+	};
+
+private:
+	void load_directory(rva_type rva,
+		resource_directory_details& directory, std::uint32_t depth);
+	void check_size();
+
+private:
+	const image::image& instance_;
+	loader_options options_;
+	resource_directory_details root_;
+	rva_type resource_dir_rva_{};
+	std::uint64_t last_rva_{};
+	std::uint64_t max_rva_{};
+	std::uint32_t remaining_entries_;
+	//(directory RVA, parent index) pairs
+	std::vector<std::pair<rva_type, std::size_t>> directory_paths_;
+	std::unordered_set<rva_type> loaded_directories_;
+	std::unordered_map<const resource_directory_entry_details*,
+		pending_entry> pending_entries_;
+};
+
+[[nodiscard]]
+std::optional<lazy_resource_directory> load_lazy(const image::image& instance,
+	const loader_options& options = {});
+
 } //namespace pe_bliss::resources
 
 namespace std
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/resources/resource_directory.h"
+#include "pe_bliss2/resources/resource_types.h"
+
+namespace pe_bliss::resources
+{
+
+//Flat (type, name or ID, language) -> data entry table, built
+//from the three-level resource directory in a single traversal.
+//Resources with ID language entries are indexed, resource types
+//may be either IDs or names (e.g. "MUI").
+//Names and data entries are referenced, so the directory
+//must outlive the index and must not be modified.
+template<typename... Bases>
+class [[nodiscard]] resource_index_base
+{
+public:
+	using directory_type = resource_directory_base<Bases...>;
+	using data_entry_type = resource_data_entry_base<Bases...>;
+	using name_or_id_type = std::variant<resource_id_type, std::u16string_view>;
+
+	struct entry_type
+	{
+		name_or_id_type type;
+		name_or_id_type name_or_id;
+		resource_id_type language{};
+		const data_entry_type* data{};
+	};
+
+	using entry_list_type = std::vector<entry_type>;
+	using entry_range_type = std::span<const entry_type>;
+
+public:
+	explicit resource_index_base(const directory_type& root);
+
+	//Sorted by (type, name or ID, language), IDs go before names
+	//both for types and for resource names
+	[[nodiscard]]
+	const entry_list_type& get_entries() const noexcept
+	{
+		return entries_;
+	}
+
+	[[nodiscard]]
+	const data_entry_type* find(resource_type type, resource_id_type id,
+		resource_id_type language) const noexcept;
+	[[nodiscard]]
+	const data_entry_type* find(resource_type type, std::u16string_view name,
+		resource_id_type language) const noexcept;
+	[[nodiscard]]
+	const data_entry_type* find(std::u16string_view type_name, resource_id_type id,
+		resource_id_type language) const noexcept;
+	[[nodiscard]]
+	const data_entry_type* find(std::u16string_view type_name,
+		std::u16string_view name, resource_id_type language) const noexcept;
+
+	//All entries of the type
+	[[nodiscard]]
+	entry_range_type find_all(resource_type type) const noexcept;
+	//All languages of the resource
+	[[nodiscard]]
+	entry_range_type find_all(resource_type type, resource_id_type id) const noexcept;
+	[[nodiscard]]
+	entry_range_type find_all(resource_type type,
+		std::u16string_view name) const noexcept;
+	[[nodiscard]]
+	entry_range_type find_all(std::u16string_view type_name) const noexcept;
+	[[nodiscard]]
+	entry_range_type find_all(std::u16string_view type_name,
+		resource_id_type id) const noexcept;
+	[[nodiscard]]
+	entry_range_type find_all(std::u16string_view type_name,
+		std::u16string_view name) const noexcept;
+
+private:
+	struct key_type
+	{
+		name_or_id_type type;
+		name_or_id_type name_or_id;
+		resource_id_type language;
+
+		[[nodiscard]]
+		friend bool operator==(const key_type&, const key_type&) = default;
+	};
+
+	struct key_hash
+	{
+		[[nodiscard]]
+		std::size_t operator()(const key_type& key) const noexcept;
+	};
+
+private:
+	[[nodiscard]]
+	const data_entry_type* find(const key_type& key) const noexcept;
+	[[nodiscard]]
+	entry_range_type find_all(const name_or_id_type& type,
+		const name_or_id_type* name_or_id) const noexcept;
+
+private:
+	entry_list_type entries_;
+	std::unordered_map<key_type, const data_entry_type*, key_hash> lookup_;
+};
+
+using resource_index = resource_index_base<>;
+using resource_index_details = resource_index_base<error_list>;
+
+} //namespace pe_bliss::resources
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+
+#include "buffers/input_buffer_interface.h"
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/resources/manifest_accessor_interface.h"
+
+namespace pe_bliss::resources::streaming
+{
+
+namespace impl
+{
+struct streaming_manifest_accessor_impl;
+} //namespace impl
+
+//Manifest accessor, which parses the XML in a single forward pass
+//directly into flat arrays of nodes and attributes, without building
+//a DOM. Strings reference a single in-place decoded copy of the
+//manifest text. Follows the rules of pugixml_manifest_accessor:
+//processing instructions (other than the XML declaration) and DOCTYPE
+//are rejected as invalid XML. Supports UTF-8 (or ASCII) manifests and
+//UTF-16 manifests, which start with a byte order mark or with "<?",
+//and are transcoded to UTF-8 before parsing. Other encodings
+//(e.g. UTF-32 or code pages declared by the XML declaration)
+//are not supported.
+class [[nodiscard]] streaming_manifest_accessor final : public manifest_accessor_interface
+{
+public:
+	explicit streaming_manifest_accessor(const buffers::input_buffer_ptr& buffer);
+	~streaming_manifest_accessor() override;
+
+public:
+	[[nodiscard]]
+	virtual const error_list& get_errors() const noexcept override
+	{
+		return errors_;
+	}
+
+	[[nodiscard]]
+	virtual const manifest_node_interface* get_root() const override;
+
+	[[nodiscard]]
+	error_list& get_errors() noexcept
+	{
+		return errors_;
+	}
+
+private:
+	error_list errors_;
+	std::unique_ptr<impl::streaming_manifest_accessor_impl> impl_;
+};
+
+[[nodiscard]]
+manifest_accessor_interface_ptr parse_manifest(
+	const buffers::input_buffer_ptr& buffer);
+
+} //namespace pe_bliss::resources::streaming
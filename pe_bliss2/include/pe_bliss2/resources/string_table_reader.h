@@ -1,5 +1,14 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pe_bliss2/error_list.h"
+#include "pe_bliss2/resources/resource_directory.h"
+#include "pe_bliss2/resources/resource_types.h"
 #include "pe_bliss2/resources/string_table.h"
 
 namespace buffers
@@ -21,4 +30,92 @@ string_table string_table_from_resource(
 	buffers::input_buffer_stateful_wrapper_ref& buf,
 	const string_table_read_options& options = {});
 
+struct [[nodiscard]] string_tables_read_options
+{
+	bool allow_virtual_data = false;
+	bool decode_utf8 = false;
+};
+
+//Non-empty strings of all string table resources, stored in a single
+//UTF-16 buffer, and optionally transcoded to a single UTF-8 buffer.
+//String table resources which can not be read are reported as errors
+//with the string table ID as the context. Strings which were read
+//before the error are kept.
+class [[nodiscard]] string_table_arena : public error_list
+{
+public:
+	struct entry_type
+	{
+		resource_id_type language{};
+		string_table::id_type string_id{};
+		std::uint32_t offset{};
+		std::uint32_t length{};
+		std::uint32_t utf8_offset{};
+		std::uint32_t utf8_length{};
+	};
+
+	using entry_list_type = std::vector<entry_type>;
+
+public:
+	//Must be sorted by (language, string_id)
+	[[nodiscard]]
+	const entry_list_type& get_entries() const& noexcept
+	{
+		return entries_;
+	}
+
+	[[nodiscard]]
+	entry_list_type& get_entries() & noexcept
+	{
+		return entries_;
+	}
+
+	[[nodiscard]]
+	const std::u16string& get_utf16_data() const& noexcept
+	{
+		return utf16_data_;
+	}
+
+	[[nodiscard]]
+	std::u16string& get_utf16_data() & noexcept
+	{
+		return utf16_data_;
+	}
+
+	//Empty if UTF-8 strings were not decoded
+	[[nodiscard]]
+	const std::string& get_utf8_data() const& noexcept
+	{
+		return utf8_data_;
+	}
+
+	[[nodiscard]]
+	std::string& get_utf8_data() & noexcept
+	{
+		return utf8_data_;
+	}
+
+	[[nodiscard]]
+	const entry_type* find(string_table::id_type string_id,
+		resource_id_type language) const noexcept;
+
+	[[nodiscard]]
+	std::optional<std::u16string_view> get_string(string_table::id_type string_id,
+		resource_id_type language) const noexcept;
+	[[nodiscard]]
+	std::optional<std::string_view> get_utf8_string(string_table::id_type string_id,
+		resource_id_type language) const noexcept;
+
+private:
+	entry_list_type entries_;
+	std::u16string utf16_data_;
+	std::string utf8_data_;
+};
+
+template<typename... Bases>
+[[nodiscard]]
+string_table_arena string_tables_from_resources(
+	const resource_directory_base<Bases...>& root,
+	const string_tables_read_options& options = {});
+
 } //namespace pe_bliss::resources
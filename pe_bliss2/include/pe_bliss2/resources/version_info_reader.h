@@ -2,9 +2,12 @@
 
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <system_error>
 #include <type_traits>
 
+#include "pe_bliss2/resources/resource_types.h"
+#include "pe_bliss2/resources/version_info.h"
 #include "pe_bliss2/resources/version_info_block.h"
 
 namespace buffers
@@ -12,6 +15,11 @@ namespace buffers
 class input_buffer_stateful_wrapper_ref;
 } //namespace buffers
 
+namespace pe_bliss::image
+{
+class image;
+} //namespace pe_bliss::image
+
 namespace pe_bliss::resources
 {
 
@@ -44,6 +52,31 @@ version_info_block_details version_info_from_resource(
 	buffers::input_buffer_stateful_wrapper& buf,
 	const version_info_read_options& options = {});
 
+//Reads VS_FIXEDFILEINFO only, without decoding
+//the version info block tree. Throws pe_error
+//if the root block is malformed.
+[[nodiscard]]
+file_version_info fixed_file_info_from_resource(
+	buffers::input_buffer_stateful_wrapper_ref& buf,
+	bool allow_virtual_data = false);
+
+struct [[nodiscard]] fixed_file_info_read_options
+{
+	bool include_headers = true;
+	bool allow_virtual_data = false;
+	//First available language is used if not set
+	std::optional<resource_id_type> language;
+};
+
+//Locates the first RT_VERSION resource, loading only the resource
+//directories on the way to it. Returns nullopt if the image
+//has no version resource. Throws pe_error if the version resource
+//is present, but its root block is malformed (see fixed_file_info_from_resource).
+[[nodiscard]]
+std::optional<file_version_info> read_fixed_file_info(
+	const image::image& instance,
+	const fixed_file_info_read_options& options = {});
+
 } //namespace pe_bliss::resources
 
 namespace std
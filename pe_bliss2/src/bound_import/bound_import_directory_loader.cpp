@@ -1,6 +1,7 @@
 #include "pe_bliss2/bound_import/bound_import_directory_loader.h"
 
 #include <string>
+#include <string_view>
 #include <system_error>
 
 #include "pe_bliss2/core/data_directories.h"
@@ -9,6 +10,7 @@
 #include "pe_bliss2/image/struct_from_va.h"
 #include "pe_bliss2/pe_error.h"
 #include "utilities/math.h"
+#include "utilities/string.h"
 
 namespace
 {
@@ -83,17 +85,15 @@ void check_name_offset(Entry& entry, std::uint32_t descriptors_end_offset)
 		entry.add_error(bound_import_directory_loader_errc::name_offset_overlaps_descriptors);
 }
 
-bool load_next_entry(rva_type start_rva, const image::image& instance,
+bool load_library_entry(rva_type start_rva, const image::image& instance,
 	const loader_options& options, bound_library_details_list& list,
-	rva_type& current_rva, std::uint32_t& descriptor_count)
+	rva_type& current_rva)
 {
 	auto& elem = list.emplace_back();
-	const auto& descriptor = elem.get_descriptor();
 	try
 	{
 		current_rva = read_bound_import_entry(
 			current_rva, start_rva, instance, options, elem);
-		++descriptor_count;
 	}
 	catch (const std::system_error&)
 	{
@@ -101,13 +101,20 @@ bool load_next_entry(rva_type start_rva, const image::image& instance,
 		return false;
 	}
 
-	if (!descriptor->offset_module_name)
+	if (!elem.get_descriptor()->offset_module_name)
 	{
 		list.pop_back();
-		--descriptor_count;
 		return false;
 	}
 
+	return true;
+}
+
+bool load_references(rva_type start_rva, const image::image& instance,
+	const loader_options& options, bound_library_details& elem,
+	rva_type& current_rva)
+{
+	const auto& descriptor = elem.get_descriptor();
 	auto& references = elem.get_references();
 	references.reserve(descriptor->number_of_module_forwarder_refs);
 	for (std::uint32_t i = 0; i != descriptor->number_of_module_forwarder_refs; ++i)
@@ -128,10 +135,61 @@ bool load_next_entry(rva_type start_rva, const image::image& instance,
 			ref.add_error(bound_import_directory_loader_errc::invalid_library_name);
 	}
 
-	descriptor_count += descriptor->number_of_module_forwarder_refs;
 	return true;
 }
 
+bool load_next_entry(rva_type start_rva, const image::image& instance,
+	const loader_options& options, bound_library_details_list& list,
+	rva_type& current_rva, std::uint32_t& descriptor_count)
+{
+	if (!load_library_entry(start_rva, instance, options, list, current_rva))
+		return false;
+
+	++descriptor_count;
+	auto& elem = list.back();
+	if (!load_references(start_rva, instance, options, elem, current_rva))
+		return false;
+
+	descriptor_count += elem.get_descriptor()->number_of_module_forwarder_refs;
+	return true;
+}
+
+//Checks that forwarder reference descriptors of a library can be read
+//without reading their names. The eager loader stops at the first
+//unreadable reference descriptor.
+bool has_readable_references(const image::image& instance,
+	const loader_options& options, std::uint32_t reference_count,
+	rva_type& current_rva)
+{
+	bound_library_reference_details::descriptor_type descriptor;
+	for (std::uint32_t i = 0; i != reference_count; ++i)
+	{
+		try
+		{
+			struct_from_rva(instance, current_rva, descriptor,
+				options.include_headers, options.allow_virtual_data);
+		}
+		catch (const std::system_error&)
+		{
+			return false;
+		}
+
+		if (!utilities::math::add_if_safe<rva_type>(current_rva,
+			static_cast<rva_type>(descriptor.packed_size)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+std::uint32_t get_descriptors_end_offset(std::uint32_t descriptor_count) noexcept
+{
+	return (descriptor_count + 1u)
+		* static_cast<std::uint32_t>(
+			bound_library_details_list::value_type::descriptor_type::packed_size);
+}
+
 } //namespace
 
 namespace pe_bliss::bound_import
@@ -160,9 +218,7 @@ std::optional<bound_library_details_list> load(const image::image& instance,
 	{
 	}
 
-	auto descriptors_end_offset = (descriptor_count + 1u)
-		* static_cast<std::uint32_t>(
-			bound_library_details_list::value_type::descriptor_type::packed_size);
+	auto descriptors_end_offset = get_descriptors_end_offset(descriptor_count);
 	for (auto& entry : list)
 	{
 		check_name_offset(entry, descriptors_end_offset);
@@ -173,4 +229,83 @@ std::optional<bound_library_details_list> load(const image::image& instance,
 	return result;
 }
 
+lazy_bound_library_list::lazy_bound_library_list(const image::image& instance,
+	const loader_options& options)
+	: instance_(instance)
+	, options_(options)
+	, start_rva_(instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::bound_import)->virtual_address)
+{
+	auto current_rva = start_rva_;
+	std::uint32_t descriptor_count = 0;
+	while (true)
+	{
+		if (!load_library_entry(start_rva_, instance_, options_, list_, current_rva))
+		{
+			//Invalid entry is kept in the list
+			if (list_.size() != references_rvas_.size())
+				references_rvas_.emplace_back(current_rva);
+			break;
+		}
+
+		references_rvas_.emplace_back(current_rva);
+		++descriptor_count;
+		auto reference_count = list_.back().get_descriptor()->number_of_module_forwarder_refs;
+		//References of this library are loaded by get(), which reports the error
+		if (!has_readable_references(instance_, options_, reference_count, current_rva))
+			break;
+
+		descriptor_count += reference_count;
+	}
+
+	descriptors_end_offset_ = get_descriptors_end_offset(descriptor_count);
+	for (auto& entry : list_)
+		check_name_offset(entry, descriptors_end_offset_);
+	resolved_.resize(list_.size());
+}
+
+std::optional<std::size_t> lazy_bound_library_list::find_library(
+	std::string_view name) const noexcept
+{
+	for (std::size_t i = 0; i != list_.size(); ++i)
+	{
+		if (utilities::iequal(list_[i].get_library_name().value(), name))
+			return i;
+	}
+	return {};
+}
+
+const bound_library_details& lazy_bound_library_list::get(std::size_t index)
+{
+	auto& elem = list_.at(index);
+	if (resolved_[index])
+		return elem;
+
+	resolved_[index] = true;
+	if (elem.has_error(bound_import_directory_loader_errc::invalid_bound_import_entry))
+		return elem;
+
+	auto current_rva = references_rvas_[index];
+	load_references(start_rva_, instance_, options_, elem, current_rva);
+	for (auto& ref : elem.get_references())
+		check_name_offset(ref, descriptors_end_offset_);
+	return elem;
+}
+
+const bound_library_details_list& lazy_bound_library_list::resolve_all()
+{
+	for (std::size_t i = 0; i != list_.size(); ++i)
+		get(i);
+	return list_;
+}
+
+std::optional<lazy_bound_library_list> load_lazy(const image::image& instance,
+	const loader_options& options)
+{
+	std::optional<lazy_bound_library_list> result;
+	if (instance.get_data_directories().has_bound_import())
+		result.emplace(instance, options);
+	return result;
+}
+
 } //namespace pe_bliss::bound_import
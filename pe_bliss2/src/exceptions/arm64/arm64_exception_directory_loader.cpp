@@ -1,5 +1,6 @@
 #include "pe_bliss2/exceptions/arm64/arm64_exception_directory_loader.h"
 
+#include <optional>
 #include <system_error>
 #include <variant>
 
@@ -99,4 +100,12 @@ void load(const image::image& instance, const loader_options& options,
 		exception_directory_details>(instance, options, directory);
 }
 
+std::optional<lazy_exception_directory> load_lazy(const image::image& instance,
+	const loader_options& options)
+{
+	return arm_common::load_lazy<exception_directory_control,
+		packed_unwind_data, extended_unwind_record,
+		lazy_exception_directory>(instance, options);
+}
+
 } //namespace pe_bliss::exceptions::arm64
@@ -0,0 +1,129 @@
+#include "pe_bliss2/exceptions/columnar_exception_directory.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "pe_bliss2/exceptions/runtime_function_index.h"
+#include "pe_bliss2/pe_error.h"
+#include "utilities/generic_error.h"
+
+namespace
+{
+
+using namespace pe_bliss;
+using namespace pe_bliss::exceptions;
+
+std::uint32_t get_function_unwind_data(const x64::runtime_function& func) noexcept
+{
+	return func.get_descriptor()->unwind_info_address;
+}
+
+std::uint32_t get_function_unwind_data(const x64::runtime_function_details& func) noexcept
+{
+	return func.get_descriptor()->unwind_info_address;
+}
+
+std::uint32_t get_function_unwind_data(const arm64::runtime_function& func) noexcept
+{
+	return func.get_descriptor()->unwind_data;
+}
+
+std::uint32_t get_function_unwind_data(const arm64::runtime_function_details& func) noexcept
+{
+	return func.get_descriptor()->unwind_data;
+}
+
+} //namespace
+
+namespace pe_bliss::exceptions
+{
+
+template<typename RuntimeFunction>
+columnar_exception_directory<RuntimeFunction>::columnar_exception_directory(
+	runtime_function_list_type&& list)
+{
+	if (list.size() > (std::numeric_limits<std::uint32_t>::max)())
+		throw pe_error(utilities::generic_errc::integer_overflow);
+
+	auto less = [](const auto& l, const auto& r) {
+		return get_begin_rva(l) < get_begin_rva(r);
+	};
+	if (std::is_sorted(list.begin(), list.end(), less))
+	{
+		runtime_functions_ = std::move(list);
+	}
+	else
+	{
+		std::vector<std::uint32_t> order(list.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(),
+			[&list, &less](auto l, auto r) { return less(list[l], list[r]); });
+
+		runtime_functions_.reserve(list.size());
+		for (auto position : order)
+			runtime_functions_.emplace_back(std::move(list[position]));
+		list.clear();
+	}
+
+	begin_rvas_.reserve(runtime_functions_.size());
+	end_rvas_.reserve(runtime_functions_.size());
+	unwind_data_.reserve(runtime_functions_.size());
+	for (const auto& func : runtime_functions_)
+	{
+		begin_rvas_.push_back(get_begin_rva(func));
+		end_rvas_.push_back(get_end_rva(func));
+		unwind_data_.push_back(get_function_unwind_data(func));
+	}
+}
+
+template<typename RuntimeFunction>
+std::optional<std::size_t> columnar_exception_directory<RuntimeFunction>::find(
+	rva_type rva) const noexcept
+{
+	auto it = std::upper_bound(begin_rvas_.begin(), begin_rvas_.end(), rva);
+	if (it == begin_rvas_.begin())
+		return {};
+
+	const auto position = static_cast<std::size_t>(it - begin_rvas_.begin()) - 1u;
+	if (rva < end_rvas_[position])
+		return position;
+	return {};
+}
+
+template<typename RuntimeFunction>
+std::uint64_t columnar_exception_directory<RuntimeFunction>::get_covered_size()
+	const noexcept
+{
+	std::uint64_t result = 0;
+	rva_type covered_end = 0;
+	for (std::size_t i = 0; i != begin_rvas_.size(); ++i)
+	{
+		const auto begin = (std::max)(begin_rvas_[i], covered_end);
+		const auto end = end_rvas_[i];
+		if (end > begin)
+		{
+			result += end - begin;
+			covered_end = end;
+		}
+	}
+	return result;
+}
+
+template<typename RuntimeFunction>
+auto columnar_exception_directory<RuntimeFunction>::release() && noexcept
+	-> runtime_function_list_type
+{
+	begin_rvas_.clear();
+	end_rvas_.clear();
+	unwind_data_.clear();
+	return std::move(runtime_functions_);
+}
+
+template class columnar_exception_directory<x64::runtime_function>;
+template class columnar_exception_directory<x64::runtime_function_details>;
+template class columnar_exception_directory<arm64::runtime_function>;
+template class columnar_exception_directory<arm64::runtime_function_details>;
+
+} //namespace pe_bliss::exceptions
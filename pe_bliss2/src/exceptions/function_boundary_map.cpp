@@ -0,0 +1,363 @@
+#include "pe_bliss2/exceptions/function_boundary_map.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "pe_bliss2/core/optional_header.h"
+#include "pe_bliss2/exceptions/exception_directory_loader.h"
+#include "pe_bliss2/exceptions/runtime_function_index.h"
+#include "pe_bliss2/exports/export_directory_loader.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/load_config/load_config_directory_loader.h"
+#include "pe_bliss2/pe_error.h"
+
+namespace
+{
+
+struct function_boundary_map_error_category : std::error_category
+{
+	const char* name() const noexcept override
+	{
+		return "function_boundary_map";
+	}
+
+	std::string message(int ev) const override
+	{
+		using enum pe_bliss::exceptions::function_boundary_map_errc;
+		switch (static_cast<pe_bliss::exceptions::function_boundary_map_errc>(ev))
+		{
+		case mismatched_end_rva_count:
+			return "Number of function end RVAs does not match the number of function begin RVAs";
+		case invalid_exception_directory:
+			return "Unable to load exception directory";
+		case invalid_load_config_directory:
+			return "Unable to load load configuration directory";
+		case invalid_export_directory:
+			return "Unable to load export directory";
+		default:
+			return {};
+		}
+	}
+};
+
+const function_boundary_map_error_category function_boundary_map_error_category_instance;
+
+using namespace pe_bliss;
+using namespace pe_bliss::exceptions;
+
+struct list_cursor
+{
+	std::span<const rva_type> begin_rvas;
+	std::span<const rva_type> end_rvas;
+	std::size_t position{};
+	std::uint8_t source{};
+};
+
+void add_runtime_functions(const exception_directory_details& directory,
+	std::vector<rva_type>& begin_rvas, std::vector<rva_type>& end_rvas)
+{
+	for (const auto& dir : directory.get_directories())
+	{
+		std::visit([&begin_rvas, &end_rvas] (const auto& value) {
+			using type = std::remove_cvref_t<decltype(value)>;
+			for (const auto& func : value.get_runtime_function_list())
+			{
+				if constexpr (std::is_same_v<type, arm::exception_directory_details>)
+				{
+					//Thumb bit is set for ARM function begin RVAs,
+					//end RVAs are unknown
+					begin_rvas.push_back(func.get_descriptor()->begin_address & ~1u);
+					end_rvas.push_back(0u);
+				}
+				else
+				{
+					begin_rvas.push_back(get_begin_rva(func));
+					end_rvas.push_back(get_end_rva(func));
+				}
+			}
+		}, dir);
+	}
+}
+
+} //namespace
+
+namespace pe_bliss::exceptions
+{
+
+std::error_code make_error_code(function_boundary_map_errc e) noexcept
+{
+	return { static_cast<int>(e), function_boundary_map_error_category_instance };
+}
+
+function_boundary_map::function_boundary_map(
+	std::span<const function_start_list> lists, rva_type image_end_rva)
+{
+	std::vector<std::vector<rva_type>> sorted_lists;
+	sorted_lists.reserve(lists.size() * 2u);
+	std::vector<list_cursor> cursors;
+	cursors.reserve(lists.size());
+	std::size_t total_size = 0;
+	for (const auto& list : lists)
+	{
+		if (!list.end_rvas.empty() && list.end_rvas.size() != list.begin_rvas.size())
+			throw pe_error(function_boundary_map_errc::mismatched_end_rva_count);
+
+		if (list.begin_rvas.empty())
+			continue;
+
+		auto& cursor = cursors.emplace_back(list_cursor{
+			.begin_rvas = list.begin_rvas,
+			.end_rvas = list.end_rvas,
+			.source = list.source
+		});
+		total_size += list.begin_rvas.size();
+
+		if (std::is_sorted(list.begin_rvas.begin(), list.begin_rvas.end()))
+			continue;
+
+		std::vector<std::size_t> order(list.begin_rvas.size());
+		std::iota(order.begin(), order.end(), std::size_t{});
+		std::stable_sort(order.begin(), order.end(),
+			[&list](auto l, auto r) { return list.begin_rvas[l] < list.begin_rvas[r]; });
+
+		auto& begin_rvas = sorted_lists.emplace_back();
+		begin_rvas.reserve(order.size());
+		for (auto position : order)
+			begin_rvas.push_back(list.begin_rvas[position]);
+		cursor.begin_rvas = begin_rvas;
+
+		if (!list.end_rvas.empty())
+		{
+			auto& end_rvas = sorted_lists.emplace_back();
+			end_rvas.reserve(order.size());
+			for (auto position : order)
+				end_rvas.push_back(list.end_rvas[position]);
+			cursor.end_rvas = end_rvas;
+		}
+	}
+
+	starts_.reserve(total_size);
+	ends_.reserve(total_size);
+	sources_.reserve(total_size);
+
+	//K-way merge, heap top is the cursor with the lowest current begin RVA
+	auto greater = [&cursors](std::size_t l, std::size_t r) {
+		return cursors[l].begin_rvas[cursors[l].position]
+			> cursors[r].begin_rvas[cursors[r].position];
+	};
+	std::vector<std::size_t> heap(cursors.size());
+	std::iota(heap.begin(), heap.end(), std::size_t{});
+	std::make_heap(heap.begin(), heap.end(), greater);
+	while (!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end(), greater);
+		auto& cursor = cursors[heap.back()];
+		const auto begin = cursor.begin_rvas[cursor.position];
+		auto end = cursor.end_rvas.empty() ? 0u : cursor.end_rvas[cursor.position];
+		if (end <= begin)
+			end = 0u;
+
+		if (!starts_.empty() && starts_.back() == begin)
+		{
+			sources_.back() |= cursor.source;
+			ends_.back() = (std::max)(ends_.back(), end);
+		}
+		else
+		{
+			starts_.push_back(begin);
+			ends_.push_back(end);
+			sources_.push_back(cursor.source);
+		}
+
+		if (++cursor.position == cursor.begin_rvas.size())
+			heap.pop_back();
+		else
+			std::push_heap(heap.begin(), heap.end(), greater);
+	}
+
+	for (std::size_t i = 0; i != starts_.size(); ++i)
+	{
+		auto& end = ends_[i];
+		if (i + 1u != starts_.size())
+		{
+			const auto next = starts_[i + 1u];
+			if (!end || end > next)
+				end = next;
+		}
+		else if (!end)
+		{
+			end = (std::max)(image_end_rva, starts_[i]);
+		}
+	}
+}
+
+function_range function_boundary_map::get_range(std::size_t index) const noexcept
+{
+	return { starts_[index], ends_[index] };
+}
+
+bool function_boundary_map::contains(rva_type rva) const noexcept
+{
+	return std::binary_search(starts_.begin(), starts_.end(), rva);
+}
+
+std::optional<std::size_t> function_boundary_map::find(rva_type rva) const noexcept
+{
+	auto it = std::upper_bound(starts_.begin(), starts_.end(), rva);
+	if (it == starts_.begin())
+		return {};
+
+	const auto position = static_cast<std::size_t>(it - starts_.begin()) - 1u;
+	if (rva < ends_[position])
+		return position;
+	return {};
+}
+
+std::span<const rva_type> function_boundary_map::get_starts_in(rva_type first,
+	rva_type last) const noexcept
+{
+	if (first >= last)
+		return {};
+
+	auto from = std::lower_bound(starts_.begin(), starts_.end(), first);
+	auto to = std::lower_bound(from, starts_.end(), last);
+	return { from, to };
+}
+
+std::uint64_t function_boundary_map::get_covered_size() const noexcept
+{
+	std::uint64_t result = 0;
+	for (std::size_t i = 0; i != starts_.size(); ++i)
+		result += ends_[i] - starts_[i];
+	return result;
+}
+
+function_boundary_map build_function_boundary_map(const image::image& instance,
+	const function_boundary_map_options& options)
+{
+	std::vector<function_boundary_map_errc> errors;
+
+	std::vector<rva_type> runtime_begin_rvas, runtime_end_rvas;
+	if (options.use_runtime_functions)
+	{
+		try
+		{
+			const auto directory = exceptions::load(instance, {
+				.x64_loader_options = {
+					.include_headers = options.include_headers,
+					.allow_virtual_data = options.allow_virtual_data
+				},
+				.arm64_loader_options = {
+					.include_headers = options.include_headers,
+					.allow_virtual_data = options.allow_virtual_data
+				},
+				.arm_loader_options = {
+					.include_headers = options.include_headers,
+					.allow_virtual_data = options.allow_virtual_data
+				}
+			});
+			add_runtime_functions(directory, runtime_begin_rvas, runtime_end_rvas);
+		}
+		catch (const std::system_error&)
+		{
+			errors.push_back(function_boundary_map_errc::invalid_exception_directory);
+		}
+	}
+
+	std::vector<rva_type> guard_rvas;
+	if (options.use_guard_cf_function_table)
+	{
+		try
+		{
+			const auto directory = load_config::load(instance, {
+				.include_headers = options.include_headers,
+				.allow_virtual_data = options.allow_virtual_data,
+				.load_lock_prefix_table = false,
+				.load_safeseh_handler_table = false,
+				.load_cf_guard_function_table = true,
+				.load_cf_guard_longjump_table = false,
+				.load_cf_guard_export_suppression_table = false,
+				.load_chpe_metadata = false,
+				.load_dynamic_relocation_table = false,
+				.load_enclave_config = false,
+				.load_volatile_metadata = false,
+				.load_ehcont_targets = false,
+				.load_xfg_type_based_hashes = false
+			});
+
+			if (directory)
+			{
+				std::visit([&guard_rvas] (const auto& value) {
+					const auto& table = value.get_guard_cf_function_table();
+					if (!table)
+						return;
+
+					guard_rvas.reserve(table->size());
+					for (const auto& func : *table)
+						guard_rvas.push_back(func.get_rva().get());
+				}, directory->get_value());
+			}
+		}
+		catch (const std::system_error&)
+		{
+			errors.push_back(function_boundary_map_errc::invalid_load_config_directory);
+		}
+	}
+
+	std::vector<rva_type> export_rvas;
+	if (options.use_exports)
+	{
+		try
+		{
+			const auto directory = exports::load(instance, {
+				.include_headers = options.include_headers,
+				.allow_virtual_data = options.allow_virtual_data
+			});
+
+			if (directory)
+			{
+				for (const auto& exported : directory->get_export_list())
+				{
+					const auto rva = exported.get_rva().get();
+					if (rva && !exported.get_forwarded_name())
+						export_rvas.push_back(rva);
+				}
+			}
+		}
+		catch (const std::system_error&)
+		{
+			errors.push_back(function_boundary_map_errc::invalid_export_directory);
+		}
+	}
+
+	const function_start_list lists[]{
+		{
+			.begin_rvas = runtime_begin_rvas,
+			.end_rvas = runtime_end_rvas,
+			.source = function_start_source::runtime_function
+		},
+		{
+			.begin_rvas = guard_rvas,
+			.end_rvas = {},
+			.source = function_start_source::guard_cf_function
+		},
+		{
+			.begin_rvas = export_rvas,
+			.end_rvas = {},
+			.source = function_start_source::exported_function
+		}
+	};
+
+	function_boundary_map result(lists,
+		instance.get_optional_header().get_raw_size_of_image());
+	for (auto error : errors)
+		result.add_error(error);
+	return result;
+}
+
+} //namespace pe_bliss::exceptions
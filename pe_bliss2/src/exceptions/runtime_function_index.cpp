@@ -0,0 +1,246 @@
+#include "pe_bliss2/exceptions/runtime_function_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <variant>
+
+#include "pe_bliss2/detail/exceptions/image_runtime_function_entry.h"
+#include "pe_bliss2/pe_error.h"
+#include "utilities/generic_error.h"
+
+namespace
+{
+
+using namespace pe_bliss;
+using namespace pe_bliss::exceptions;
+
+constexpr rva_type page_shift = 12u;
+
+template<typename RuntimeFunction>
+rva_type get_x64_end_rva(const RuntimeFunction& func) noexcept
+{
+	return func.get_descriptor()->end_address;
+}
+
+template<typename RuntimeFunction>
+rva_type get_arm64_end_rva(const RuntimeFunction& func) noexcept
+{
+	const auto begin = func.get_descriptor()->begin_address;
+	std::uint32_t length = 0;
+	if (const auto* packed = std::get_if<arm64::packed_unwind_data>(
+		&func.get_unwind_info()); packed)
+	{
+		length = packed->get_function_length();
+	}
+	else if (const auto* extended = std::get_if<arm64::extended_unwind_record>(
+		&func.get_unwind_info()); extended)
+	{
+		length = extended->get_function_length();
+	}
+
+	if (length > (std::numeric_limits<rva_type>::max)() - begin)
+		return begin;
+	return begin + length;
+}
+
+template<typename RuntimeFunction>
+const RuntimeFunction* find_primary_function_impl(
+	const exceptions::runtime_function_index<RuntimeFunction>& index,
+	const RuntimeFunction& func) noexcept
+{
+	const RuntimeFunction* current = &func;
+	for (std::uint32_t i = 0; i <= detail::exceptions::unwind_chain_limit; ++i)
+	{
+		if (!(current->get_unwind_info().get_unwind_flags()
+			& x64::unwind_flags::chaininfo))
+		{
+			return index.find_by_begin_rva(current->get_descriptor()->begin_address);
+		}
+
+		const auto* chained = std::get_if<typename RuntimeFunction::runtime_function_ptr>(
+			&current->get_additional_info());
+		if (!chained || !*chained)
+			return nullptr;
+
+		current = chained->get();
+	}
+	return nullptr;
+}
+
+} //namespace
+
+namespace pe_bliss::exceptions
+{
+
+template<typename RuntimeFunction>
+runtime_function_index<RuntimeFunction>::runtime_function_index(
+	const runtime_function_list_type& list,
+	const runtime_function_index_options& options)
+	: list_(list)
+{
+	if (list.size() > (std::numeric_limits<std::uint32_t>::max)())
+		throw pe_error(utilities::generic_errc::integer_overflow);
+
+	auto less = [](const auto& l, const auto& r) {
+		return get_begin_rva(l) < get_begin_rva(r);
+	};
+	if (!std::is_sorted(list.begin(), list.end(), less))
+	{
+		order_.resize(list.size());
+		std::iota(order_.begin(), order_.end(), 0u);
+		std::stable_sort(order_.begin(), order_.end(),
+			[&list, &less](auto l, auto r) { return less(list[l], list[r]); });
+	}
+
+	if (!options.build_page_table || list.empty())
+		return;
+
+	first_page_ = get_begin_rva(at(0)) >> page_shift;
+	const auto last_page = get_begin_rva(at(list.size() - 1u)) >> page_shift;
+	page_table_.resize(last_page - first_page_ + 2u);
+	std::uint32_t position = 0;
+	for (std::size_t page = 0; page != page_table_.size(); ++page)
+	{
+		const auto page_rva = static_cast<std::uint64_t>(first_page_ + page) << page_shift;
+		while (position != list.size() && get_begin_rva(at(position)) < page_rva)
+			++position;
+		page_table_[page] = position;
+	}
+}
+
+template<typename RuntimeFunction>
+std::size_t runtime_function_index<RuntimeFunction>::upper_bound(
+	rva_type rva) const noexcept
+{
+	std::size_t first = 0;
+	std::size_t last = list_.size();
+	if (!page_table_.empty())
+	{
+		const auto page = rva >> page_shift;
+		if (page < first_page_)
+			return 0u;
+		if (page - first_page_ + 1u < page_table_.size())
+		{
+			first = page_table_[page - first_page_];
+			last = page_table_[page - first_page_ + 1u];
+		}
+		else
+		{
+			first = page_table_.back();
+		}
+	}
+
+	while (first != last)
+	{
+		const auto middle = first + (last - first) / 2u;
+		if (get_begin_rva(at(middle)) <= rva)
+			first = middle + 1u;
+		else
+			last = middle;
+	}
+	return first;
+}
+
+template<typename RuntimeFunction>
+auto runtime_function_index<RuntimeFunction>::find(rva_type rva) const noexcept
+	-> const runtime_function_type*
+{
+	const auto position = upper_bound(rva);
+	if (!position)
+		return nullptr;
+
+	const auto& func = at(position - 1u);
+	return rva < get_end_rva(func) ? &func : nullptr;
+}
+
+template<typename RuntimeFunction>
+auto runtime_function_index<RuntimeFunction>::find_by_begin_rva(
+	rva_type rva) const noexcept -> const runtime_function_type*
+{
+	const auto position = upper_bound(rva);
+	if (!position)
+		return nullptr;
+
+	const auto& func = at(position - 1u);
+	return get_begin_rva(func) == rva ? &func : nullptr;
+}
+
+rva_type get_begin_rva(const x64::runtime_function& func) noexcept
+{
+	return func.get_descriptor()->begin_address;
+}
+
+rva_type get_begin_rva(const x64::runtime_function_details& func) noexcept
+{
+	return func.get_descriptor()->begin_address;
+}
+
+rva_type get_begin_rva(const arm64::runtime_function& func) noexcept
+{
+	return func.get_descriptor()->begin_address;
+}
+
+rva_type get_begin_rva(const arm64::runtime_function_details& func) noexcept
+{
+	return func.get_descriptor()->begin_address;
+}
+
+rva_type get_end_rva(const x64::runtime_function& func) noexcept
+{
+	return get_x64_end_rva(func);
+}
+
+rva_type get_end_rva(const x64::runtime_function_details& func) noexcept
+{
+	return get_x64_end_rva(func);
+}
+
+rva_type get_end_rva(const arm64::runtime_function& func) noexcept
+{
+	return get_arm64_end_rva(func);
+}
+
+rva_type get_end_rva(const arm64::runtime_function_details& func) noexcept
+{
+	return get_arm64_end_rva(func);
+}
+
+template class runtime_function_index<x64::runtime_function>;
+template class runtime_function_index<x64::runtime_function_details>;
+template class runtime_function_index<arm64::runtime_function>;
+template class runtime_function_index<arm64::runtime_function_details>;
+
+} //namespace pe_bliss::exceptions
+
+namespace pe_bliss::exceptions::x64
+{
+
+const runtime_function* find_primary_function(
+	const runtime_function_index& index, const runtime_function& func) noexcept
+{
+	return find_primary_function_impl(index, func);
+}
+
+const runtime_function_details* find_primary_function(
+	const runtime_function_index_details& index,
+	const runtime_function_details& func) noexcept
+{
+	return find_primary_function_impl(index, func);
+}
+
+const runtime_function* find_primary_function(
+	const runtime_function_index& index, rva_type rva) noexcept
+{
+	const auto* func = index.find(rva);
+	return func ? find_primary_function_impl(index, *func) : nullptr;
+}
+
+const runtime_function_details* find_primary_function(
+	const runtime_function_index_details& index, rva_type rva) noexcept
+{
+	const auto* func = index.find(rva);
+	return func ? find_primary_function_impl(index, *func) : nullptr;
+}
+
+} //namespace pe_bliss::exceptions::x64
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -353,6 +354,27 @@ bool load_runtime_function(const image::image& instance, const loader_options& o
 	return true;
 }
 
+void decode_runtime_function(const image::image& instance, const loader_options& options,
+	rva_type current_rva, runtime_function_details& func)
+{
+	try
+	{
+		load_runtime_function(instance, options, current_rva, func);
+	}
+	catch (const std::system_error&)
+	{
+		func.add_error(exception_directory_loader_errc::invalid_runtime_function_entry);
+	}
+}
+
+bool has_exception_directory(const image::image& instance)
+{
+	return instance.is_64bit()
+		&& instance.get_file_header().get_machine_type()
+			== core::file_header::machine_type::amd64
+		&& instance.get_data_directories().has_exception_directory();
+}
+
 } //namespace
 
 namespace pe_bliss::exceptions::x64
@@ -366,13 +388,8 @@ std::error_code make_error_code(exception_directory_loader_errc e) noexcept
 void load(const image::image& instance, const loader_options& options,
 	pe_bliss::exceptions::exception_directory_details& directory)
 {
-	if (!instance.is_64bit()
-		|| instance.get_file_header().get_machine_type()
-			!= core::file_header::machine_type::amd64
-		|| !instance.get_data_directories().has_exception_directory())
-	{
+	if (!has_exception_directory(instance))
 		return;
-	}
 
 	auto data_dir = instance.get_data_directories().get_directory(
 		core::data_directories::directory_type::exception);
@@ -417,4 +434,18 @@ void load(const image::image& instance, const loader_options& options,
 		x64_dir.add_error(exception_directory_loader_errc::unmatched_directory_size);
 }
 
+std::optional<lazy_exception_directory> load_lazy(const image::image& instance,
+	const loader_options& options)
+{
+	std::optional<lazy_exception_directory> result;
+	if (!has_exception_directory(instance))
+		return result;
+
+	auto data_dir = instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::exception);
+	result.emplace(instance, options, &decode_runtime_function,
+		data_dir->virtual_address, data_dir->size);
+	return result;
+}
+
 } //namespace pe_bliss::exceptions::x64
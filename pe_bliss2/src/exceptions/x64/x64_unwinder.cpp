@@ -0,0 +1,444 @@
+#include "pe_bliss2/exceptions/x64/x64_unwinder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <variant>
+
+#include <boost/endian/conversion.hpp>
+
+#include "pe_bliss2/core/optional_header.h"
+#include "pe_bliss2/detail/endian_convert.h"
+#include "pe_bliss2/detail/exceptions/image_runtime_function_entry.h"
+#include "pe_bliss2/exceptions/exception_directory.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/pe_error.h"
+
+namespace
+{
+
+struct x64_unwinder_error_category : std::error_category
+{
+	const char* name() const noexcept override
+	{
+		return "x64_unwinder";
+	}
+
+	std::string message(int ev) const override
+	{
+		using enum pe_bliss::exceptions::x64::unwinder_errc;
+		switch (static_cast<pe_bliss::exceptions::x64::unwinder_errc>(ev))
+		{
+		case overlapping_images:
+			return "Image overlaps with already registered image";
+		case unknown_instruction_pointer:
+			return "Instruction pointer does not belong to any registered image";
+		case unable_to_read_memory:
+			return "Unable to read stack memory";
+		case invalid_unwind_info:
+			return "Invalid unwind info";
+		case invalid_stack_pointer:
+			return "Stack pointer of the caller frame is not above the stack pointer of the callee";
+		case unknown_runtime_function:
+			return "Runtime function does not belong to any registered image";
+		default:
+			return {};
+		}
+	}
+};
+
+const x64_unwinder_error_category x64_unwinder_error_category_instance;
+
+using namespace pe_bliss;
+using namespace pe_bliss::exceptions::x64;
+
+bool has_invalid_unwind_info(const runtime_function_details& func) noexcept
+{
+	return func.has_error(exception_directory_loader_errc::invalid_runtime_function_entry)
+		|| func.has_error(exception_directory_loader_errc::invalid_unwind_info)
+		|| func.has_error(exception_directory_loader_errc::invalid_unwind_info_flags)
+		|| func.has_error(exception_directory_loader_errc::unknown_unwind_code)
+		|| func.has_error(exception_directory_loader_errc::invalid_unwind_slot_count)
+		|| func.has_error(
+			exception_directory_loader_errc::invalid_chained_runtime_function_entry);
+}
+
+std::uint8_t to_index(register_id reg) noexcept
+{
+	return static_cast<std::uint8_t>(reg);
+}
+
+bool append_operations(const runtime_function_details& func, bool chained,
+	std::vector<unwind_operation>& operations)
+{
+	const auto& info = func.get_unwind_info();
+	bool valid = true;
+	for (const auto& code : info.get_unwind_code_list())
+	{
+		std::visit([&operations, &info, &valid, chained] (const auto& code) {
+			using code_type = std::remove_cvref_t<decltype(code)>;
+			unwind_operation op;
+			op.offset_in_prolog = chained ? 0u : code.get_descriptor()->offset_in_prolog;
+			if constexpr (std::is_same_v<code_type, push_nonvol>)
+			{
+				op.operation = unwind_operation::type::push_register;
+				op.reg = to_index(code.get_register());
+			}
+			else if constexpr (std::is_same_v<code_type, alloc_large<1u>>
+				|| std::is_same_v<code_type, alloc_large<2u>>
+				|| std::is_same_v<code_type, alloc_small>)
+			{
+				op.operation = unwind_operation::type::allocate;
+				op.value = code.get_allocation_size();
+			}
+			else if constexpr (std::is_same_v<code_type, set_fpreg>
+				|| std::is_same_v<code_type, set_fpreg_large>)
+			{
+				auto frame_register = info.get_frame_register();
+				if (!frame_register)
+				{
+					valid = false;
+					return;
+				}
+
+				op.operation = unwind_operation::type::set_frame;
+				op.reg = to_index(*frame_register);
+				//The scaled offset is stored in the high nibble,
+				//so it is already multiplied by 16
+				if constexpr (std::is_same_v<code_type, set_fpreg>)
+					op.value = info.get_scaled_frame_register_offset();
+				else
+					op.value = code.get_offset();
+			}
+			else if constexpr (std::is_same_v<code_type, save_nonvol>
+				|| std::is_same_v<code_type, save_nonvol_far>)
+			{
+				op.operation = unwind_operation::type::restore_register;
+				op.reg = to_index(code.get_register());
+				op.value = code.get_stack_offset();
+			}
+			else if constexpr (std::is_same_v<code_type, save_xmm128>
+				|| std::is_same_v<code_type, save_xmm128_far>)
+			{
+				op.operation = unwind_operation::type::restore_xmm;
+				op.reg = to_index(code.get_register());
+				op.value = code.get_stack_offset();
+			}
+			else if constexpr (std::is_same_v<code_type, push_machframe>)
+			{
+				op.operation = unwind_operation::type::push_machine_frame;
+				op.value = code.push_error_code() ? sizeof(std::uint64_t) : 0u;
+			}
+			else
+			{
+				//Epilog and spare codes do not affect unwinding
+				return;
+			}
+			operations.push_back(op);
+		}, code);
+	}
+	return valid;
+}
+
+unwind_program create_unwind_program(const runtime_function_details& func)
+{
+	unwind_program program;
+	const runtime_function_details* current = &func;
+	for (std::uint32_t i = 0; i <= detail::exceptions::unwind_chain_limit; ++i)
+	{
+		if (has_invalid_unwind_info(*current)
+			|| !append_operations(*current, current != &func, program.operations))
+		{
+			program.error = unwinder_errc::invalid_unwind_info;
+			return program;
+		}
+
+		if (!(current->get_unwind_info().get_unwind_flags() & unwind_flags::chaininfo))
+			return program;
+
+		const auto* chained = std::get_if<runtime_function_details::runtime_function_ptr>(
+			&current->get_additional_info());
+		if (!chained || !*chained)
+			break;
+		current = chained->get();
+	}
+
+	program.error = unwinder_errc::invalid_unwind_info;
+	return program;
+}
+
+} //namespace
+
+namespace pe_bliss::exceptions::x64
+{
+
+std::error_code make_error_code(unwinder_errc e) noexcept
+{
+	return { static_cast<int>(e), x64_unwinder_error_category_instance };
+}
+
+struct unwinder::loaded_image
+{
+	loaded_image(std::uint64_t image_base, std::uint32_t image_size,
+		exception_directory_details&& dir)
+		: base(image_base)
+		, size(image_size)
+		, directory(std::move(dir))
+		, index(directory.get_runtime_function_list(), { .build_page_table = true })
+		, programs(directory.get_runtime_function_list().size())
+	{
+	}
+
+	[[nodiscard]]
+	bool contains(const runtime_function_details& func) const noexcept
+	{
+		const auto& list = directory.get_runtime_function_list();
+		return !list.empty()
+			&& std::less_equal<>{}(list.data(), &func)
+			&& std::less<>{}(&func, list.data() + list.size());
+	}
+
+	[[nodiscard]]
+	const unwind_program& get_program(const runtime_function_details& func)
+	{
+		auto& program = programs[static_cast<std::size_t>(
+			&func - directory.get_runtime_function_list().data())];
+		if (!program)
+			program = create_unwind_program(func);
+		return *program;
+	}
+
+	std::uint64_t base;
+	std::uint32_t size;
+	exception_directory_details directory;
+	runtime_function_index_details index;
+	std::vector<std::optional<unwind_program>> programs;
+};
+
+unwinder::unwinder(memory_reader_type memory_reader)
+	: memory_reader_(std::move(memory_reader))
+{
+}
+
+unwinder::~unwinder() = default;
+unwinder::unwinder(unwinder&&) noexcept = default;
+unwinder& unwinder::operator=(unwinder&&) noexcept = default;
+
+void unwinder::add_image(const image::image& instance, std::uint64_t image_base,
+	const loader_options& options)
+{
+	pe_bliss::exceptions::exception_directory_details loaded;
+	load(instance, options, loaded);
+
+	exception_directory_details directory;
+	if (!loaded.get_directories().empty())
+	{
+		directory = std::move(std::get<exception_directory_details>(
+			loaded.get_directories()[0]));
+	}
+
+	add_image(image_base, instance.get_optional_header().get_raw_size_of_image(),
+		std::move(directory));
+}
+
+void unwinder::add_image(std::uint64_t image_base, std::uint32_t image_size,
+	exception_directory_details&& directory)
+{
+	add_image(std::make_unique<loaded_image>(image_base, image_size, std::move(directory)));
+}
+
+void unwinder::add_image(std::unique_ptr<loaded_image> image)
+{
+	auto it = std::upper_bound(images_.begin(), images_.end(), image->base,
+		[] (std::uint64_t base, const auto& loaded) { return base < loaded->base; });
+	if (it != images_.begin())
+	{
+		const auto& prev = *(it - 1);
+		if (image->base - prev->base < prev->size)
+			throw pe_error(unwinder_errc::overlapping_images);
+	}
+	if (it != images_.end() && (*it)->base - image->base < image->size)
+		throw pe_error(unwinder_errc::overlapping_images);
+
+	images_.insert(it, std::move(image));
+}
+
+std::size_t unwinder::get_image_count() const noexcept
+{
+	return images_.size();
+}
+
+unwinder::loaded_image* unwinder::find_image(std::uint64_t address) const noexcept
+{
+	auto it = std::upper_bound(images_.begin(), images_.end(), address,
+		[] (std::uint64_t address, const auto& loaded) { return address < loaded->base; });
+	if (it == images_.begin())
+		return nullptr;
+
+	auto* image = (it - 1)->get();
+	if (address - image->base >= image->size)
+		return nullptr;
+	return image;
+}
+
+std::uint64_t unwinder::read_qword(std::uint64_t address) const
+{
+	std::array<std::byte, sizeof(std::uint64_t)> data;
+	if (!memory_reader_(address, data))
+		throw pe_error(unwinder_errc::unable_to_read_memory);
+
+	std::uint64_t value;
+	std::memcpy(&value, data.data(), sizeof(value));
+	detail::convert_endianness<boost::endian::order::little,
+		boost::endian::order::native>(value);
+	return value;
+}
+
+xmm_register unwinder::read_xmm(std::uint64_t address) const
+{
+	std::array<std::byte, sizeof(std::uint64_t) * 2u> data;
+	if (!memory_reader_(address, data))
+		throw pe_error(unwinder_errc::unable_to_read_memory);
+
+	xmm_register value;
+	std::memcpy(&value.low, data.data(), sizeof(value.low));
+	std::memcpy(&value.high, data.data() + sizeof(value.low), sizeof(value.high));
+	detail::convert_endianness<boost::endian::order::little,
+		boost::endian::order::native>(value.low);
+	detail::convert_endianness<boost::endian::order::little,
+		boost::endian::order::native>(value.high);
+	return value;
+}
+
+const unwind_program& unwinder::get_unwind_program(const runtime_function_details& func)
+{
+	for (const auto& image : images_)
+	{
+		if (image->contains(func))
+			return image->get_program(func);
+	}
+
+	throw pe_error(unwinder_errc::unknown_runtime_function);
+}
+
+const runtime_function_details* unwinder::unwind(unwind_context& context)
+{
+	auto* image = find_image(context.rip);
+	if (!image)
+		throw pe_error(unwinder_errc::unknown_instruction_pointer);
+
+	const auto rva = static_cast<rva_type>(context.rip - image->base);
+	const auto* func = image->index.find(rva);
+	if (!func)
+	{
+		//Leaf function, which does not modify the stack
+		auto& rsp = context.get_rsp();
+		context.rip = read_qword(rsp);
+		rsp += sizeof(std::uint64_t);
+		return nullptr;
+	}
+
+	const auto& program = image->get_program(*func);
+	if (program.error)
+		throw pe_error(program.error);
+
+	//Work on the copy to leave the context intact if unwinding fails
+	auto result = context;
+	auto& rsp = result.get_rsp();
+	bool has_machine_frame = false;
+	const auto offset = rva - func->get_descriptor()->begin_address;
+
+	//Saved registers are addressed relative to the establisher frame,
+	//which is the frame register value minus its offset once the frame
+	//register is set, and RSP otherwise. The body may move RSP after that.
+	auto frame_base = rsp;
+	for (const auto& op : program.operations)
+	{
+		if (op.operation == unwind_operation::type::set_frame
+			&& offset >= op.offset_in_prolog)
+		{
+			frame_base = result.registers[op.reg] - op.value;
+			break;
+		}
+	}
+
+	for (const auto& op : program.operations)
+	{
+		if (offset < op.offset_in_prolog)
+			continue;
+
+		switch (op.operation)
+		{
+		case unwind_operation::type::push_register:
+			result.registers[op.reg] = read_qword(rsp);
+			rsp += sizeof(std::uint64_t);
+			break;
+		case unwind_operation::type::allocate:
+			rsp += op.value;
+			break;
+		case unwind_operation::type::set_frame:
+			rsp = result.registers[op.reg] - op.value;
+			break;
+		case unwind_operation::type::restore_register:
+			result.registers[op.reg] = read_qword(frame_base + op.value);
+			break;
+		case unwind_operation::type::restore_xmm:
+			result.xmm[op.reg] = read_xmm(frame_base + op.value);
+			break;
+		case unwind_operation::type::push_machine_frame:
+			result.rip = read_qword(rsp + op.value);
+			rsp = read_qword(rsp + op.value + 3u * sizeof(std::uint64_t));
+			has_machine_frame = true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (!has_machine_frame)
+	{
+		result.rip = read_qword(rsp);
+		rsp += sizeof(std::uint64_t);
+	}
+
+	context = result;
+	return func;
+}
+
+stack_trace unwinder::walk(unwind_context context, const stack_walk_options& options)
+{
+	stack_trace trace;
+	auto& frames = trace.get_frames();
+	while (frames.size() < options.max_frames)
+	{
+		auto& frame = frames.emplace_back();
+		frame.rip = context.rip;
+		frame.rsp = context.get_rsp();
+		try
+		{
+			frame.function = unwind(context);
+		}
+		catch (const std::system_error& e)
+		{
+			trace.add_error(e.code(), frames.size() - 1u);
+			break;
+		}
+
+		if (!context.rip)
+			break;
+
+		if (context.get_rsp() <= frame.rsp)
+		{
+			trace.add_error(unwinder_errc::invalid_stack_pointer, frames.size() - 1u);
+			break;
+		}
+	}
+	return trace;
+}
+
+} //namespace pe_bliss::exceptions::x64
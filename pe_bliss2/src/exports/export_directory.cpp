@@ -18,6 +18,13 @@ template<typename ExportedAddressList>
 auto symbol_by_ordinal_impl(ExportedAddressList& addresses,
 	ordinal_type rva_ordinal) noexcept
 {
+	//Most directories list exports by consecutive ordinals
+	if (rva_ordinal < addresses.size()
+		&& addresses[rva_ordinal].get_rva_ordinal() == rva_ordinal)
+	{
+		return std::begin(addresses) + rva_ordinal;
+	}
+
 	return std::find_if(std::begin(addresses),
 		std::end(addresses), [rva_ordinal] (const auto& addr)
 		{
@@ -115,23 +122,28 @@ ordinal_type export_directory_base<ExportedAddressList>::get_first_free_ordinal(
 	if (exported_addresses_.empty())
 		return {};
 
-	std::vector<ordinal_type> occupied;
-	occupied.reserve(exported_addresses_.size());
+	std::vector<ordinal_type> ordinals;
+	ordinals.reserve(exported_addresses_.size());
 	for (const auto& addr : exported_addresses_)
-		occupied.emplace_back(addr.get_rva_ordinal());
-
-	std::sort(std::begin(occupied), std::end(occupied));
+		ordinals.push_back(addr.get_rva_ordinal());
+	std::sort(ordinals.begin(), ordinals.end());
 
+	//First gap in the sorted ordinal list
 	ordinal_type next = {};
-	for (ordinal_type ordinal : occupied)
+	for (auto ordinal : ordinals)
 	{
 		if (ordinal != next)
-			return next;
-		next = ordinal + 1;
+		{
+			if (ordinal > next)
+				break;
+			continue; //Duplicate ordinal
+		}
+
+		if (next == (std::numeric_limits<ordinal_type>::max)())
+			throw pe_error(utilities::generic_errc::integer_overflow);
+		++next;
 	}
-	if (occupied.back() == (std::numeric_limits<ordinal_type>::max)())
-		throw pe_error(utilities::generic_errc::integer_overflow);
-	return occupied.back() + 1;
+	return next;
 }
 
 template<typename ExportedAddressList>
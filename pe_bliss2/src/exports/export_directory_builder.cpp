@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <string_view>
 #include <utility>
@@ -36,143 +38,124 @@ void update_data_directory(image::image& instance,
 	}
 }
 
-template<typename ExportedNamePtr>
+template<typename ExportedName>
 struct symbol_ref
 {
-	explicit symbol_ref(ExportedNamePtr name) noexcept
-		: name(name)
-	{
-	}
+	std::string_view name;
+	ordinal_type rva_ordinal;
+	ExportedName* exported_name;
 
-	ExportedNamePtr name;
 	friend bool operator<(const symbol_ref& left, const symbol_ref& right) noexcept
 	{
-		return left.name->get_name()->value() < right.name->get_name()->value();
+		return left.name < right.name;
 	}
 };
 
 template<typename ExportList>
 auto sort_symbols(ExportList& export_list)
 {
-	std::vector<symbol_ref<
-		std::remove_reference_t<decltype(export_list.front().get_names().front())>*
-	>> symbol_names;
+	using exported_name_type = typename ExportList::value_type::name_list_type::value_type;
+	std::vector<symbol_ref<exported_name_type>> symbol_names;
+	std::size_t name_count = 0;
+	for (const auto& symbol : export_list)
+		name_count += symbol.get_names().size();
+	symbol_names.reserve(name_count);
+
 	for (auto& symbol : export_list)
 	{
 		for (auto& name : symbol.get_names())
 		{
 			if (name.get_name())
-				symbol_names.emplace_back(&name);
+			{
+				symbol_names.push_back({ name.get_name()->value(),
+					symbol.get_rva_ordinal(), &name });
+			}
 		}
 	}
 
-	std::sort(std::begin(symbol_names), std::end(symbol_names));
+	//Names are usually added in sorted order already
+	if (!std::is_sorted(symbol_names.cbegin(), symbol_names.cend()))
+		std::sort(symbol_names.begin(), symbol_names.end());
 	return symbol_names;
 }
 
 template<typename Directory>
-utilities::safe_uint<rva_type> build_new_functions_impl(buffers::output_buffer_interface& buf,
-	Directory& directory, utilities::safe_uint<rva_type> current_rva)
+std::size_t build_new_impl(buffers::output_buffer_interface& buf, Directory& directory,
+	const builder_options& options)
 {
-	auto& descriptor = directory.get_descriptor();
-	descriptor->address_of_functions = current_rva.value();
-
 	auto& export_list = directory.get_export_list();
-	if (export_list.empty())
-	{
-		descriptor->number_of_functions = 0u;
-		return current_rva;
-	}
+	static constexpr auto by_ordinal = [](const auto& l, const auto& r) {
+		return l.get_rva_ordinal() < r.get_rva_ordinal();
+	};
+	if (!std::is_sorted(export_list.cbegin(), export_list.cend(), by_ordinal))
+		std::sort(export_list.begin(), export_list.end(), by_ordinal);
 
-	descriptor->number_of_functions = static_cast<std::uint32_t>(export_list.back().get_rva_ordinal() + 1u);
-	current_rva += sizeof(rva_type) * descriptor->number_of_functions;
-	auto forwarded_name_rva = current_rva;
-	std::uint32_t prev_ordinal = 0;
+	auto symbol_names = sort_symbols(export_list);
+
+	//Layout: descriptor, library name, address table, forwarded names,
+	//name ordinal table, name table, names
+	auto& descriptor = directory.get_descriptor();
+	utilities::safe_uint current_rva(options.directory_rva);
+	current_rva += descriptor.packed_size;
+	descriptor->name = current_rva.value();
+	current_rva += directory.get_library_name().value().size() + 1u; //nullbyte
+
+	descriptor->address_of_functions = current_rva.value();
+	descriptor->number_of_functions = export_list.empty() ? 0u
+		: static_cast<std::uint32_t>(export_list.back().get_rva_ordinal() + 1u);
+	current_rva += static_cast<std::uint64_t>(sizeof(rva_type))
+		* descriptor->number_of_functions;
 	for (auto& symbol : export_list)
 	{
-		while (prev_ordinal < symbol.get_rva_ordinal())
-		{
-			packed_struct<rva_type>{}.serialize(buf, true);
-			++prev_ordinal;
-		}
-		prev_ordinal = symbol.get_rva_ordinal() + 1;
-
 		if (symbol.get_forwarded_name())
 		{
-			symbol.get_rva() = forwarded_name_rva.value();
-			forwarded_name_rva += 
-				symbol.get_forwarded_name()->value().size() + 1u; //nullbyte
+			symbol.get_rva() = current_rva.value();
+			current_rva += symbol.get_forwarded_name()->value().size() + 1u; //nullbyte
 		}
-		symbol.get_rva().serialize(buf, true);
 	}
 
-	for (const auto& symbol : export_list)
+	descriptor->number_of_names = static_cast<std::uint32_t>(symbol_names.size());
+	descriptor->address_of_name_ordinals = current_rva.value();
+	current_rva += static_cast<std::uint64_t>(sizeof(ordinal_type)) * symbol_names.size();
+	descriptor->address_of_names = current_rva.value();
+	current_rva += static_cast<std::uint64_t>(sizeof(rva_type)) * symbol_names.size();
+	for (auto& sym : symbol_names)
 	{
-		if (symbol.get_forwarded_name())
-			current_rva += symbol.get_forwarded_name()->serialize(buf, true);
+		sym.exported_name->get_name_rva() = current_rva.value();
+		sym.exported_name->get_name_ordinal() = sym.rva_ordinal;
+		current_rva += sym.name.size() + 1u; //nullbyte
 	}
 
-	return current_rva;
-}
+	std::vector<std::byte> data((current_rva - options.directory_rva).value());
+	auto* const begin = data.data();
+	auto* const end = begin + data.size();
+	auto* ptr = begin + descriptor.serialize(begin, data.size(), true);
+	ptr += directory.get_library_name().serialize(ptr, end - ptr, true);
 
-template<typename Directory>
-void build_new_names_impl(buffers::output_buffer_interface& buf,
-	Directory& directory, utilities::safe_uint<rva_type> current_rva)
-{
-	auto& descriptor = directory.get_descriptor();
-	descriptor->address_of_name_ordinals = current_rva.value();
-	if (directory.get_export_list().empty())
+	auto* address_table = ptr;
+	for (const auto& symbol : export_list)
 	{
-		descriptor->address_of_names = current_rva.value();
-		return;
+		symbol.get_rva().serialize(address_table + symbol.get_rva_ordinal() * sizeof(rva_type),
+			sizeof(rva_type), true);
 	}
+	ptr += static_cast<std::size_t>(descriptor->number_of_functions) * sizeof(rva_type);
 
-	auto symbol_names = sort_symbols(directory.get_export_list());
-
-	for (const auto& sym : symbol_names)
-		current_rva += sym.name->get_name_ordinal().serialize(buf, true);
-
-	descriptor->address_of_names = current_rva.value();
-
-	current_rva += sizeof(rva_type) * symbol_names.size();
-	auto name_rva = current_rva;
-	for (auto& sym : symbol_names)
+	for (const auto& symbol : export_list)
 	{
-		sym.name->get_name_rva() = name_rva.value();
-		sym.name->get_name_rva().serialize(buf, true);
-		name_rva += sym.name->get_name()->value().size() + 1u; // nullbyte
+		if (symbol.get_forwarded_name())
+			ptr += symbol.get_forwarded_name()->serialize(ptr, end - ptr, true);
 	}
 
 	for (const auto& sym : symbol_names)
-		sym.name->get_name()->serialize(buf, true);
-}
-
-template<typename Directory>
-std::size_t build_new_impl(buffers::output_buffer_interface& buf, Directory& directory,
-	const builder_options& options)
-{
-	auto& descriptor = directory.get_descriptor();
-	utilities::safe_uint current_rva(options.directory_rva);
-	current_rva += descriptor.packed_size;
-	descriptor->name = current_rva.value();
-
-	auto buf_start_pos = buf.wpos();
-	buf.advance_wpos(descriptor.packed_size);
-	current_rva += directory.get_library_name().serialize(buf, true);
-
-	auto& export_list = directory.get_export_list();
-	std::sort(export_list.begin(), export_list.end(), [](const auto& l, const auto& r)
-	{
-		return l.get_rva_ordinal() < r.get_rva_ordinal();
-	});
-
-	current_rva = build_new_functions_impl(buf, directory, current_rva);
-	build_new_names_impl(buf, directory, current_rva);
+		ptr += sym.exported_name->get_name_ordinal().serialize(ptr, end - ptr, true);
+	for (const auto& sym : symbol_names)
+		ptr += sym.exported_name->get_name_rva().serialize(ptr, end - ptr, true);
+	for (const auto& sym : symbol_names)
+		ptr += sym.exported_name->get_name()->serialize(ptr, end - ptr, true);
 
-	auto size = buf.wpos() - buf_start_pos;
-	buf.set_wpos(buf_start_pos);
-	descriptor.serialize(buf, true);
-	return size;
+	assert(ptr == end);
+	buf.write(data.size(), begin);
+	return data.size();
 }
 
 template<typename Directory>
@@ -5,9 +5,14 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
-#include <list>
+#include <span>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include "buffers/output_buffer_interface.h"
 #include "buffers/output_memory_ref_buffer.h"
@@ -26,63 +31,207 @@ namespace
 using namespace pe_bliss;
 using namespace pe_bliss::imports;
 
-struct thunk_count_names_size
+using safe_rva_type = utilities::safe_uint<rva_type>;
+
+template<detail::executable_pointer Va>
+struct import_layout
 {
-	std::uint32_t iat_thunk_count{};
-	std::uint32_t ilt_thunk_count{};
-	std::uint32_t names_size{};
+	using hint_name_type = imported_function_hint_and_name<Va>;
+
+	struct library_layout
+	{
+		rva_type name_rva{};
+		rva_type lookup_table_rva{};
+		rva_type address_table_rva{};
+		bool owns_lookup_table = false;
+	};
+
+	std::vector<library_layout> libraries;
+	//Hint/name RVAs of all imported symbols, in order of libraries and symbols
+	std::vector<rva_type> hint_name_rvas;
+	//Unique strings to write
+	std::vector<std::pair<rva_type, const packed_c_string*>> library_names;
+	std::vector<std::pair<rva_type, const hint_name_type*>> hint_names;
+	rva_type iat_rva{};
+	//Alignment padding between options.iat_rva and iat_rva
+	std::uint32_t iat_padding{};
+	std::uint32_t descriptors_size{};
+	std::uint32_t directory_size{};
+	std::uint32_t iat_size{};
 };
 
-template<template <typename, typename> typename ImportedLibrary,
+template<typename Symbol>
+void append_lookup_key(const Symbol& symbol, std::string& key)
+{
+	using va_type = typename Symbol::va_type;
+	const auto& info = symbol.get_import_info();
+	if (const auto* hint_name = std::get_if<typename Symbol::hint_name_type>(&info); hint_name)
+	{
+		auto hint = hint_name->get_hint().get();
+		key.push_back('h');
+		key.append(reinterpret_cast<const char*>(&hint), sizeof(hint));
+		key.append(hint_name->get_name().value());
+		key.push_back('\0');
+	}
+	else if (const auto* ordinal = std::get_if<typename Symbol::ordinal_type>(&info); ordinal)
+	{
+		auto thunk = ordinal->to_thunk();
+		key.push_back('o');
+		key.append(reinterpret_cast<const char*>(&thunk), sizeof(thunk));
+	}
+	else if (const auto* address = std::get_if<
+		typename Symbol::imported_function_address_type>(&info); address)
+	{
+		va_type thunk = address->get_imported_va() ? address->get_imported_va()->get() : 0u;
+		key.push_back('a');
+		key.append(reinterpret_cast<const char*>(&thunk), sizeof(thunk));
+	}
+}
+
+template<template <detail::executable_pointer, typename> typename ImportedLibrary,
 	detail::executable_pointer Va, typename Descriptor>
-thunk_count_names_size get_thunk_count_and_names_size(
-	const std::vector<ImportedLibrary<Va, Descriptor>>& libraries)
+import_layout<Va> get_layout(const std::vector<ImportedLibrary<Va, Descriptor>>& libraries,
+	const builder_options& options)
 {
-	utilities::safe_uint<std::uint32_t> iat_thunk_count;
-	utilities::safe_uint<std::uint32_t> ilt_thunk_count;
-	utilities::safe_uint<std::uint32_t> names_size;
+	static constexpr auto descriptor_size
+		= ImportedLibrary<Va, Descriptor>::descriptor_type::packed_size;
+
+	import_layout<Va> layout;
+	layout.libraries.resize(libraries.size());
+
+	safe_rva_type descriptors_size;
+	descriptors_size += static_cast<std::uint64_t>(descriptor_size)
+		* (libraries.size() + 1u); //Terminating descriptor
+	layout.descriptors_size = descriptors_size.value();
+
+	bool has_lookup_tables = std::any_of(libraries.cbegin(), libraries.cend(),
+		[] (const auto& library) { return library.has_lookup_table(); });
+	safe_rva_type thunk_rva = options.directory_rva;
+	thunk_rva += descriptors_size;
+	if (has_lookup_tables || !options.iat_rva)
+		thunk_rva.align_up(sizeof(Va));
+
+	//Lookup tables
+	std::unordered_map<std::string, rva_type> lookup_tables;
+	std::string lookup_key;
+	for (std::size_t i = 0; i != libraries.size(); ++i)
+	{
+		const auto& library = libraries[i];
+		auto& library_layout = layout.libraries[i];
+		if (!library.has_lookup_table())
+			continue;
+
+		if (options.share_lookup_tables)
+		{
+			lookup_key.clear();
+			bool can_share = true;
+			for (const auto& symbol : library.get_imports())
+			{
+				using symbol_type = std::remove_cvref_t<decltype(symbol)>;
+				if (!options.deduplicate_strings && std::holds_alternative<
+					typename symbol_type::hint_name_type>(symbol.get_import_info()))
+				{
+					can_share = false;
+					break;
+				}
+				append_lookup_key(symbol, lookup_key);
+			}
+
+			if (can_share)
+			{
+				auto [it, inserted] = lookup_tables.try_emplace(lookup_key, thunk_rva.value());
+				if (!inserted)
+				{
+					library_layout.lookup_table_rva = it->second;
+					continue;
+				}
+			}
+		}
+
+		library_layout.lookup_table_rva = thunk_rva.value();
+		library_layout.owns_lookup_table = true;
+		thunk_rva += (static_cast<std::uint64_t>(library.get_imports().size())
+			+ 1u) * sizeof(Va); //Terminator
+	}
+
+	//Address tables
+	safe_rva_type iat_rva = options.iat_rva ? *options.iat_rva : thunk_rva.value();
+	if (options.iat_rva)
+	{
+		iat_rva.align_up(sizeof(Va));
+		layout.iat_padding = iat_rva.value() - *options.iat_rva;
+	}
+	auto iat_start_rva = iat_rva;
+	for (std::size_t i = 0; i != libraries.size(); ++i)
+	{
+		const auto& library = libraries[i];
+		layout.libraries[i].address_table_rva = iat_rva.value();
+		iat_rva += (static_cast<std::uint64_t>(library.get_imports().size())
+			+ 1u) * sizeof(Va); //Terminator
+	}
+	layout.iat_rva = iat_start_rva.value();
+	layout.iat_size = (iat_rva - iat_start_rva).value();
+	if (!options.iat_rva)
+		thunk_rva = iat_rva;
+
+	//Library names
+	auto strings_rva = thunk_rva;
+	std::unordered_map<std::string_view, rva_type> library_names;
+	for (std::size_t i = 0; i != libraries.size(); ++i)
+	{
+		const auto& name = libraries[i].get_library_name();
+		if (options.deduplicate_strings)
+		{
+			auto [it, inserted] = library_names.try_emplace(name.value(), strings_rva.value());
+			if (!inserted)
+			{
+				layout.libraries[i].name_rva = it->second;
+				continue;
+			}
+		}
+
+		layout.libraries[i].name_rva = strings_rva.value();
+		layout.library_names.emplace_back(strings_rva.value(), &name);
+		strings_rva += name.value().size() + 1u; //nullbyte
+	}
+
+	//Hints and names
+	std::unordered_map<std::string, rva_type> hint_names;
+	std::string hint_name_key;
 	for (const auto& library : libraries)
 	{
 		for (const auto& symbol : library.get_imports())
 		{
 			const auto& info = symbol.get_import_info();
 			using symbol_type = std::remove_cvref_t<decltype(symbol)>;
-			if (const auto* ptr = std::get_if<typename symbol_type::hint_name_type>(&info))
+			const auto* hint_name = std::get_if<typename symbol_type::hint_name_type>(&info);
+			if (!hint_name)
 			{
-				names_size += std::remove_pointer_t<std::remove_cvref_t<decltype(ptr)>>
-					::hint_type::packed_size;
-				names_size += ptr->get_name().value().size() + 1; //nullbyte
+				layout.hint_name_rvas.emplace_back();
+				continue;
 			}
-		}
 
-		utilities::safe_uint<std::uint32_t> library_iat_thunk_count;
-		utilities::safe_uint<std::uint32_t> library_ilt_thunk_count;
-		library_iat_thunk_count += library.get_imports().size();
-
-		if (library.has_lookup_table())
-			library_ilt_thunk_count += library_iat_thunk_count + 1u; //Terminator
-		else
-			library_iat_thunk_count += 1u; //Terminator
+			if (options.deduplicate_strings)
+			{
+				hint_name_key.clear();
+				append_lookup_key(symbol, hint_name_key);
+				auto [it, inserted] = hint_names.try_emplace(hint_name_key, strings_rva.value());
+				if (!inserted)
+				{
+					layout.hint_name_rvas.emplace_back(it->second);
+					continue;
+				}
+			}
 
-		iat_thunk_count += library_iat_thunk_count;
-		ilt_thunk_count += library_ilt_thunk_count;
+			layout.hint_name_rvas.emplace_back(strings_rva.value());
+			layout.hint_names.emplace_back(strings_rva.value(), hint_name);
+			strings_rva += import_layout<Va>::hint_name_type::hint_type::packed_size;
+			strings_rva += hint_name->get_name().value().size() + 1u; //nullbyte
+		}
 	}
 
-	return {
-		.iat_thunk_count = iat_thunk_count.value(),
-		.ilt_thunk_count = ilt_thunk_count.value(),
-		.names_size = names_size.value()
-	};
-}
-
-template<typename Va>
-std::uint32_t get_aligned_thunk_offset(std::uint32_t base, std::uint32_t offset)
-{
-	utilities::safe_uint<std::uint32_t> thunk_rva(base);
-	thunk_rva += offset;
-	auto aligned_thunk_rva = thunk_rva;
-	aligned_thunk_rva.align_up(sizeof(Va));
-	return aligned_thunk_rva.value() - thunk_rva.value();
+	layout.directory_size = (strings_rva - options.directory_rva).value();
+	return layout;
 }
 
 template<template <detail::executable_pointer, typename> typename ImportedLibrary,
@@ -90,33 +239,11 @@ template<template <detail::executable_pointer, typename> typename ImportedLibrar
 built_size get_lib_built_size_impl(const std::vector<ImportedLibrary<Va, Descriptor>>& libraries,
 	const builder_options& options)
 {
-	static constexpr auto descriptor_size
-		= ImportedLibrary<Va, Descriptor>::descriptor_type::packed_size;
-	auto descriptors_size = static_cast<std::uint64_t>(descriptor_size)
-		* (libraries.size() + 1u); //Terminating descriptor
-
-	utilities::safe_uint<std::uint32_t> directory_size;
-	directory_size += descriptors_size;
-
-	auto size_info = get_thunk_count_and_names_size(libraries);
-	directory_size += size_info.names_size;
-	directory_size += static_cast<std::uint64_t>(size_info.ilt_thunk_count) * sizeof(Va);
-	if (!options.iat_rva) //No separate IAT
-		directory_size += static_cast<std::uint64_t>(size_info.iat_thunk_count) * sizeof(Va);
-	for (const auto& library : libraries)
-		directory_size += library.get_library_name().value().size() + 1u; //nullbyte
-	
-	if (!options.iat_rva || size_info.ilt_thunk_count)
-		directory_size += get_aligned_thunk_offset<Va>(options.directory_rva, descriptor_size);
-
-	auto iat_size = static_cast<std::uint32_t>(size_info.iat_thunk_count * sizeof(Va));
-	if (options.iat_rva)
-		iat_size += get_aligned_thunk_offset<Va>(*options.iat_rva, 0u);
-
+	auto layout = get_layout(libraries, options);
 	return built_size
 	{
-		.directory_size = directory_size.value(),
-		.iat_size = iat_size
+		.directory_size = layout.directory_size,
+		.iat_size = layout.iat_padding + layout.iat_size
 	};
 }
 
@@ -242,202 +369,135 @@ void build_in_place_impl(image::image& instance, const Directory& directory,
 	}, directory.get_list());
 }
 
-using safe_rva_type = utilities::safe_uint<rva_type>;
-
-template<template <detail::executable_pointer, typename> typename ImportedLibrary,
-	detail::executable_pointer Va, typename Descriptor>
-safe_rva_type build_library_names(buffers::output_buffer_interface& buf,
-	std::vector<ImportedLibrary<Va, Descriptor>>& libraries, safe_rva_type strings_rva)
+template<typename Symbol>
+typename Symbol::va_type get_lookup_thunk(const Symbol& symbol, rva_type hint_name_rva)
 {
-	for (auto& library : libraries)
-	{
-		library.get_descriptor()->name = strings_rva.value();
-		strings_rva += library.get_library_name().serialize(buf, true);
-	}
-
-	return strings_rva;
+	const auto& info = symbol.get_import_info();
+	if (std::holds_alternative<typename Symbol::hint_name_type>(info))
+		return hint_name_rva;
+	if (const auto* ordinal = std::get_if<typename Symbol::ordinal_type>(&info); ordinal)
+		return ordinal->to_thunk();
+
+	const auto& address = std::get<typename Symbol::imported_function_address_type>(info);
+	return address.get_imported_va() ? address.get_imported_va()->get() : 0u;
 }
 
-template<template <detail::executable_pointer, typename> typename ImportedLibrary,
-	detail::executable_pointer Va, typename Descriptor>
-safe_rva_type build_address_tables(buffers::output_buffer_interface& buf,
-	std::vector<ImportedLibrary<Va, Descriptor>>& libraries,
-	safe_rva_type strings_rva, safe_rva_type thunk_rva)
+template<typename Symbol>
+typename Symbol::va_type get_address_thunk(const Symbol& symbol, rva_type hint_name_rva,
+	bool is_bound_with_lookup)
 {
-	packed_struct<Va> thunk;
-	for (auto& library : libraries)
+	const auto& info = symbol.get_import_info();
+	if (is_bound_with_lookup)
 	{
-		bool has_lookup = library.has_lookup_table();
-		bool is_bound = library.is_bound();
-		library.get_descriptor()->address_table = thunk_rva.value();
-		if (!has_lookup)
-			library.get_descriptor()->lookup_table = 0u;
-		for (const auto& symbol : library.get_imports())
+		if (const auto* hint_name = std::get_if<typename Symbol::hint_name_type>(&info);
+			hint_name && hint_name->get_imported_va())
 		{
-			const auto& info = symbol.get_import_info();
-			using symbol_type = std::remove_cvref_t<decltype(symbol)>;
-			if (const auto* hint_name = std::get_if<typename symbol_type::hint_name_type>(&info); hint_name)
-			{
-				if (has_lookup && is_bound && hint_name->get_imported_va())
-				{
-					thunk = hint_name->get_imported_va()->get();
-				}
-				else
-				{
-					thunk = strings_rva.value();
-					strings_rva += sizeof(ordinal_type)
-						+ hint_name->get_name().value().size() + 1u; //nullbyte
-				}
-			}
-			else if (const auto* ordinal = std::get_if<typename symbol_type::ordinal_type>(&info); ordinal)
-			{
-				if (has_lookup && is_bound && ordinal->get_imported_va())
-					thunk = ordinal->get_imported_va()->get();
-				else
-					thunk = ordinal->to_thunk();
-			}
-			else if (const auto* imported_function_address = std::get_if<
-				typename symbol_type::imported_function_address_type>(&info); imported_function_address)
-			{
-				if (imported_function_address->get_imported_va())
-					thunk = imported_function_address->get_imported_va()->get();
-				else
-					thunk = 0u;
-			}
-
-			thunk_rva += thunk.serialize(buf, true);
+			return hint_name->get_imported_va()->get();
 		}
 
-		if (!has_lookup)
+		if (const auto* ordinal = std::get_if<typename Symbol::ordinal_type>(&info);
+			ordinal && ordinal->get_imported_va())
 		{
-			thunk = 0u;
-			thunk_rva += thunk.serialize(buf, true);
+			return ordinal->get_imported_va()->get();
 		}
 	}
 
-	return thunk_rva;
+	return get_lookup_thunk(symbol, hint_name_rva);
 }
 
-template<template <detail::executable_pointer, typename> typename ImportedLibrary,
+template<detail::executable_pointer Va>
+void write_thunk(std::span<std::byte> data, std::size_t offset, Va value)
+{
+	packed_struct<Va> thunk(value);
+	thunk.serialize(data.data() + offset, data.size() - offset, true);
+}
+
+template<template <detail::executable_pointer, typename Descriptor> typename ImportedLibrary,
 	detail::executable_pointer Va, typename Descriptor>
-safe_rva_type build_lookup_tables(buffers::output_buffer_interface& buf,
+build_result build_new_impl(buffers::output_buffer_interface& buf,
+	buffers::output_buffer_interface* iat_buf,
 	std::vector<ImportedLibrary<Va, Descriptor>>& libraries,
-	safe_rva_type strings_rva, safe_rva_type thunk_rva)
+	const builder_options& options)
 {
-	packed_struct<Va> thunk;
-	for (auto& library : libraries)
+	auto layout = get_layout(libraries, options);
+	const auto directory_rva = options.directory_rva;
+	const auto iat_start_rva = layout.iat_rva;
+
+	std::vector<std::byte> directory_data(layout.directory_size);
+	std::vector<std::byte> separate_iat_data(options.iat_rva
+		? layout.iat_padding + layout.iat_size : 0u);
+	std::span<std::byte> iat_data = options.iat_rva
+		? std::span<std::byte>(separate_iat_data).subspan(layout.iat_padding)
+		: std::span<std::byte>(directory_data).subspan(iat_start_rva - directory_rva);
+
+	auto hint_name_rva_it = layout.hint_name_rvas.cbegin();
+	std::size_t descriptor_offset = 0;
+	for (std::size_t i = 0; i != libraries.size(); ++i)
 	{
-		if (!library.has_lookup_table())
-			continue;
-		
-		library.get_descriptor()->lookup_table = thunk_rva.value();
+		auto& library = libraries[i];
+		const auto& library_layout = layout.libraries[i];
+		bool has_lookup = library.has_lookup_table();
+		bool is_bound_with_lookup = has_lookup && library.is_bound();
+
+		auto& descriptor = library.get_descriptor();
+		descriptor->name = library_layout.name_rva;
+		descriptor->address_table = library_layout.address_table_rva;
+		descriptor->lookup_table = library_layout.lookup_table_rva;
+
+		std::size_t lookup_offset = library_layout.lookup_table_rva - directory_rva;
+		std::size_t address_offset = library_layout.address_table_rva - iat_start_rva;
 		for (const auto& symbol : library.get_imports())
 		{
-			const auto& info = symbol.get_import_info();
-			using symbol_type = std::remove_cvref_t<decltype(symbol)>;
-			if (const auto* hint_name = std::get_if<typename symbol_type::hint_name_type>(&info); hint_name)
+			auto hint_name_rva = *hint_name_rva_it++;
+			if (library_layout.owns_lookup_table)
 			{
-				thunk = strings_rva.value();
-				strings_rva += sizeof(ordinal_type)
-					+ hint_name->get_name().value().size() + 1u; //nullbyte
-			}
-			else if (const auto* ordinal = std::get_if<typename symbol_type::ordinal_type>(&info); ordinal)
-			{
-				thunk = ordinal->to_thunk();
-			}
-			else if (const auto* imported_function_address = std::get_if<
-				typename symbol_type::imported_function_address_type>(&info); imported_function_address)
-			{
-				if (imported_function_address->get_imported_va())
-					thunk = imported_function_address->get_imported_va()->get();
-				else
-					thunk = 0u;
+				write_thunk<Va>(directory_data, lookup_offset,
+					get_lookup_thunk(symbol, hint_name_rva));
+				lookup_offset += sizeof(Va);
 			}
 
-			thunk_rva += thunk.serialize(buf, true);
+			write_thunk<Va>(iat_data, address_offset,
+				get_address_thunk(symbol, hint_name_rva, is_bound_with_lookup));
+			address_offset += sizeof(Va);
 		}
 
-		thunk = 0u;
-		thunk_rva += thunk.serialize(buf, true);
+		//Terminating thunks are zero
+
+		descriptor_offset += descriptor.serialize(directory_data.data() + descriptor_offset,
+			directory_data.size() - descriptor_offset, true);
 	}
 
-	return thunk_rva;
-}
+	//Terminating descriptor is zero
 
-template<template <detail::executable_pointer, typename> typename ImportedLibrary,
-	detail::executable_pointer Va, typename Descriptor>
-void build_hints_with_names(buffers::output_buffer_interface& buf,
-	const std::vector<ImportedLibrary<Va, Descriptor>>& libraries, safe_rva_type strings_rva)
-{
-	for (auto& library : libraries)
+	for (const auto& [rva, name] : layout.library_names)
 	{
-		for (auto& symbol : library.get_imports())
-		{
-			const auto& info = symbol.get_import_info();
-			using symbol_type = std::remove_cvref_t<decltype(symbol)>;
-			if (const auto* ptr = std::get_if<typename symbol_type::hint_name_type>(&info))
-			{
-				strings_rva += ptr->get_hint().serialize(buf, true);
-				strings_rva += ptr->get_name().serialize(buf, true);
-			}
-		}
+		std::size_t offset = rva - directory_rva;
+		name->serialize(directory_data.data() + offset,
+			directory_data.size() - offset, true);
 	}
-}
 
-template<template <detail::executable_pointer, typename Descriptor> typename ImportedLibrary,
-	detail::executable_pointer Va, typename Descriptor>
-build_result build_new_impl(buffers::output_buffer_interface& buf,
-	buffers::output_buffer_interface* iat_buf,
-	std::vector<ImportedLibrary<Va, Descriptor>>& libraries,
-	const builder_options& options)
-{
-	build_result result{};
-	utilities::safe_uint<std::size_t> base_wpos = buf.wpos();
-	auto size_info = get_thunk_count_and_names_size(libraries);
-
-	auto descriptor_rva = options.directory_rva;
-	safe_rva_type thunk_rva = descriptor_rva;
-	thunk_rva += (libraries.size() + 1u)
-		* ImportedLibrary<Va, Descriptor>::descriptor_type::packed_size;
-
-	bool has_thunks_together_with_descriptors = size_info.ilt_thunk_count || !options.iat_rva;
-	if (has_thunks_together_with_descriptors)
-		thunk_rva.align_up(sizeof(Va));
-
-	auto strings_rva = thunk_rva + size_info.ilt_thunk_count * sizeof(Va);
-	if (!options.iat_rva)
-		strings_rva += size_info.iat_thunk_count * sizeof(Va);
-
-	buf.set_wpos((base_wpos + strings_rva - descriptor_rva).value());
-	strings_rva = build_library_names(buf, libraries, strings_rva);
-
-	if (has_thunks_together_with_descriptors)
+	for (const auto& [rva, hint_name] : layout.hint_names)
 	{
-		buf.set_wpos((base_wpos + thunk_rva - descriptor_rva).value());
-		thunk_rva = build_lookup_tables(buf, libraries, strings_rva, thunk_rva);
+		std::size_t offset = rva - directory_rva;
+		offset += hint_name->get_hint().serialize(directory_data.data() + offset,
+			directory_data.size() - offset, true);
+		hint_name->get_name().serialize(directory_data.data() + offset,
+			directory_data.size() - offset, true);
 	}
 
+	buf.write(directory_data.size(), directory_data.data());
 	if (options.iat_rva)
-		thunk_rva = *options.iat_rva;
-	auto prev_thunk_rva = thunk_rva.value();
-	thunk_rva = build_address_tables(iat_buf ? *iat_buf : buf, libraries, strings_rva, thunk_rva);
-	result.iat_rva = thunk_rva.value();
-	result.iat_size = thunk_rva.value() - prev_thunk_rva;
-
-	buf.set_wpos((base_wpos + strings_rva - descriptor_rva).value());
-	build_hints_with_names(buf, libraries, strings_rva);
-
-	result.full_size = static_cast<std::uint32_t>(buf.wpos() - base_wpos.value());
-	buf.set_wpos(base_wpos.value());
-	for (auto& library : libraries)
-		library.get_descriptor().serialize(buf, true);
-
-	//Terminator
-	packed_struct<detail::imports::image_import_descriptor>{}.serialize(buf, true);
-	result.descriptors_size = static_cast<std::uint32_t>((libraries.size() + 1u)
-		* ImportedLibrary<Va, Descriptor>::descriptor_type::packed_size);
+	{
+		auto& target_iat_buf = iat_buf ? *iat_buf : buf;
+		target_iat_buf.write(separate_iat_data.size(), separate_iat_data.data());
+	}
 
-	return result;
+	return {
+		.full_size = layout.directory_size,
+		.iat_rva = iat_start_rva,
+		.iat_size = layout.iat_size,
+		.descriptors_size = layout.descriptors_size
+	};
 }
 
 template<typename Directory>
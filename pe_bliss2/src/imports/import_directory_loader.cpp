@@ -1,19 +1,26 @@
 #include "pe_bliss2/imports/import_directory_loader.h"
 
+#include <cstddef>
+#include <cstring>
 #include <limits>
+#include <string_view>
 #include <system_error>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "buffers/input_buffer_interface.h"
+#include "buffers/input_buffer_stateful_wrapper.h"
 #include "pe_bliss2/delay_import/delay_import_directory_loader.h"
 #include "pe_bliss2/detail/concepts.h"
 #include "pe_bliss2/image/image.h"
-#include "pe_bliss2/image/string_from_va.h"
-#include "pe_bliss2/image/struct_from_va.h"
+#include "pe_bliss2/image/section_data_from_va.h"
+#include "pe_bliss2/packed_struct.h"
 #include "pe_bliss2/pe_error.h"
 #include "pe_bliss2/pe_types.h"
 #include "utilities/safe_uint.h"
+#include "utilities/string.h"
 
 namespace
 {
@@ -56,6 +63,12 @@ struct import_directory_loader_error_category : std::error_category
 			return "Empty import name";
 		case address_and_unload_table_thunks_differ:
 			return "Delayload import address and unload table thunks differ";
+		case too_many_libraries:
+			return "Too many imported libraries";
+		case too_many_imports:
+			return "Too many imports for a single library";
+		case too_many_total_imports:
+			return "Too many imports in directory";
 		default:
 			return {};
 		}
@@ -67,8 +80,123 @@ const import_directory_loader_error_category import_directory_loader_error_categ
 using namespace pe_bliss;
 using namespace pe_bliss::imports;
 
+//Keeps the section data tail starting from the last requested RVA,
+//so that consecutive reads from the same section (thunk tables,
+//descriptors, hint/name entries) do not repeat the section search
+//and the buffer slicing.
+class section_view
+{
+public:
+	section_view(const image::image& instance, const loader_options& options) noexcept
+		: instance_(instance)
+		, include_headers_(options.include_headers)
+		, allow_virtual_data_(options.allow_virtual_data)
+	{
+	}
+
+	template<typename T>
+	void read(rva_type rva, packed_struct<T>& value)
+	{
+		buffers::input_buffer_stateful_wrapper_ref wrapper(
+			get(rva, packed_struct<T>::packed_size));
+		wrapper.set_rpos(rva - start_rva_);
+		value.deserialize(wrapper, allow_virtual_data_);
+	}
+
+	template<typename String>
+	void read_string(rva_type rva, String& value)
+	{
+		buffers::input_buffer_stateful_wrapper_ref wrapper(get(rva, 1u));
+		wrapper.set_rpos(rva - start_rva_);
+		value.deserialize(wrapper, allow_virtual_data_);
+	}
+
+	//Returns the number of non-zero Va thunks starting from rva, up to max_count,
+	//or zero if the data is not contiguous in memory.
+	template<typename Va>
+	std::size_t count_thunks(rva_type rva, std::size_t max_count)
+	{
+		static constexpr std::size_t block_size = 16u;
+
+		auto& buf = get(rva, sizeof(Va));
+		std::size_t pos = rva - start_rva_;
+		auto physical_size = buf.physical_size();
+		if (pos >= physical_size)
+			return 0u;
+
+		auto count = (std::min)((physical_size - pos) / sizeof(Va), max_count);
+		const auto* data = buf.get_raw_data(pos, count * sizeof(Va));
+		if (!data)
+			return 0u;
+
+		std::size_t i = 0;
+		//Branch-free inner loop, which can be vectorized
+		for (; i + block_size <= count; i += block_size)
+		{
+			bool has_zero = false;
+			for (std::size_t j = 0; j != block_size; ++j)
+			{
+				Va thunk;
+				std::memcpy(&thunk, data + (i + j) * sizeof(Va), sizeof(Va));
+				has_zero |= !thunk;
+			}
+
+			if (has_zero)
+				break;
+		}
+
+		for (; i != count; ++i)
+		{
+			Va thunk;
+			std::memcpy(&thunk, data + i * sizeof(Va), sizeof(Va));
+			if (!thunk)
+				break;
+		}
+
+		return i;
+	}
+
+private:
+	buffers::input_buffer_interface& get(rva_type rva, std::size_t size)
+	{
+		if (!buffer_ || rva < start_rva_ || rva - start_rva_ > buffer_->size()
+			|| buffer_->size() - (rva - start_rva_) < size)
+		{
+			buffer_ = image::section_data_from_rva(instance_, rva,
+				include_headers_, allow_virtual_data_);
+			start_rva_ = rva;
+		}
+		return *buffer_;
+	}
+
+private:
+	const image::image& instance_;
+	bool include_headers_;
+	bool allow_virtual_data_;
+	rva_type start_rva_{};
+	buffers::input_buffer_ptr buffer_;
+};
+
+struct import_views
+{
+	import_views(const image::image& instance, const loader_options& options) noexcept
+		: descriptors(instance, options)
+		, names(instance, options)
+		, lookup_table(instance, options)
+		, address_table(instance, options)
+		, unload_table(instance, options)
+	{
+	}
+
+	section_view descriptors;
+	section_view names;
+	section_view lookup_table;
+	section_view address_table;
+	section_view unload_table;
+};
+
 template<typename ImportList, typename Directory>
-rva_type load_library(const image::image& instance, const loader_options& options,
+rva_type load_library(import_views& views,
 	rva_type current_descriptor_rva, ImportList& import_list, Directory& directory)
 {
 	auto& library = import_list.emplace_back();
@@ -76,8 +204,7 @@ rva_type load_library(const image::image& instance, const loader_options& option
 
 	try
 	{
-		struct_from_rva(instance, current_descriptor_rva, descriptor,
-			options.include_headers, options.allow_virtual_data);
+		views.descriptors.read(current_descriptor_rva, descriptor);
 	}
 	catch (const std::system_error&)
 	{
@@ -94,8 +221,7 @@ rva_type load_library(const image::image& instance, const loader_options& option
 
 	try
 	{
-		string_from_rva(instance, descriptor->name, library.get_library_name(),
-			options.include_headers, options.allow_virtual_data);
+		views.names.read_string(descriptor->name, library.get_library_name());
 
 		if (library.get_library_name().value().empty())
 			library.add_error(import_directory_loader_errc::empty_library_name);
@@ -148,7 +274,7 @@ void add_imported_va(const image::image& instance,
 }
 
 template<typename Va, typename Descriptor>
-bool load_import(const image::image& instance, const loader_options& options,
+bool load_import(const image::image& instance, import_views& views,
 	utilities::safe_uint<rva_type>& lookup_rva,
 	utilities::safe_uint<rva_type>& address_rva,
 	[[maybe_unused]] utilities::safe_uint<rva_type>& unload_rva,
@@ -160,22 +286,15 @@ bool load_import(const image::image& instance, const loader_options& options,
 	try
 	{
 		if (lookup_rva)
-		{
-			struct_from_rva(instance, lookup_rva.value(), new_import.get_lookup().emplace(),
-				options.include_headers, options.allow_virtual_data);
-		}
+			views.lookup_table.read(lookup_rva.value(), new_import.get_lookup().emplace());
 
 		if constexpr (imported_library_details<Va, Descriptor>::is_delayload)
 		{
 			if (unload_rva)
-			{
-				struct_from_rva(instance, unload_rva.value(), new_import.get_unload_entry().emplace(),
-					options.include_headers, options.allow_virtual_data);
-			}
+				views.unload_table.read(unload_rva.value(), new_import.get_unload_entry().emplace());
 		}
 
-		struct_from_rva(instance, address_rva.value(), new_import.get_address(),
-			options.include_headers, options.allow_virtual_data);
+		views.address_table.read(address_rva.value(), new_import.get_address());
 	}
 	catch (const std::system_error&)
 	{
@@ -249,8 +368,7 @@ bool load_import(const image::image& instance, const loader_options& options,
 
 	try
 	{
-		struct_from_rva(instance, hint_name_rva.value(),
-			info.get_hint(), options.include_headers, options.allow_virtual_data);
+		views.names.read(hint_name_rva.value(), info.get_hint());
 	}
 	catch (const std::system_error&)
 	{
@@ -261,8 +379,7 @@ bool load_import(const image::image& instance, const loader_options& options,
 	try
 	{
 		hint_name_rva += imported_function_hint_and_name<Va>::hint_type::packed_size;
-		string_from_rva(instance, hint_name_rva.value(),
-			info.get_name(), options.include_headers, options.allow_virtual_data);
+		views.names.read_string(hint_name_rva.value(), info.get_name());
 		if (info.get_name().value().empty())
 			new_import.add_error(import_directory_loader_errc::empty_import_name);
 	}
@@ -274,59 +391,112 @@ bool load_import(const image::image& instance, const loader_options& options,
 	return true;
 }
 
+//Returns false if the directory loading should be stopped
 template<typename Va, typename Directory, typename Descriptor>
-void load_impl(const image::image& instance, const loader_options& options,
-	rva_type current_descriptor_rva,
-	std::vector<imported_library_details<Va, Descriptor>>& import_list,
-	Directory& directory)
+bool load_library_imports(const image::image& instance, const loader_options& options,
+	import_views& views, imported_library_details<Va, Descriptor>& library,
+	std::uint32_t& max_total_imports, Directory& directory)
 {
-	while ((current_descriptor_rva = load_library(
-		instance, options, current_descriptor_rva, import_list, directory)) != 0u)
+	auto& descriptor = library.get_descriptor();
+	utilities::safe_uint current_lookup_rva = descriptor->lookup_table;
+	utilities::safe_uint current_address_rva = descriptor->address_table;
+	utilities::safe_uint<rva_type> current_unload_rva;
+	if constexpr (imported_library_details<Va, Descriptor>::is_delayload)
+		current_unload_rva = descriptor->unload_information_table_rva;
+
+	if (!current_lookup_rva && !current_address_rva)
 	{
-		auto& library = import_list.back();
-		auto& descriptor = library.get_descriptor();
-		utilities::safe_uint current_lookup_rva = descriptor->lookup_table;
-		utilities::safe_uint current_address_rva = descriptor->address_table;
-		utilities::safe_uint<rva_type> current_unload_rva;
-		if constexpr (imported_library_details<Va, Descriptor>::is_delayload)
-			current_unload_rva = descriptor->unload_information_table_rva;
+		library.add_error(import_directory_loader_errc::zero_iat_and_ilt);
+		return true;
+	}
+
+	if (!current_address_rva)
+	{
+		library.add_error(import_directory_loader_errc::zero_iat);
+		return true;
+	}
 
-		if (!current_lookup_rva && !current_address_rva)
+	try
+	{
+		auto thunk_count = current_lookup_rva
+			? views.lookup_table.count_thunks<Va>(current_lookup_rva.value(),
+				options.max_imports_per_library)
+			: views.address_table.count_thunks<Va>(current_address_rva.value(),
+				options.max_imports_per_library);
+		if (thunk_count)
+			library.get_imports().reserve(thunk_count + 1u);
+	}
+	catch (const std::system_error&)
+	{
+		//Reported when loading the imports
+	}
+
+	while (load_import(instance, views,
+		current_lookup_rva, current_address_rva, current_unload_rva, library))
+	{
+		if (library.get_imports().size() > options.max_imports_per_library)
 		{
-			library.add_error(import_directory_loader_errc::zero_iat_and_ilt);
-			continue;
+			library.get_imports().pop_back();
+			library.add_error(import_directory_loader_errc::too_many_imports);
+			break;
 		}
 
-		if (!current_address_rva)
+		if (!max_total_imports)
 		{
-			library.add_error(import_directory_loader_errc::zero_iat);
-			continue;
+			library.get_imports().pop_back();
+			directory.add_error(import_directory_loader_errc::too_many_total_imports);
+			return false;
 		}
+		--max_total_imports;
 
-		while (load_import(instance, options,
-			current_lookup_rva, current_address_rva, current_unload_rva, library))
+		try
 		{
-			try
-			{
-				if (current_lookup_rva)
-					current_lookup_rva += sizeof(Va);
-				if (current_unload_rva)
-					current_unload_rva += sizeof(Va);
+			if (current_lookup_rva)
+				current_lookup_rva += sizeof(Va);
+			if (current_unload_rva)
+				current_unload_rva += sizeof(Va);
 
-				current_address_rva += sizeof(Va);
-			}
-			catch (const std::system_error&)
-			{
-				library.add_error(import_directory_loader_errc::invalid_imported_library_iat_ilt);
-				return;
-			}
+			current_address_rva += sizeof(Va);
+		}
+		catch (const std::system_error&)
+		{
+			library.add_error(import_directory_loader_errc::invalid_imported_library_iat_ilt);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<typename Va, typename Directory, typename Descriptor>
+void load_impl(const image::image& instance, const loader_options& options,
+	rva_type current_descriptor_rva,
+	std::vector<imported_library_details<Va, Descriptor>>& import_list,
+	Directory& directory, bool load_imports)
+{
+	import_views views(instance, options);
+	auto max_total_imports = options.max_total_imports;
+	while ((current_descriptor_rva = load_library(
+		views, current_descriptor_rva, import_list, directory)) != 0u)
+	{
+		if (import_list.size() > options.max_libraries)
+		{
+			import_list.pop_back();
+			directory.add_error(import_directory_loader_errc::too_many_libraries);
+			return;
+		}
+
+		if (load_imports && !load_library_imports(instance, options, views,
+			import_list.back(), max_total_imports, directory))
+		{
+			return;
 		}
 	}
 }
 
 template<typename Directory>
 std::optional<Directory> load_generic(const image::image& instance,
-	const loader_options& options)
+	const loader_options& options, bool load_imports)
 {
 	std::optional<Directory> result;
 	if (!instance.get_data_directories().has_directory(options.target_directory))
@@ -344,19 +514,30 @@ std::optional<Directory> load_generic(const image::image& instance,
 		load_impl(instance, options, imports_rva,
 			directory.get_list().template emplace<
 				std::vector<typename Directory::imported_library64_type>>(),
-			directory);
+			directory, load_imports);
 	}
 	else
 	{
 		load_impl(instance, options, imports_rva,
 			directory.get_list().template emplace<
 				std::vector<typename Directory::imported_library32_type>>(),
-			directory);
+			directory, load_imports);
 	}
 
 	return result;
 }
 
+template<typename Directory>
+std::optional<lazy_import_directory_base<Directory>> load_lazy_generic(
+	const image::image& instance, const loader_options& options)
+{
+	std::optional<lazy_import_directory_base<Directory>> result;
+	auto directory = load_generic<Directory>(instance, options, false);
+	if (directory)
+		result.emplace(instance, options, std::move(*directory));
+	return result;
+}
+
 } //namespace
 
 namespace pe_bliss::imports
@@ -370,7 +551,74 @@ std::error_code make_error_code(import_directory_loader_errc e) noexcept
 std::optional<import_directory_details> load(const image::image& instance,
 	const loader_options& options)
 {
-	return load_generic<import_directory_details>(instance, options);
+	return load_generic<import_directory_details>(instance, options, true);
+}
+
+template<typename Directory>
+lazy_import_directory_base<Directory>::lazy_import_directory_base(
+	const image::image& instance, const loader_options& options,
+	directory_type&& directory)
+	: instance_(instance)
+	, options_(options)
+	, directory_(std::move(directory))
+	, remaining_imports_(options.max_total_imports)
+{
+	resolved_.resize(get_library_count());
+}
+
+template<typename Directory>
+std::size_t lazy_import_directory_base<Directory>::get_library_count() const noexcept
+{
+	return std::visit([] (const auto& list) { return list.size(); },
+		directory_.get_list());
+}
+
+template<typename Directory>
+std::optional<std::size_t> lazy_import_directory_base<Directory>::find_library(
+	std::string_view name) const noexcept
+{
+	return std::visit([name] (const auto& list) -> std::optional<std::size_t> {
+		for (std::size_t i = 0; i != list.size(); ++i)
+		{
+			if (utilities::iequal(list[i].get_library_name().value(), name))
+				return i;
+		}
+		return {};
+	}, directory_.get_list());
+}
+
+template<typename Directory>
+const typename lazy_import_directory_base<Directory>::directory_type&
+	lazy_import_directory_base<Directory>::resolve(std::size_t index)
+{
+	if (resolved_.at(index) || stopped_)
+		return directory_;
+
+	resolved_[index] = true;
+	import_views views(instance_, options_);
+	std::visit([this, index, &views] (auto& list) {
+		stopped_ = !load_library_imports(instance_, options_, views,
+			list[index], remaining_imports_, directory_);
+	}, directory_.get_list());
+	return directory_;
+}
+
+template<typename Directory>
+const typename lazy_import_directory_base<Directory>::directory_type&
+	lazy_import_directory_base<Directory>::resolve_all()
+{
+	for (std::size_t i = 0, count = get_library_count(); i != count; ++i)
+		resolve(i);
+	return directory_;
+}
+
+template class lazy_import_directory_base<import_directory_details>;
+template class lazy_import_directory_base<delay_import::delay_import_directory_details>;
+
+std::optional<lazy_import_directory> load_lazy(const image::image& instance,
+	const loader_options& options)
+{
+	return load_lazy_generic<import_directory_details>(instance, options);
 }
 
 } //namespace pe_bliss::imports
@@ -381,7 +629,13 @@ namespace pe_bliss::delay_import
 std::optional<delay_import_directory_details> load(const image::image& instance,
 	const loader_options& options)
 {
-	return load_generic<delay_import_directory_details>(instance, options);
+	return load_generic<delay_import_directory_details>(instance, options, true);
+}
+
+std::optional<lazy_delay_import_directory> load_lazy(const image::image& instance,
+	const imports::loader_options& options)
+{
+	return load_lazy_generic<delay_import_directory_details>(instance, options);
 }
 
 } //namespace pe_bliss::delay_import
@@ -0,0 +1,263 @@
+#include "pe_bliss2/load_config/guard_table_view.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <variant>
+
+#include <boost/endian/conversion.hpp>
+
+#include "buffers/input_buffer_interface.h"
+#include "pe_bliss2/core/optional_header.h"
+#include "pe_bliss2/detail/endian_convert.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/image/section_data_from_va.h"
+#include "pe_bliss2/pe_error.h"
+#include "utilities/math.h"
+
+namespace
+{
+
+using namespace pe_bliss;
+using namespace pe_bliss::load_config;
+
+bool has_cf_guard(const image::image& instance) noexcept
+{
+	return static_cast<bool>(instance.get_optional_header().get_dll_characteristics()
+		& core::optional_header::dll_characteristics::guard_cf);
+}
+
+template<typename Directory, typename Va>
+std::optional<guard_table_view> read_table(const image::image& instance,
+	const loader_options& options, const Directory& directory,
+	std::uint64_t max_functions, Va table_va, Va function_count,
+	load_config_directory_loader_errc invalid_table_size_error,
+	load_config_directory_loader_errc invalid_function_count_error,
+	load_config_directory_loader_errc invalid_table_error,
+	load_config_directory_loader_errc unsorted_table_error)
+{
+	std::optional<guard_table_view> result;
+	if (!table_va)
+		return result;
+
+	const auto stride = directory.get_guard_cf_function_table_stride();
+	const auto entry_size = static_cast<std::uint64_t>(sizeof(rva_type) + stride);
+
+	bool invalid_function_count = false;
+	if (function_count > max_functions)
+	{
+		function_count = static_cast<Va>(max_functions);
+		invalid_function_count = true;
+	}
+
+	const auto table_size = static_cast<std::uint64_t>(function_count) * entry_size;
+	if ((function_count && table_size / function_count != entry_size)
+		|| table_size > (std::numeric_limits<std::uint32_t>::max)()
+		|| !utilities::math::is_sum_safe(table_va, static_cast<Va>(table_size)))
+	{
+		result.emplace().add_error(invalid_table_size_error);
+		return result;
+	}
+
+	try
+	{
+		auto data = image::section_data_from_va(instance, table_va,
+			static_cast<std::uint32_t>(table_size), options.include_headers,
+			options.allow_virtual_data);
+		std::vector<std::byte> raw(static_cast<std::size_t>(table_size));
+		data->read(0u, raw.size(), raw.data());
+		result.emplace(raw, stride, unsorted_table_error);
+	}
+	catch (const std::system_error&)
+	{
+		result.emplace().add_error(invalid_table_error);
+	}
+
+	if (invalid_function_count)
+		result->add_error(invalid_function_count_error);
+	return result;
+}
+
+template<typename Directory>
+guard_table_views load_views_impl(const image::image& instance,
+	const loader_options& options, const Directory& directory)
+{
+	guard_table_views result;
+	if (!has_cf_guard(instance)
+		|| !directory.is_version_at_least(version::cf_guard)
+		|| !(directory.get_guard_flags() & guard_flags::cf_instrumented))
+	{
+		return result;
+	}
+
+	const auto& descriptor = directory.get_descriptor();
+	if (options.load_cf_guard_function_table
+		&& (directory.get_guard_flags() & guard_flags::cf_function_table_present))
+	{
+		result.cf_function_table = read_table(instance, options, directory,
+			options.max_cf_function_table_functions,
+			descriptor->cf_guard.guard_cf_function_table,
+			descriptor->cf_guard.guard_cf_function_count,
+			load_config_directory_loader_errc::invalid_cf_guard_table_size,
+			load_config_directory_loader_errc::invalid_cf_guard_table_function_count,
+			load_config_directory_loader_errc::invalid_cf_function_table,
+			load_config_directory_loader_errc::unsorted_cf_guard_table);
+	}
+
+	if (!directory.is_version_at_least(version::cf_guard_ex))
+		return result;
+
+	if (options.load_cf_guard_longjump_table
+		&& (directory.get_guard_flags() & guard_flags::cf_longjump_table_present))
+	{
+		result.longjump_table = read_table(instance, options, directory,
+			options.max_guard_longjump_table_functions,
+			descriptor->cf_guard_ex.guard_long_jump_target_table,
+			descriptor->cf_guard_ex.guard_long_jump_target_count,
+			load_config_directory_loader_errc::invalid_guard_longjump_table_size,
+			load_config_directory_loader_errc::invalid_guard_longjump_table_function_count,
+			load_config_directory_loader_errc::invalid_cf_longjump_table,
+			load_config_directory_loader_errc::unsorted_guard_longjump_table);
+	}
+
+	if (options.load_cf_guard_export_suppression_table
+		&& (directory.get_guard_flags()
+			& guard_flags::cf_export_suppression_info_present))
+	{
+		result.export_suppression_table = read_table(instance, options, directory,
+			options.max_guard_export_suppression_table_functions,
+			descriptor->cf_guard_ex.guard_address_taken_iat_entry_table,
+			descriptor->cf_guard_ex.guard_address_taken_iat_entry_count,
+			load_config_directory_loader_errc::invalid_guard_export_suppression_table_size,
+			load_config_directory_loader_errc::invalid_guard_export_suppression_table_function_count,
+			load_config_directory_loader_errc::invalid_cf_export_suppression_table,
+			load_config_directory_loader_errc::unsorted_guard_export_suppression_table);
+	}
+
+	return result;
+}
+
+} //namespace
+
+namespace pe_bliss::load_config
+{
+
+guard_table_view::guard_table_view(std::span<const std::byte> data,
+	std::uint8_t stride, load_config_directory_loader_errc unsorted_table_error)
+	: stride_(stride)
+{
+	const auto entry_size = sizeof(rva_type) + stride;
+	if (data.size() % entry_size)
+		throw pe_error(load_config_directory_loader_errc::invalid_cf_guard_table_size);
+
+	const auto count = data.size() / entry_size;
+	rvas_.reserve(count);
+	if (stride)
+		flags_.reserve(count);
+
+	for (auto entry = data.data(), end = data.data() + data.size();
+		entry != end; entry += entry_size)
+	{
+		rva_type rva;
+		std::memcpy(&rva, entry, sizeof(rva));
+		detail::convert_endianness<boost::endian::order::little,
+			boost::endian::order::native>(rva);
+		rvas_.push_back(rva);
+		if (stride)
+			flags_.push_back(std::to_integer<std::uint8_t>(entry[sizeof(rva_type)]));
+	}
+
+	if (std::is_sorted(rvas_.begin(), rvas_.end()))
+		return;
+
+	add_error(unsorted_table_error);
+	if (!stride)
+	{
+		std::sort(rvas_.begin(), rvas_.end());
+		return;
+	}
+
+	std::vector<std::size_t> order(count);
+	std::iota(order.begin(), order.end(), std::size_t{});
+	std::stable_sort(order.begin(), order.end(),
+		[this](auto l, auto r) { return rvas_[l] < rvas_[r]; });
+
+	std::vector<rva_type> rvas;
+	std::vector<std::uint8_t> flags;
+	rvas.reserve(count);
+	flags.reserve(count);
+	for (auto position : order)
+	{
+		rvas.push_back(rvas_[position]);
+		flags.push_back(flags_[position]);
+	}
+	rvas_ = std::move(rvas);
+	flags_ = std::move(flags);
+}
+
+bool guard_table_view::contains(rva_type rva) const noexcept
+{
+	return std::binary_search(rvas_.begin(), rvas_.end(), rva);
+}
+
+std::optional<std::uint8_t> guard_table_view::find_flags(
+	rva_type rva) const noexcept
+{
+	auto it = std::lower_bound(rvas_.begin(), rvas_.end(), rva);
+	if (it == rvas_.end() || *it != rva)
+		return {};
+
+	if (flags_.empty())
+		return std::uint8_t{};
+	return flags_[static_cast<std::size_t>(it - rvas_.begin())];
+}
+
+bool guard_table_view::is_valid_call_target(rva_type rva) const noexcept
+{
+	const auto flags = find_flags(rva);
+	return flags && !(*flags & gfids_flags::fid_suppressed);
+}
+
+bool guard_table_view::is_export_suppressed(rva_type rva) const noexcept
+{
+	const auto flags = find_flags(rva);
+	return flags && (*flags & gfids_flags::export_suppressed);
+}
+
+guard_table_views load_guard_table_views(const image::image& instance,
+	const load_config_directory_details& directory,
+	const loader_options& options)
+{
+	return std::visit([&instance, &options] (const auto& value) {
+		return load_views_impl(instance, options, value);
+	}, directory.get_value());
+}
+
+std::optional<guard_table_views> load_guard_table_views(
+	const image::image& instance, const loader_options& options)
+{
+	std::optional<guard_table_views> result;
+	auto directory = load(instance, {
+		.include_headers = options.include_headers,
+		.allow_virtual_data = options.allow_virtual_data,
+		.load_lock_prefix_table = false,
+		.load_safeseh_handler_table = false,
+		.load_cf_guard_function_table = false,
+		.load_cf_guard_longjump_table = false,
+		.load_cf_guard_export_suppression_table = false,
+		.load_chpe_metadata = false,
+		.load_dynamic_relocation_table = false,
+		.load_enclave_config = false,
+		.load_volatile_metadata = false,
+		.load_ehcont_targets = false,
+		.load_xfg_type_based_hashes = false
+	});
+
+	if (directory)
+		result = load_guard_table_views(instance, *directory, options);
+	return result;
+}
+
+} //namespace pe_bliss::load_config
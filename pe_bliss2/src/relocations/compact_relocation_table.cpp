@@ -0,0 +1,30 @@
+#include "pe_bliss2/relocations/compact_relocation_table.h"
+
+#include <limits>
+
+#include "pe_bliss2/pe_error.h"
+#include "utilities/generic_error.h"
+
+namespace pe_bliss::relocations
+{
+
+void compact_relocation_table::reserve(std::size_t block_count,
+	std::size_t word_count)
+{
+	blocks_.reserve(block_count);
+	words_.reserve(word_count);
+}
+
+void compact_relocation_table::add_block(rva_type virtual_address,
+	std::span<const std::uint16_t> words)
+{
+	if (words_.size() + words.size() > (std::numeric_limits<std::uint32_t>::max)())
+		throw pe_error(utilities::generic_errc::integer_overflow);
+
+	blocks_.push_back({ virtual_address,
+		static_cast<std::uint32_t>(words_.size()),
+		static_cast<std::uint32_t>(words.size()) });
+	words_.insert(words_.end(), words.begin(), words.end());
+}
+
+} //namespace pe_bliss::relocations
@@ -0,0 +1,277 @@
+#include "pe_bliss2/relocations/image_diff.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string>
+#include <system_error>
+
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/pe_error.h"
+#include "pe_bliss2/relocations/compact_relocation_table.h"
+#include "pe_bliss2/section/section_data.h"
+#include "pe_bliss2/section/section_header.h"
+
+namespace
+{
+
+struct image_diff_error_category : std::error_category
+{
+	const char* name() const noexcept override
+	{
+		return "image_diff";
+	}
+
+	std::string message(int ev) const override
+	{
+		using enum pe_bliss::relocations::image_diff_errc;
+		switch (static_cast<pe_bliss::relocations::image_diff_errc>(ev))
+		{
+		case section_layout_mismatch:
+			return "Images have different section layouts";
+		default:
+			return {};
+		}
+	}
+};
+
+const image_diff_error_category image_diff_error_category_instance;
+
+using namespace pe_bliss;
+using namespace pe_bliss::relocations;
+
+constexpr std::size_t chunk_size = 64u;
+constexpr std::size_t page_size = 0x1000u;
+
+struct section_view
+{
+	rva_type rva{};
+	std::size_t size{};
+	std::span<const std::byte> a;
+	std::span<const std::byte> b;
+	std::vector<std::byte> a_copy;
+	std::vector<std::byte> b_copy;
+	//One bit per byte, set for bytes affected by relocations
+	std::vector<std::uint64_t> mask;
+};
+
+//Returns contiguous section data of exactly the requested size,
+//copying it only if it is not contiguous or is too short
+std::span<const std::byte> get_data(const section::section_data& data,
+	std::size_t size, std::vector<std::byte>& copy)
+{
+	const auto physical_size = data.physical_size();
+	if (physical_size >= size)
+	{
+		if (data.is_copied())
+			return { data.copied_data().data(), size };
+		if (const auto* ptr = data.data()->get_raw_data(0, size); ptr)
+			return { ptr, size };
+	}
+
+	copy.assign(size, std::byte{});
+	if (data.is_copied())
+	{
+		std::copy_n(data.copied_data().begin(),
+			(std::min)(size, physical_size), copy.begin());
+	}
+	else
+	{
+		(void)data.data()->read(0, (std::min)(size, physical_size), copy.data());
+	}
+	return copy;
+}
+
+std::vector<section_view> get_sections(const image::image& a, const image::image& b)
+{
+	const auto& headers_a = a.get_section_table().get_section_headers();
+	const auto& headers_b = b.get_section_table().get_section_headers();
+	const auto& data_a = a.get_section_data_list();
+	const auto& data_b = b.get_section_data_list();
+	if (headers_a.size() != headers_b.size()
+		|| data_a.size() != headers_a.size()
+		|| data_b.size() != headers_b.size())
+	{
+		throw pe_error(image_diff_errc::section_layout_mismatch);
+	}
+
+	std::vector<std::size_t> order(headers_a.size());
+	for (std::size_t i = 0; i != order.size(); ++i)
+	{
+		if (headers_a[i].get_rva() != headers_b[i].get_rva())
+			throw pe_error(image_diff_errc::section_layout_mismatch);
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&headers_a](auto l, auto r) {
+		return headers_a[l].get_rva() < headers_a[r].get_rva(); });
+
+	//Views are sorted by RVA
+	std::vector<section_view> result(order.size());
+	for (std::size_t index = 0; index != order.size(); ++index)
+	{
+		const auto i = order[index];
+		auto& view = result[index];
+		view.rva = headers_a[i].get_rva();
+		view.size = (std::max)(data_a[i].physical_size(), data_b[i].physical_size());
+		view.a = get_data(data_a[i], view.size, view.a_copy);
+		view.b = get_data(data_b[i], view.size, view.b_copy);
+		view.mask.resize((view.size + chunk_size - 1u) / chunk_size);
+	}
+
+	return result;
+}
+
+section_view* find_section(std::vector<section_view>& sections, rva_type rva) noexcept
+{
+	auto it = std::upper_bound(sections.begin(), sections.end(), rva,
+		[](rva_type value, const auto& section) { return value < section.rva; });
+	if (it == sections.begin())
+		return nullptr;
+
+	--it;
+	return rva - it->rva < it->size ? &*it : nullptr;
+}
+
+template<typename RelocsList>
+void build_masks(std::vector<section_view>& sections, const RelocsList& relocs,
+	core::file_header::machine_type machine)
+{
+	for (const auto& basereloc : relocs)
+	{
+		const auto page_rva = basereloc.get_virtual_address();
+		for (const auto& entry : basereloc.get_relocations())
+		{
+			const auto size = entry.get_affected_size_in_bytes(machine);
+			const std::uint64_t first = std::uint64_t{ page_rva } + entry.get_address();
+			for (std::uint64_t rva = first; rva != first + size; ++rva)
+			{
+				if (rva > (std::numeric_limits<rva_type>::max)())
+					break;
+
+				auto* section = find_section(sections, static_cast<rva_type>(rva));
+				if (!section)
+					continue;
+
+				const auto offset = static_cast<std::size_t>(rva - section->rva);
+				section->mask[offset / chunk_size] |= std::uint64_t{ 1u } << (offset % chunk_size);
+			}
+		}
+	}
+}
+
+class difference_collector
+{
+public:
+	difference_collector(image_difference_list& result,
+		const image_diff_options& options) noexcept
+		: result_(result)
+		, options_(options)
+	{
+	}
+
+	//Returns false when the difference limit has been reached
+	bool add(rva_type rva) noexcept
+	{
+		if (!result_.empty())
+		{
+			auto& last = result_.back();
+			if (std::uint64_t{ last.rva } + last.size == rva)
+			{
+				++last.size;
+				return true;
+			}
+		}
+
+		if (options_.max_differences && result_.size() == options_.max_differences)
+			return false;
+
+		result_.push_back({ rva, 1u });
+		return true;
+	}
+
+private:
+	image_difference_list& result_;
+	const image_diff_options& options_;
+};
+
+bool diff_section(const section_view& section, difference_collector& collector)
+{
+	const auto* a = section.a.data();
+	const auto* b = section.b.data();
+	for (std::size_t page = 0; page < section.size; page += page_size)
+	{
+		const auto page_end = (std::min)(page + page_size, section.size);
+		if (!std::memcmp(a + page, b + page, page_end - page))
+			continue;
+
+		for (std::size_t chunk = page; chunk < page_end; chunk += chunk_size)
+		{
+			const auto count = (std::min)(chunk_size, page_end - chunk);
+			if (!std::memcmp(a + chunk, b + chunk, count))
+				continue;
+
+			std::uint64_t differences = 0;
+			for (std::size_t i = 0; i != count; ++i)
+				differences |= std::uint64_t{ a[chunk + i] != b[chunk + i] } << i;
+
+			differences &= ~section.mask[chunk / chunk_size];
+			for (std::size_t i = 0; differences; ++i, differences >>= 1u)
+			{
+				if ((differences & 1u)
+					&& !collector.add(static_cast<rva_type>(section.rva + chunk + i)))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+template<typename RelocsList>
+image_difference_list diff_images_impl(const image::image& a, const image::image& b,
+	const RelocsList& relocs, const image_diff_options& options)
+{
+	auto sections = get_sections(a, b);
+	build_masks(sections, relocs, a.get_file_header().get_machine_type());
+
+	image_difference_list result;
+	difference_collector collector(result, options);
+	for (const auto& section : sections)
+	{
+		if (!diff_section(section, collector))
+			break;
+	}
+	return result;
+}
+
+} //namespace
+
+namespace pe_bliss::relocations
+{
+
+std::error_code make_error_code(image_diff_errc e) noexcept
+{
+	return { static_cast<int>(e), image_diff_error_category_instance };
+}
+
+image_difference_list diff_images(const image::image& a, const image::image& b,
+	const base_relocation_details_list& relocs, const image_diff_options& options)
+{
+	return diff_images_impl(a, b, relocs, options);
+}
+
+image_difference_list diff_images(const image::image& a, const image::image& b,
+	const base_relocation_list& relocs, const image_diff_options& options)
+{
+	return diff_images_impl(a, b, relocs, options);
+}
+
+image_difference_list diff_images(const image::image& a, const image::image& b,
+	const compact_relocation_table& relocs, const image_diff_options& options)
+{
+	return diff_images_impl(a, b, relocs, options);
+}
+
+} //namespace pe_bliss::relocations
@@ -1,15 +1,27 @@
 #include "pe_bliss2/relocations/image_rebase.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <exception>
+#include <span>
 #include <string>
 #include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include <boost/endian/conversion.hpp>
+
+#include "pe_bliss2/detail/endian_convert.h"
 #include "pe_bliss2/image/image.h"
+#include "pe_bliss2/image/section_data_from_va.h"
 #include "pe_bliss2/image/struct_from_va.h"
 #include "pe_bliss2/image/struct_to_va.h"
 #include "pe_bliss2/packed_struct.h"
 #include "pe_bliss2/pe_error.h"
+#include "pe_bliss2/relocations/compact_relocation_table.h"
 #include "utilities/math.h"
 
 namespace
@@ -42,6 +54,8 @@ const rebase_error_category rebase_error_category_instance;
 using namespace pe_bliss;
 using namespace pe_bliss::relocations;
 
+constexpr std::size_t page_size = 0x1000u;
+
 template<typename T, typename Reloc>
 void process_relocation(image::image& instance, rva_type rva,
 	std::uint64_t base_diff, const Reloc& entry, bool ignore_virtual_data)
@@ -65,6 +79,45 @@ void process_relocation(image::image& instance, rva_type rva,
 	struct_to_rva(instance, rva, value, true, !ignore_virtual_data);
 }
 
+template<typename Reloc>
+void process_relocation(image::image& instance, rva_type rva,
+	std::uint64_t base_diff, const Reloc& entry, bool ignore_virtual_data,
+	core::file_header::machine_type machine)
+{
+	switch (entry.get_affected_size_in_bytes(machine))
+	{
+		case sizeof(std::uint16_t):
+			process_relocation<std::uint16_t>(instance,
+				rva, base_diff, entry, ignore_virtual_data);
+			break;
+		case sizeof(std::uint32_t):
+			process_relocation<std::uint32_t>(instance,
+				rva, base_diff, entry, ignore_virtual_data);
+			break;
+		case sizeof(std::uint64_t):
+			process_relocation<std::uint64_t>(instance,
+				rva, base_diff, entry, ignore_virtual_data);
+			break;
+		default:
+			break;
+	}
+}
+
+template<typename RelocsList>
+void check_relocations_supported(const RelocsList& relocs,
+	core::file_header::machine_type machine)
+{
+	for (const auto& basereloc : relocs)
+	{
+		for (const auto& entry : basereloc.get_relocations())
+		{
+			// Make sure all relocation entries are supported
+			// before applying relocations
+			[[maybe_unused]] auto size = entry.get_affected_size_in_bytes(machine);
+		}
+	}
+}
+
 template<typename RelocsList>
 void rebase_impl(image::image& instance, const RelocsList& relocs,
 	const rebase_options& options)
@@ -75,39 +128,256 @@ void rebase_impl(image::image& instance, const RelocsList& relocs,
 		return;
 
 	auto machine = instance.get_file_header().get_machine_type();
+	check_relocations_supported(relocs, machine);
+
 	for (const auto& basereloc : relocs)
 	{
+		auto base_rva = basereloc.get_virtual_address();
 		for (const auto& entry : basereloc.get_relocations())
 		{
-			// Make sure all relocation entries are supported
-			// before applying relocations
-			[[maybe_unused]] auto size = entry.get_affected_size_in_bytes(machine);
+			process_relocation(instance, base_rva, base_diff, entry,
+				options.ignore_virtual_data, machine);
 		}
 	}
 
+	instance.get_optional_header().set_raw_image_base(options.new_base);
+}
+
+template<typename T>
+T load_little(const std::byte* ptr) noexcept
+{
+	T value;
+	std::memcpy(&value, ptr, sizeof(T));
+	detail::convert_endianness<boost::endian::order::little,
+		boost::endian::order::native>(value);
+	return value;
+}
+
+template<typename T>
+void store_little(std::byte* ptr, T value) noexcept
+{
+	detail::convert_endianness<boost::endian::order::native,
+		boost::endian::order::little>(value);
+	std::memcpy(ptr, &value, sizeof(T));
+}
+
+//Applies the run of consecutive HIGHLOW or DIR64 fixups, which fit
+//into the page data, without any per-entry dispatching
+template<typename T, typename Iterator>
+Iterator apply_run(std::span<std::byte> page, Iterator it, Iterator end,
+	relocation_type type, T base_diff) noexcept
+{
+	auto* data = page.data();
+	const auto size = page.size();
+	for (; it != end && (*it).get_type() == type; ++it)
+	{
+		std::size_t offset = (*it).get_address();
+		if (offset + sizeof(T) > size)
+			break;
+
+		store_little<T>(data + offset,
+			static_cast<T>(load_little<T>(data + offset) + base_diff));
+	}
+	return it;
+}
+
+template<typename Reloc>
+bool apply_fixup(std::span<std::byte> page, const Reloc& entry,
+	std::uint64_t base_diff, core::file_header::machine_type machine)
+{
+	std::size_t offset = entry.get_address();
+	auto size = entry.get_affected_size_in_bytes(machine);
+	if (offset + size > page.size())
+		return false;
+
+	auto* ptr = page.data() + offset;
+	switch (size)
+	{
+	case sizeof(std::uint16_t):
+		store_little(ptr, static_cast<std::uint16_t>(entry.apply_to(
+			load_little<std::uint16_t>(ptr), base_diff, machine)));
+		break;
+	case sizeof(std::uint32_t):
+		store_little(ptr, static_cast<std::uint32_t>(entry.apply_to(
+			load_little<std::uint32_t>(ptr), base_diff, machine)));
+		break;
+	case sizeof(std::uint64_t):
+		store_little(ptr, entry.apply_to(
+			load_little<std::uint64_t>(ptr), base_diff, machine));
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+std::span<std::byte> get_page_data(image::image& instance, rva_type page_rva)
+{
+	try
+	{
+		return image::section_data_from_rva(instance, page_rva, true);
+	}
+	catch (const std::system_error&)
+	{
+		//All fixups of the block will be deferred
+		return {};
+	}
+}
+
+template<typename Iterator>
+struct deferred_fixup
+{
+	rva_type page_rva;
+	Iterator entry;
+};
+
+template<typename Block, typename Iterator>
+void apply_block(std::span<std::byte> page, const Block& basereloc,
+	std::uint64_t base_diff, core::file_header::machine_type machine,
+	std::vector<deferred_fixup<Iterator>>& deferred)
+{
+	const auto& entries = basereloc.get_relocations();
+	auto it = entries.begin();
+	const auto end = entries.end();
+	while (it != end)
+	{
+		switch ((*it).get_type())
+		{
+		case relocation_type::absolute:
+			++it;
+			continue;
+
+		case relocation_type::highlow:
+			if (auto next = apply_run<std::uint32_t>(page, it, end,
+				relocation_type::highlow, static_cast<std::uint32_t>(base_diff));
+				next != it)
+			{
+				it = next;
+				continue;
+			}
+			break;
+
+		case relocation_type::dir64:
+			if (auto next = apply_run<std::uint64_t>(page, it, end,
+				relocation_type::dir64, base_diff); next != it)
+			{
+				it = next;
+				continue;
+			}
+			break;
+
+		default:
+			if (apply_fixup(page, *it, base_diff, machine))
+			{
+				++it;
+				continue;
+			}
+			break;
+		}
+
+		deferred.push_back({ basereloc.get_virtual_address(), it });
+		++it;
+	}
+}
+
+//Returns true if block pages do not overlap, i.e. block RVAs
+//are strictly increasing by at least the page size
+template<typename RelocsList>
+bool are_pages_disjoint(const RelocsList& relocs) noexcept
+{
+	for (std::size_t i = 1; i < relocs.size(); ++i)
+	{
+		const auto prev = relocs[i - 1u].get_virtual_address();
+		const auto next = relocs[i].get_virtual_address();
+		if (next < prev || next - prev < page_size)
+			return false;
+	}
+	return true;
+}
+
+template<typename RelocsList>
+void rebase_pages_impl(image::image& instance, const RelocsList& relocs,
+	const page_rebase_options& options)
+{
+	using block_type = typename RelocsList::value_type;
+	using iterator_type = decltype(std::declval<const block_type&>()
+		.get_relocations().begin());
+	using deferred_list_type = std::vector<deferred_fixup<iterator_type>>;
+
+	const auto base_diff = options.new_base
+		- instance.get_optional_header().get_raw_image_base();
+	if (!base_diff)
+		return;
+
+	auto machine = instance.get_file_header().get_machine_type();
+	check_relocations_supported(relocs, machine);
+
+	std::size_t thread_count = (std::max)(std::size_t{ 1u },
+		(std::min<std::size_t>)(options.thread_count, relocs.size()));
+	if (thread_count != 1u && !are_pages_disjoint(relocs))
+		thread_count = 1u;
+
+	//Section data is resolved (and copied) on the calling thread.
+	//When blocks are applied in parallel, every page is clipped to
+	//the page size, so that workers only access their own pages.
+	//Fixups, which cross the page end, are deferred.
+	std::vector<std::span<std::byte>> pages;
+	pages.reserve(relocs.size());
 	for (const auto& basereloc : relocs)
 	{
-		auto base_rva = basereloc.get_descriptor()->virtual_address;
-		for (const auto& entry : basereloc.get_relocations())
+		auto page = get_page_data(instance, basereloc.get_virtual_address());
+		if (thread_count != 1u && page.size() > page_size)
+			page = page.first(page_size);
+		pages.push_back(page);
+	}
+
+	std::vector<deferred_list_type> deferred(thread_count);
+	std::vector<std::exception_ptr> errors(thread_count);
+	auto apply_blocks = [&](std::size_t worker) {
+		try
 		{
-			switch (entry.get_affected_size_in_bytes(machine))
+			const auto first = relocs.size() * worker / thread_count;
+			const auto last = relocs.size() * (worker + 1u) / thread_count;
+			for (auto i = first; i != last; ++i)
 			{
-				case sizeof(std::uint16_t):
-					process_relocation<std::uint16_t>(instance,
-						base_rva, base_diff, entry, options.ignore_virtual_data);
-					break;
-				case sizeof(std::uint32_t):
-					process_relocation<std::uint32_t>(instance,
-						base_rva, base_diff, entry, options.ignore_virtual_data);
-					break;
-				case sizeof(std::uint64_t):
-					process_relocation<std::uint64_t>(instance,
-						base_rva, base_diff, entry, options.ignore_virtual_data);
-					break;
-				default:
-					break;
+				apply_block(pages[i], relocs[i], base_diff,
+					machine, deferred[worker]);
 			}
 		}
+		catch (...)
+		{
+			errors[worker] = std::current_exception();
+		}
+	};
+
+	if (thread_count == 1u)
+	{
+		apply_blocks(0u);
+	}
+	else
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(thread_count - 1u);
+		for (std::size_t worker = 1u; worker != thread_count; ++worker)
+			workers.emplace_back(apply_blocks, worker);
+		apply_blocks(0u);
+		for (auto& worker : workers)
+			worker.join();
+	}
+
+	for (const auto& error : errors)
+	{
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	for (const auto& list : deferred)
+	{
+		for (const auto& fixup : list)
+		{
+			process_relocation(instance, fixup.page_rva, base_diff,
+				*fixup.entry, options.ignore_virtual_data, machine);
+		}
 	}
 
 	instance.get_optional_header().set_raw_image_base(options.new_base);
@@ -135,4 +405,28 @@ void rebase(image::image& instance, const base_relocation_list& relocs,
 	rebase_impl(instance, relocs, options);
 }
 
+void rebase_pages(image::image& instance, const base_relocation_details_list& relocs,
+	const page_rebase_options& options)
+{
+	rebase_pages_impl(instance, relocs, options);
+}
+
+void rebase_pages(image::image& instance, const base_relocation_list& relocs,
+	const page_rebase_options& options)
+{
+	rebase_pages_impl(instance, relocs, options);
+}
+
+void rebase(image::image& instance, const compact_relocation_table& relocs,
+	const rebase_options& options)
+{
+	rebase_impl(instance, relocs, options);
+}
+
+void rebase_pages(image::image& instance, const compact_relocation_table& relocs,
+	const page_rebase_options& options)
+{
+	rebase_pages_impl(instance, relocs, options);
+}
+
 } //namespace pe_bliss::relocations
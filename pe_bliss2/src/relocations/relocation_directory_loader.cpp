@@ -1,12 +1,22 @@
 #include "pe_bliss2/relocations/relocation_directory_loader.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <system_error>
+#include <vector>
+
+#include <boost/endian/conversion.hpp>
+
+#include "buffers/input_buffer_stateful_wrapper.h"
 
 #include "pe_bliss2/core/data_directories.h"
+#include "pe_bliss2/detail/endian_convert.h"
 #include "pe_bliss2/detail/relocations/image_base_relocation.h"
 #include "pe_bliss2/image/image.h"
+#include "pe_bliss2/image/section_data_from_va.h"
 #include "pe_bliss2/image/struct_from_va.h"
+#include "pe_bliss2/packed_struct.h"
 #include "pe_bliss2/pe_error.h"
 #include "pe_bliss2/pe_types.h"
 #include "utilities/math.h"
@@ -131,6 +141,66 @@ bool load_elements(const image::image& instance, const loader_options& options,
 	return true;
 }
 
+bool load_words(const image::image& instance, const loader_options& options,
+	rva_type rva, std::uint32_t word_count, std::vector<std::uint16_t>& words)
+{
+	words.assign(word_count, 0u);
+	if (!word_count)
+		return true;
+
+	const auto size = word_count * static_cast<std::uint32_t>(sizeof(std::uint16_t));
+	try
+	{
+		auto buf = image::section_data_from_rva(instance, rva, size,
+			options.include_headers, options.allow_virtual_data);
+		buffers::input_buffer_stateful_wrapper_ref wrapper(*buf);
+		auto* data = reinterpret_cast<std::byte*>(words.data());
+		if (wrapper.read(size, data) != size && !options.allow_virtual_data)
+			return false;
+	}
+	catch (const std::system_error&)
+	{
+		return false;
+	}
+
+	for (auto& word : words)
+	{
+		detail::convert_endianness<boost::endian::order::little,
+			boost::endian::order::native>(word);
+	}
+	return true;
+}
+
+void check_words(std::span<const std::uint16_t> words,
+	core::file_header::machine_type machine, error_list& errors,
+	std::size_t block_index)
+{
+	for (auto it = words.begin(); it != words.end(); ++it)
+	{
+		compact_relocation_entry entry(*it);
+		try
+		{
+			//Check relocation type is supported
+			[[maybe_unused]] auto size = entry.get_affected_size_in_bytes(machine);
+		}
+		catch (const pe_error& e)
+		{
+			errors.add_error(e.code(), block_index);
+		}
+
+		if (entry.requires_parameter())
+		{
+			if (it + 1 == words.end())
+			{
+				errors.add_error(relocation_entry_errc::relocation_param_is_absent,
+					block_index);
+				break;
+			}
+			++it;
+		}
+	}
+}
+
 } //namespace
 
 namespace pe_bliss::relocations
@@ -209,4 +279,116 @@ std::optional<relocation_directory> load(const image::image& instance,
 	return result;
 }
 
+std::optional<compact_relocation_directory> load_compact(
+	const image::image& instance, const loader_options& options)
+{
+	std::optional<compact_relocation_directory> result;
+	if (!instance.get_data_directories().has_reloc())
+		return result;
+
+	const auto& reloc_dir_info = instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::basereloc);
+
+	auto& table = result.emplace().relocations;
+	auto& errors = result->errors;
+	auto machine = instance.get_file_header().get_machine_type();
+
+	safe_rva_type current_rva = reloc_dir_info->virtual_address;
+	auto last_rva = current_rva.value();
+	if (!utilities::math::add_if_safe(last_rva, reloc_dir_info->size))
+	{
+		errors.add_error(relocation_directory_loader_errc::invalid_directory_size);
+		return result;
+	}
+
+	//Every relocation entry takes at least 2 bytes
+	table.reserve(0u, reloc_dir_info->size / sizeof(std::uint16_t));
+
+	std::vector<std::uint16_t> words;
+	packed_struct<detail::relocations::image_base_relocation> descriptor;
+	while (current_rva < last_rva)
+	{
+		const auto block_index = table.size();
+		try
+		{
+			struct_from_rva(instance, current_rva.value(), descriptor,
+				options.include_headers, options.allow_virtual_data);
+		}
+		catch (const std::system_error&)
+		{
+			errors.add_error(relocation_directory_loader_errc::invalid_relocation_entry,
+				block_index);
+			return result;
+		}
+
+		auto aligned_rva = current_rva;
+		aligned_rva.align_up(sizeof(rva_type));
+		if (current_rva != aligned_rva)
+		{
+			errors.add_error(relocation_directory_loader_errc::unaligned_relocation_entry,
+				block_index);
+		}
+
+		current_rva += descriptor.packed_size;
+		if (descriptor->size_of_block < descriptor.packed_size)
+		{
+			table.add_block(descriptor->virtual_address, {});
+			errors.add_error(relocation_directory_loader_errc::invalid_relocation_block_size,
+				block_index);
+			continue;
+		}
+
+		auto entries_size = static_cast<std::uint32_t>(descriptor->size_of_block
+			- descriptor.packed_size);
+		if ((entries_size % 2))
+		{
+			current_rva += entries_size;
+			table.add_block(descriptor->virtual_address, {});
+			errors.add_error(relocation_directory_loader_errc::invalid_relocation_block_size,
+				block_index);
+			continue;
+		}
+
+		if (!utilities::math::is_sum_safe<rva_type>(current_rva.value(), entries_size)
+			|| current_rva + entries_size > last_rva)
+		{
+			//Keep the entries which fit into the directory, as load() does
+			const auto word_count = current_rva < last_rva
+				? static_cast<std::uint32_t>((last_rva - current_rva.value())
+					/ sizeof(std::uint16_t))
+				: 0u;
+			if (load_words(instance, options, current_rva.value(), word_count, words))
+			{
+				table.add_block(descriptor->virtual_address, words);
+				check_words(words, machine, errors, block_index);
+			}
+			else
+			{
+				table.add_block(descriptor->virtual_address, {});
+			}
+			errors.add_error(relocation_entry_errc::invalid_relocation_entry,
+				block_index);
+			return result;
+		}
+
+		if (!load_words(instance, options, current_rva.value(),
+			entries_size / 2u, words))
+		{
+			table.add_block(descriptor->virtual_address, {});
+			errors.add_error(relocation_entry_errc::invalid_relocation_entry,
+				block_index);
+			return result;
+		}
+
+		current_rva += entries_size;
+		table.add_block(descriptor->virtual_address, words);
+		check_words(words, machine, errors, block_index);
+	}
+
+	if (current_rva != last_rva)
+		errors.add_error(relocation_directory_loader_errc::invalid_directory_size);
+
+	return result;
+}
+
 } //namespace pe_bliss::relocations
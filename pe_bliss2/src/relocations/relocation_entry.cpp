@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <limits>
+#include <optional>
 #include <string>
 #include <system_error>
 
@@ -77,9 +78,23 @@ void relocation_entry::set_address(address_type address)
 std::uint64_t relocation_entry::apply_to(std::uint64_t value,
 	std::uint64_t image_base_difference,
 	core::file_header::machine_type machine) const
+{
+	return apply_relocation(get_type(), value, image_base_difference, machine,
+		param_ ? std::optional<std::uint16_t>(param_->get()) : std::nullopt);
+}
+
+std::uint8_t relocation_entry::get_affected_size_in_bytes(
+	core::file_header::machine_type machine) const
+{
+	return relocations::get_affected_size_in_bytes(get_type(), machine);
+}
+
+std::uint64_t apply_relocation(relocation_type type, std::uint64_t value,
+	std::uint64_t image_base_difference, core::file_header::machine_type machine,
+	std::optional<std::uint16_t> param)
 {
 	using enum relocation_type;
-	switch (get_type())
+	switch (type)
 	{
 	case absolute:
 		return value;
@@ -101,12 +116,12 @@ std::uint64_t relocation_entry::apply_to(std::uint64_t value,
 
 	case highadj:
 		{
-			if (!param_)
+			if (!param)
 				throw pe_error(relocation_entry_errc::relocation_param_is_absent);
 
 			assert(value <= (std::numeric_limits<std::uint16_t>::max)());
 			std::uint32_t result = static_cast<std::uint32_t>(value) << 16u;
-			result += param_->get();
+			result += *param;
 			result += static_cast<std::uint32_t>(image_base_difference);
 			result += 0x8000u;
 			return static_cast<std::uint16_t>(result >> 16u);
@@ -150,11 +165,11 @@ std::uint64_t relocation_entry::apply_to(std::uint64_t value,
 	throw pe_error(relocation_entry_errc::unsupported_relocation_type);
 }
 
-std::uint8_t relocation_entry::get_affected_size_in_bytes(
-	core::file_header::machine_type machine) const
+std::uint8_t get_affected_size_in_bytes(relocation_type type,
+	core::file_header::machine_type machine)
 {
 	using enum relocation_type;
-	switch (get_type())
+	switch (type)
 	{
 	case absolute:
 		return 0u;
@@ -0,0 +1,181 @@
+#include "pe_bliss2/relocations/relocation_fixup_builder.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include <boost/endian/conversion.hpp>
+
+#include "pe_bliss2/core/data_directories.h"
+#include "pe_bliss2/detail/endian_convert.h"
+#include "pe_bliss2/detail/relocations/image_base_relocation.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/image/section_data_from_va.h"
+#include "pe_bliss2/pe_error.h"
+#include "utilities/generic_error.h"
+#include "utilities/safe_uint.h"
+
+namespace
+{
+
+using namespace pe_bliss;
+using namespace pe_bliss::relocations;
+
+constexpr rva_type page_mask = 0xfffu;
+constexpr std::uint32_t descriptor_size
+	= sizeof(detail::relocations::image_base_relocation);
+constexpr std::uint32_t entry_size
+	= sizeof(detail::relocations::type_or_offset_entry);
+
+//Stable LSD radix sort by RVA, one byte per pass.
+//Passes, in which all keys have the same digit, are skipped.
+void radix_sort(std::vector<relocation_fixup>& fixups)
+{
+	if (std::is_sorted(fixups.begin(), fixups.end(),
+		[](const auto& l, const auto& r) { return l.rva < r.rva; }))
+	{
+		return;
+	}
+
+	std::vector<relocation_fixup> buffer(fixups.size());
+	for (std::uint32_t shift = 0; shift != sizeof(rva_type) * 8u; shift += 8u)
+	{
+		std::array<std::size_t, 256u> offsets{};
+		for (const auto& fixup : fixups)
+			++offsets[(fixup.rva >> shift) & 0xffu];
+
+		if (std::find(offsets.begin(), offsets.end(), fixups.size()) != offsets.end())
+			continue;
+
+		std::size_t offset = 0;
+		for (auto& count : offsets)
+			offset += std::exchange(count, offset);
+
+		for (const auto& fixup : fixups)
+			buffer[offsets[(fixup.rva >> shift) & 0xffu]++] = fixup;
+
+		fixups.swap(buffer);
+	}
+}
+
+template<typename T>
+std::byte* write_little(std::byte* ptr, T value) noexcept
+{
+	detail::convert_endianness<boost::endian::order::native,
+		boost::endian::order::little>(value);
+	std::memcpy(ptr, &value, sizeof(T));
+	return ptr + sizeof(T);
+}
+
+} //namespace
+
+namespace pe_bliss::relocations
+{
+
+relocation_fixup_builder::relocation_fixup_builder(
+	std::span<const relocation_fixup> fixups,
+	const builder_options& options)
+	: options_(options)
+	, fixups_(fixups.begin(), fixups.end())
+{
+	layout();
+}
+
+relocation_fixup_builder::relocation_fixup_builder(
+	std::vector<relocation_fixup>&& fixups,
+	const builder_options& options)
+	: options_(options)
+	, fixups_(std::move(fixups))
+{
+	layout();
+}
+
+void relocation_fixup_builder::layout()
+{
+	radix_sort(fixups_);
+
+	utilities::safe_uint<std::uint32_t> total_size;
+	for (std::size_t first = 0; first != fixups_.size();)
+	{
+		const auto virtual_address = fixups_[first].rva & ~page_mask;
+		std::size_t last = first;
+		std::size_t elem_count = 0;
+		for (; last != fixups_.size()
+			&& (fixups_[last].rva & ~page_mask) == virtual_address; ++last)
+		{
+			elem_count += fixups_[last].type == relocation_type::highadj ? 2u : 1u;
+		}
+
+		if (options_.align_base_relocation_structures && (elem_count % 2))
+			++elem_count;
+
+		utilities::safe_uint<std::uint32_t> size_of_block = descriptor_size;
+		size_of_block += elem_count * entry_size;
+		total_size += size_of_block.value();
+
+		blocks_.push_back({ virtual_address, first, last - first,
+			size_of_block.value() });
+		first = last;
+	}
+
+	built_size_ = total_size.value();
+}
+
+std::uint32_t relocation_fixup_builder::build(std::span<std::byte> buf) const
+{
+	if (buf.size() < built_size_)
+		throw pe_error(utilities::generic_errc::buffer_overrun);
+
+	auto* ptr = buf.data();
+	for (const auto& block : blocks_)
+	{
+		auto* block_end = ptr + block.size_of_block;
+		ptr = write_little(ptr, block.virtual_address);
+		ptr = write_little(ptr, block.size_of_block);
+		for (std::size_t i = block.first_fixup,
+			end = block.first_fixup + block.fixup_count; i != end; ++i)
+		{
+			const auto& fixup = fixups_[i];
+			ptr = write_little(ptr, static_cast<std::uint16_t>(
+				((static_cast<std::uint16_t>(fixup.type) & 0xfu) << 12u)
+				| (fixup.rva & page_mask)));
+			if (fixup.type == relocation_type::highadj)
+				ptr = write_little(ptr, fixup.param);
+		}
+
+		//Absolute padding entry
+		if (ptr != block_end)
+			ptr = write_little(ptr, std::uint16_t{});
+		assert(ptr == block_end);
+	}
+
+	return built_size_;
+}
+
+std::vector<std::byte> relocation_fixup_builder::build() const
+{
+	std::vector<std::byte> result(built_size_);
+	(void)build(result);
+	return result;
+}
+
+std::uint32_t build_new(image::image& instance,
+	const relocation_fixup_builder& builder)
+{
+	const auto& options = builder.get_options();
+	assert(options.directory_rva);
+	auto result = builder.build(section_data_from_rva(
+		instance, options.directory_rva, true));
+	if (options.update_data_directory)
+	{
+		auto& dir = instance.get_data_directories().get_directory(
+			core::data_directories::directory_type::basereloc);
+		dir->virtual_address = options.directory_rva;
+		dir->size = result;
+	}
+	return result;
+}
+
+} //namespace pe_bliss::relocations
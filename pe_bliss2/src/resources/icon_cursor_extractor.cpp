@@ -0,0 +1,289 @@
+#include "pe_bliss2/resources/icon_cursor_extractor.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "buffers/input_buffer_stateful_wrapper.h"
+#include "buffers/output_buffer_interface.h"
+#include "buffers/output_memory_ref_buffer.h"
+#include "pe_bliss2/detail/resources/icon_cursor.h"
+#include "pe_bliss2/packed_struct.h"
+#include "pe_bliss2/pe_error.h"
+
+namespace
+{
+
+struct icon_cursor_extractor_error_category : std::error_category
+{
+	const char* name() const noexcept override
+	{
+		return "icon_cursor_extractor";
+	}
+
+	std::string message(int ev) const override
+	{
+		using enum pe_bliss::resources::icon_cursor_extractor_errc;
+		switch (static_cast<pe_bliss::resources::icon_cursor_extractor_errc>(ev))
+		{
+		case unable_to_read_group:
+			return "Unable to read icon or cursor group";
+		case invalid_group_header:
+			return "Invalid icon or cursor group header";
+		case absent_image:
+			return "Icon or cursor referenced by the group is absent";
+		case invalid_image:
+			return "Invalid icon or cursor data";
+		case too_large_file:
+			return "Too large icon or cursor file";
+		case invalid_file:
+			return "Icon or cursor file does not belong to the extractor";
+		default:
+			return {};
+		}
+	}
+};
+
+const icon_cursor_extractor_error_category icon_cursor_extractor_error_category_instance;
+
+} //namespace
+
+namespace pe_bliss::resources
+{
+
+std::error_code make_error_code(icon_cursor_extractor_errc e) noexcept
+{
+	return { static_cast<int>(e), icon_cursor_extractor_error_category_instance };
+}
+
+namespace
+{
+
+constexpr std::uint32_t hotspots_size = packed_struct<
+	detail::resources::cursor_hotspots>::packed_size;
+
+template<typename Packed>
+void append(std::vector<std::byte>& headers, const Packed& value)
+{
+	auto offset = headers.size();
+	headers.resize(offset + Packed::packed_size);
+	(void)value.serialize(headers.data() + offset, Packed::packed_size, true);
+}
+
+template<typename Index>
+const typename Index::data_entry_type* find_image(const Index& index,
+	resource_type type, resource_id_type id, resource_id_type language) noexcept
+{
+	if (const auto* data = index.find(type, id, language); data)
+		return data;
+
+	auto languages = index.find_all(type, id);
+	return languages.empty() ? nullptr : languages.front().data;
+}
+
+} //namespace
+
+template<typename... Bases>
+icon_cursor_extractor_base<Bases...>::icon_cursor_extractor_base(
+	const index_type& index, const icon_cursor_extract_options& options)
+{
+	const auto& entries = index.get_entries();
+	auto add_groups = [this, &index, &entries](
+		resource_type group_type, resource_type image_type) {
+		for (const auto& group : index.find_all(group_type))
+			add_group(index, group, &group - entries.data(), image_type);
+	};
+
+	if (options.extract_icons)
+		add_groups(resource_type::icon_group, resource_type::icon);
+	if (options.extract_cursors)
+		add_groups(resource_type::cursor_group, resource_type::cursor);
+}
+
+template<typename... Bases>
+void icon_cursor_extractor_base<Bases...>::add_group_error(
+	icon_cursor_extractor_errc error, std::size_t group_index)
+{
+	if constexpr ((std::is_base_of_v<error_list, Bases> || ...))
+		this->add_error(error, group_index);
+}
+
+template<typename... Bases>
+void icon_cursor_extractor_base<Bases...>::add_group(const index_type& index,
+	const typename index_type::entry_type& group,
+	std::size_t group_index, resource_type image_type)
+{
+	const bool is_cursor = image_type == resource_type::cursor;
+	const auto& group_buf = group.data->get_raw_data();
+
+	packed_struct<detail::resources::ico_header> header;
+	buffers::input_buffer_stateful_wrapper_ref group_ref(*group_buf.data());
+	try
+	{
+		header.deserialize(group_ref, false);
+	}
+	catch (const std::system_error&)
+	{
+		add_group_error(icon_cursor_extractor_errc::unable_to_read_group, group_index);
+		return;
+	}
+
+	const auto expected_type = is_cursor
+		? detail::resources::cursor_type : detail::resources::icon_type;
+	if (header->reserved || header->type != expected_type)
+	{
+		add_group_error(icon_cursor_extractor_errc::invalid_group_header, group_index);
+		return;
+	}
+
+	const auto first_image = images_.size();
+	const auto header_offset = headers_.size();
+	const std::size_t file_headers_size = decltype(header)::packed_size
+		+ packed_struct<detail::resources::icondirentry>::packed_size * header->count;
+	std::uint64_t file_size = file_headers_size;
+	auto rollback = [this, first_image, header_offset] {
+		images_.resize(first_image);
+		headers_.resize(header_offset);
+	};
+
+	append(headers_, header);
+	try
+	{
+		for (std::uint16_t i = 0; i != header->count; ++i)
+		{
+			packed_struct<detail::resources::icon_group> icon_header;
+			packed_struct<detail::resources::cursor_group> cursor_header;
+			if (is_cursor)
+				cursor_header.deserialize(group_ref, false);
+			else
+				icon_header.deserialize(group_ref, false);
+
+			const auto* data = find_image(index, image_type, is_cursor
+				? cursor_header->number : icon_header->number, group.language);
+			if (!data)
+			{
+				rollback();
+				add_group_error(icon_cursor_extractor_errc::absent_image, group_index);
+				return;
+			}
+
+			const auto& image_buf = data->get_raw_data();
+			auto size = image_buf.physical_size();
+			if (is_cursor && size < hotspots_size)
+			{
+				rollback();
+				add_group_error(icon_cursor_extractor_errc::invalid_image, group_index);
+				return;
+			}
+
+			if (is_cursor)
+				size -= hotspots_size;
+
+			if (size > (std::numeric_limits<std::uint32_t>::max)()
+				|| file_size + size > (std::numeric_limits<std::uint32_t>::max)())
+			{
+				rollback();
+				add_group_error(icon_cursor_extractor_errc::too_large_file, group_index);
+				return;
+			}
+
+			const auto image_size = static_cast<std::uint32_t>(size);
+			const auto image_offset = static_cast<std::uint32_t>(file_size);
+			if (is_cursor)
+			{
+				packed_struct<detail::resources::cursor_hotspots> hotspots;
+				buffers::input_buffer_stateful_wrapper_ref image_ref(*image_buf.data());
+				hotspots.deserialize(image_ref, false);
+
+				packed_struct<detail::resources::cursordirentry> dir_entry;
+				dir_entry->width = static_cast<std::uint8_t>(cursor_header->width);
+				dir_entry->height = static_cast<std::uint8_t>(cursor_header->height / 2u);
+				dir_entry->hotspot_x = hotspots->hotspot_x;
+				dir_entry->hotspot_y = hotspots->hotspot_y;
+				dir_entry->size_in_bytes = image_size;
+				dir_entry->image_offset = image_offset;
+				append(headers_, dir_entry);
+			}
+			else
+			{
+				packed_struct<detail::resources::icondirentry> dir_entry;
+				dir_entry->width = icon_header->width;
+				dir_entry->height = icon_header->height;
+				dir_entry->color_count = icon_header->color_count;
+				dir_entry->reserved = icon_header->reserved;
+				dir_entry->planes = icon_header->planes;
+				dir_entry->bit_count = icon_header->bit_count;
+				dir_entry->size_in_bytes = image_size;
+				dir_entry->image_offset = image_offset;
+				append(headers_, dir_entry);
+			}
+
+			images_.push_back({ data, is_cursor ? hotspots_size : 0u, image_size });
+			file_size += size;
+		}
+	}
+	catch (const std::system_error&)
+	{
+		rollback();
+		add_group_error(icon_cursor_extractor_errc::unable_to_read_group, group_index);
+		return;
+	}
+
+	files_.push_back({
+		.group_type = is_cursor ? resource_type::cursor_group : resource_type::icon_group,
+		.name_or_id = group.name_or_id,
+		.language = group.language,
+		.size = static_cast<std::uint32_t>(file_size),
+		.header_offset = header_offset,
+		.first_image = first_image,
+		.image_count = header->count
+	});
+	total_size_ += file_size;
+}
+
+template<typename... Bases>
+void icon_cursor_extractor_base<Bases...>::write(const file_type& file,
+	buffers::output_buffer_interface& buf) const
+{
+	const std::size_t headers_size
+		= packed_struct<detail::resources::ico_header>::packed_size
+		+ packed_struct<detail::resources::icondirentry>::packed_size
+		* file.image_count;
+	if (file.header_offset + headers_size > headers_.size()
+		|| file.first_image + file.image_count > images_.size())
+	{
+		throw pe_error(icon_cursor_extractor_errc::invalid_file);
+	}
+	buf.write(headers_size, headers_.data() + file.header_offset);
+
+	for (std::size_t i = file.first_image,
+		end = file.first_image + file.image_count; i != end; ++i)
+	{
+		const auto& image = images_[i];
+		if (!image.size)
+			continue;
+
+		const auto& raw_data = image.data->get_raw_data();
+		auto input = raw_data.data();
+		if (const auto* ptr = input->get_raw_data(image.offset, image.size); ptr)
+			buf.write(image.size, ptr);
+		else
+			(void)raw_data.serialize_until(buf, image.offset, image.size);
+	}
+}
+
+template<typename... Bases>
+void icon_cursor_extractor_base<Bases...>::write(const file_type& file,
+	std::span<std::byte> buf) const
+{
+	buffers::output_memory_ref_buffer ref(buf);
+	write(file, ref);
+}
+
+template class icon_cursor_extractor_base<>;
+template class icon_cursor_extractor_base<error_list>;
+
+} //namespace pe_bliss::resources
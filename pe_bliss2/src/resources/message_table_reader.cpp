@@ -1,8 +1,10 @@
 #include "pe_bliss2/resources/message_table_reader.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <set>
 #include <string>
@@ -12,6 +14,7 @@
 
 #include "buffers/input_buffer_interface.h"
 #include "pe_bliss2/detail/resources/message_table.h"
+#include "pe_bliss2/pe_error.h"
 #include "pe_bliss2/resources/resource_reader_errc.h"
 #include "utilities/safe_uint.h"
 
@@ -66,6 +69,15 @@ struct interval
 	}
 };
 
+template<typename T>
+T read_little(const std::byte* data) noexcept
+{
+	T value;
+	std::memcpy(&value, data, sizeof(value));
+	boost::endian::little_to_native_inplace(value);
+	return value;
+}
+
 } // namespace
 
 namespace pe_bliss::resources
@@ -278,4 +290,218 @@ message_table_details message_table_from_resource(
 	return table;
 }
 
+std::string_view message_view::get_ansi() const noexcept
+{
+	if (encoding_ != message_encoding::ansi)
+		return {};
+
+	return { reinterpret_cast<const char*>(text_.data()), text_.size() };
+}
+
+std::u8string_view message_view::get_utf8() const noexcept
+{
+	if (encoding_ != message_encoding::utf8)
+		return {};
+
+	return { reinterpret_cast<const char8_t*>(text_.data()), text_.size() };
+}
+
+std::u16string message_view::get_unicode() const
+{
+	std::u16string result;
+	get_unicode(result);
+	return result;
+}
+
+void message_view::get_unicode(std::u16string& result) const
+{
+	result.clear();
+	if (encoding_ != message_encoding::unicode)
+		return;
+
+	result.resize(text_.size() / sizeof(char16_t));
+	for (std::size_t i = 0; i != result.size(); ++i)
+		result[i] = read_little<char16_t>(text_.data() + i * sizeof(char16_t));
+}
+
+message_entry::message_type message_view::decode() const
+{
+	message_entry::message_type result;
+	switch (encoding_)
+	{
+	case message_encoding::ansi:
+		result.emplace<ansi_message>().value() = get_ansi();
+		break;
+	case message_encoding::unicode:
+		get_unicode(result.emplace<unicode_message>().value());
+		break;
+	case message_encoding::utf8:
+		result.emplace<utf8_message>().value() = get_utf8();
+		break;
+	default:
+		break;
+	}
+	return result;
+}
+
+message_table_index::message_table_index(const buffers::input_buffer_ptr& buf,
+	const message_table_read_options& options)
+	: buf_(buf)
+{
+	assert(buf_);
+	//Contiguous buffers are referenced, other buffers are copied once
+	auto physical_size = buf_->physical_size();
+	const std::byte* data = physical_size
+		? buf_->get_raw_data(0u, physical_size) : nullptr;
+	if (!data && physical_size)
+	{
+		copied_data_.resize(physical_size);
+		buf_->read(0u, physical_size, copied_data_.data());
+		data = copied_data_.data();
+	}
+	data_ = { data, physical_size };
+
+	using table_descriptor_type = message_table::descriptor_type;
+	using block_descriptor_type = message_block::descriptor_type;
+	if (data_.size() < table_descriptor_type::packed_size)
+		throw pe_error(resource_reader_errc::buffer_read_error);
+
+	auto total_blocks = (std::min)(read_little<std::uint32_t>(data_.data()),
+		options.max_block_count);
+	std::uint32_t remaining_entries = options.max_message_count;
+	std::vector<block> blocks;
+	for (std::uint32_t i = 0; i != total_blocks && remaining_entries; ++i)
+	{
+		auto block_offset = table_descriptor_type::packed_size
+			+ static_cast<std::size_t>(i) * block_descriptor_type::packed_size;
+		if (block_offset + block_descriptor_type::packed_size > data_.size())
+			break;
+
+		const auto* descriptor = data_.data() + block_offset;
+		auto low_id = read_little<std::uint32_t>(descriptor);
+		auto high_id = read_little<std::uint32_t>(descriptor + sizeof(std::uint32_t));
+		auto offset_to_entries = read_little<std::uint32_t>(
+			descriptor + 2u * sizeof(std::uint32_t));
+		if (low_id > high_id
+			|| high_id - low_id == (std::numeric_limits<std::uint32_t>::max)())
+		{
+			continue;
+		}
+
+		auto entry_count = (std::min)(high_id - low_id + 1u, remaining_entries);
+		remaining_entries -= entry_count;
+		blocks.push_back({ .low_id = low_id, .high_id = low_id + entry_count - 1u,
+			.first_entry = static_cast<std::uint32_t>(entries_.size()) });
+		load_entries(offset_to_entries, entry_count, options.allow_virtual_data);
+	}
+
+	static constexpr auto by_low_id = [](const block& l, const block& r) {
+		return l.low_id < r.low_id;
+	};
+	blocks_ = blocks;
+	std::stable_sort(blocks_.begin(), blocks_.end(), by_low_id);
+	auto overlap = std::adjacent_find(blocks_.cbegin(), blocks_.cend(),
+		[](const block& l, const block& r) { return l.high_id >= r.low_id; });
+	if (overlap != blocks_.cend())
+	{
+		has_overlapping_ids_ = true;
+		blocks_ = std::move(blocks);
+	}
+}
+
+void message_table_index::load_entries(std::uint32_t offset_to_entries,
+	std::uint32_t entry_count, bool allow_virtual_data)
+{
+	using entry_descriptor_type = message_entry::descriptor_type;
+
+	auto first_entry = entries_.size();
+	entries_.resize(first_entry + entry_count);
+	std::size_t offset = offset_to_entries;
+	for (std::uint32_t i = 0; i != entry_count; ++i)
+	{
+		if (offset + entry_descriptor_type::packed_size > data_.size())
+			break;
+
+		const auto* descriptor = data_.data() + offset;
+		auto length = read_little<std::uint16_t>(descriptor);
+		auto flags = read_little<std::uint16_t>(descriptor + sizeof(std::uint16_t));
+		std::size_t char_size = 0;
+		switch (flags)
+		{
+		case detail::resources::message_resource_ansi:
+		case detail::resources::message_resource_utf8:
+			char_size = sizeof(char);
+			break;
+		case detail::resources::message_resource_unicode:
+			char_size = sizeof(char16_t);
+			break;
+		default:
+			break;
+		}
+
+		if (!char_size)
+		{
+			//Unknown encoding, skip the message
+			offset += (std::max<std::size_t>)(length, entry_descriptor_type::packed_size);
+			continue;
+		}
+
+		if (length < entry_descriptor_type::packed_size + char_size)
+			break;
+
+		auto text_offset = offset + entry_descriptor_type::packed_size;
+		std::size_t text_size = (length - entry_descriptor_type::packed_size
+			- char_size) / char_size * char_size;
+		offset += length;
+		if (text_offset + text_size + char_size > data_.size())
+		{
+			//Virtual part of the message consists of null characters
+			if (!allow_virtual_data)
+				break;
+			text_size = text_offset > data_.size() ? 0u
+				: (data_.size() - text_offset) / char_size * char_size;
+		}
+
+		auto& result = entries_[first_entry + i];
+		result.text_offset = static_cast<std::uint32_t>(text_offset);
+		result.text_size = static_cast<std::uint32_t>(text_size);
+		result.encoding = static_cast<message_encoding>(flags);
+		result.is_valid = true;
+	}
+}
+
+std::optional<message_view> message_table_index::find(
+	std::uint32_t message_id) const noexcept
+{
+	const block* found = nullptr;
+	if (has_overlapping_ids_)
+	{
+		auto it = std::find_if(blocks_.cbegin(), blocks_.cend(),
+			[message_id](const block& b) {
+				return b.low_id <= message_id && message_id <= b.high_id;
+			});
+		if (it != blocks_.cend())
+			found = &*it;
+	}
+	else
+	{
+		auto it = std::upper_bound(blocks_.cbegin(), blocks_.cend(), message_id,
+			[](std::uint32_t id, const block& b) { return id < b.low_id; });
+		if (it != blocks_.cbegin() && message_id <= (--it)->high_id)
+			found = &*it;
+	}
+
+	std::optional<message_view> result;
+	if (!found)
+		return result;
+
+	const auto& message = entries_[found->first_entry + (message_id - found->low_id)];
+	if (message.is_valid)
+	{
+		result.emplace(message.encoding,
+			data_.subspan(message.text_offset, message.text_size));
+	}
+	return result;
+}
+
 } //namespace pe_bliss::resources
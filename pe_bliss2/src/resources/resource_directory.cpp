@@ -1,7 +1,8 @@
 #include "pe_bliss2/resources/resource_directory.h"
 
 #include <algorithm>
-#include <iterator>
+#include <cassert>
+#include <string_view>
 #include <string>
 #include <system_error>
 #include <type_traits>
@@ -85,6 +86,95 @@ private:
 	std::u16string_view name_;
 };
 
+struct id_entry_less
+{
+	template<typename Entry>
+	bool operator()(const Entry& entry, resource_id_type id) const noexcept
+	{
+		const auto* entry_id = std::get_if<resource_id_type>(&entry.get_name_or_id());
+		return !entry_id || *entry_id < id;
+	}
+};
+
+struct name_entry_less
+{
+	template<typename Entry>
+	bool operator()(const Entry& entry, std::u16string_view name) const noexcept
+	{
+		const auto* entry_name = std::get_if<pe_bliss::packed_utf16_string>(
+			&entry.get_name_or_id());
+		return entry_name && entry_name->value() < name;
+	}
+};
+
+//Named entries first, ordered by name, then entries without a name
+//or an ID, then ID entries, ordered by ID. This matches the order
+//id_entry_less and name_entry_less expect.
+struct entry_order_less
+{
+	template<typename Entry>
+	bool operator()(const Entry& l, const Entry& r) const noexcept
+	{
+		const auto& l_name_or_id = l.get_name_or_id();
+		const auto& r_name_or_id = r.get_name_or_id();
+		if (l_name_or_id.index() != r_name_or_id.index())
+			return get_rank(l_name_or_id) < get_rank(r_name_or_id);
+
+		if (const auto* l_name = std::get_if<pe_bliss::packed_utf16_string>(
+			&l_name_or_id))
+		{
+			return l_name->value()
+				< std::get_if<pe_bliss::packed_utf16_string>(&r_name_or_id)->value();
+		}
+		if (const auto* l_id = std::get_if<resource_id_type>(&l_name_or_id))
+			return *l_id < *std::get_if<resource_id_type>(&r_name_or_id);
+		return false;
+	}
+
+private:
+	template<typename NameOrId>
+	static int get_rank(const NameOrId& name_or_id) noexcept
+	{
+		if (std::holds_alternative<pe_bliss::packed_utf16_string>(name_or_id))
+			return 0;
+		if (std::holds_alternative<resource_id_type>(name_or_id))
+			return 2;
+		return 1;
+	}
+};
+
+template<typename Entries>
+bool are_entries_sorted(const Entries& entries) noexcept
+{
+	return std::is_sorted(entries.begin(), entries.end(), entry_order_less{});
+}
+
+template<typename Entries>
+auto find_entry_by_id(Entries& entries, bool sorted, resource_id_type id) noexcept
+{
+	assert(!sorted || are_entries_sorted(entries));
+	if (!sorted)
+		return std::find_if(entries.begin(), entries.end(), id_entry_finder(id));
+
+	auto it = std::lower_bound(entries.begin(), entries.end(), id, id_entry_less{});
+	if (it != entries.end() && !id_entry_finder(id)(*it))
+		it = entries.end();
+	return it;
+}
+
+template<typename Entries>
+auto find_entry_by_name(Entries& entries, bool sorted, std::u16string_view name) noexcept
+{
+	assert(!sorted || are_entries_sorted(entries));
+	if (!sorted)
+		return std::find_if(entries.begin(), entries.end(), name_entry_finder(name));
+
+	auto it = std::lower_bound(entries.begin(), entries.end(), name, name_entry_less{});
+	if (it != entries.end() && !name_entry_finder(name)(*it))
+		it = entries.end();
+	return it;
+}
+
 } //namespace
 
 namespace pe_bliss::resources
@@ -95,32 +185,38 @@ std::error_code make_error_code(resource_directory_errc e) noexcept
 	return { static_cast<int>(e), resource_directory_error_category_instance };
 }
 
+template<typename... Bases>
+bool resource_directory_base<Bases...>::has_sorted_entries() const noexcept
+{
+	return are_entries_sorted(entries_);
+}
+
 template<typename... Bases>
 typename resource_directory_base<Bases...>::entry_list_type::const_iterator
 resource_directory_base<Bases...>::entry_iterator_by_id(resource_id_type id) const noexcept
 {
-	return std::find_if(entries_.begin(), entries_.end(), id_entry_finder(id));
+	return find_entry_by_id(entries_, sorted_, id);
 }
 
 template<typename... Bases>
 typename resource_directory_base<Bases...>::entry_list_type::iterator
 resource_directory_base<Bases...>::entry_iterator_by_id(resource_id_type id) noexcept
 {
-	return std::find_if(entries_.begin(), entries_.end(), id_entry_finder(id));
+	return find_entry_by_id(entries_, sorted_, id);
 }
 
 template<typename... Bases>
 typename resource_directory_base<Bases...>::entry_list_type::const_iterator
 resource_directory_base<Bases...>::entry_iterator_by_name(std::u16string_view name) const noexcept
 {
-	return std::find_if(entries_.begin(), entries_.end(), name_entry_finder(name));
+	return find_entry_by_name(entries_, sorted_, name);
 }
 
 template<typename... Bases>
 typename resource_directory_base<Bases...>::entry_list_type::iterator
 resource_directory_base<Bases...>::entry_iterator_by_name(std::u16string_view name) noexcept
 {
-	return std::find_if(entries_.begin(), entries_.end(), name_entry_finder(name));
+	return find_entry_by_name(entries_, sorted_, name);
 }
 
 template<typename... Bases>
@@ -294,20 +390,38 @@ typename resource_directory_base<Bases...>::entry_type& try_emplace_entry(
 	else
 		it = dir.entry_iterator_by_name(name_or_id);
 
-	if (it == dir.get_entries().end())
+	//Inserted entries keep the order, so the sorted flag,
+	//which is cleared by get_entries(), is restored
+	const bool sorted = dir.is_sorted();
+	auto& entries = dir.get_entries();
+	dir.set_sorted(sorted);
+	if (it == entries.end())
 	{
-		auto& entry = dir.get_entries().emplace_back();
+		auto pos = entries.end();
+		if (sorted)
+		{
+			if constexpr (is_id)
+			{
+				pos = std::lower_bound(entries.begin(), entries.end(),
+					name_or_id, id_entry_less{});
+			}
+			else
+			{
+				pos = std::lower_bound(entries.begin(), entries.end(),
+					std::u16string_view(name_or_id), name_entry_less{});
+			}
+		}
+
+		it = entries.emplace(pos);
 		if constexpr (is_id)
 		{
-			entry.get_name_or_id() = name_or_id;
+			it->get_name_or_id() = name_or_id;
 		}
 		else
 		{
-			entry.get_name_or_id() = packed_utf16_string(
+			it->get_name_or_id() = packed_utf16_string(
 				std::forward<NameOrId>(name_or_id));
 		}
-
-		it = std::prev(dir.get_entries().end());
 	}
 
 	auto& data_or_directory = it->get_data_or_directory();
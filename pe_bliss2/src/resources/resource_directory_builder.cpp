@@ -0,0 +1,457 @@
+#include "pe_bliss2/resources/resource_directory_builder.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/endian/conversion.hpp>
+
+#include "buffers/output_buffer_interface.h"
+#include "buffers/output_memory_ref_buffer.h"
+#include "pe_bliss2/core/data_directories.h"
+#include "pe_bliss2/detail/resources/image_resource_directory.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/image/section_data_from_va.h"
+#include "pe_bliss2/pe_error.h"
+#include "utilities/safe_uint.h"
+
+namespace
+{
+
+struct resource_directory_builder_error_category : std::error_category
+{
+	const char* name() const noexcept override
+	{
+		return "resource_directory_builder";
+	}
+
+	std::string message(int ev) const override
+	{
+		using enum pe_bliss::resources::resource_directory_builder_errc;
+		switch (static_cast<pe_bliss::resources::resource_directory_builder_errc>(ev))
+		{
+		case invalid_entry:
+			return "Resource directory entry must have a name or ID and contain a directory or data";
+		case invalid_data_alignment:
+			return "Resource data alignment must be a power of two";
+		case too_large_directory:
+			return "Resource directory is too large";
+		default:
+			return {};
+		}
+	}
+};
+
+const resource_directory_builder_error_category resource_directory_builder_error_category_instance;
+
+using namespace pe_bliss;
+using namespace pe_bliss::resources;
+
+void update_data_directory(image::image& instance,
+	const builder_options& options, std::uint32_t size)
+{
+	if (options.update_data_directory)
+	{
+		auto& dir = instance.get_data_directories().get_directory(
+			core::data_directories::directory_type::resource);
+		dir->virtual_address = options.directory_rva;
+		dir->size = size;
+	}
+}
+
+void validate_options(const builder_options& options)
+{
+	if (!std::has_single_bit(options.data_alignment))
+		throw pe_error(resource_directory_builder_errc::invalid_data_alignment);
+}
+
+template<typename Entry>
+void validate_entry(const Entry& entry)
+{
+	if (!(entry.is_named() || entry.has_id())
+		|| !(entry.has_directory() || entry.has_data()))
+	{
+		throw pe_error(resource_directory_builder_errc::invalid_entry);
+	}
+}
+
+//Returns entries of the directory, which are not going to be reordered.
+//Unlike get_entries(), keeps the sorted flag of a mutable directory.
+template<typename Directory>
+auto& get_ordered_entries(Directory& directory) noexcept
+{
+	if constexpr (std::is_const_v<Directory>)
+	{
+		return directory.get_entries();
+	}
+	else
+	{
+		const bool sorted = directory.is_sorted();
+		auto& entries = directory.get_entries();
+		directory.set_sorted(sorted);
+		return entries;
+	}
+}
+
+template<typename Directory>
+void sort_entries(Directory& directory)
+{
+	static constexpr auto entry_less = [](const auto& l, const auto& r) {
+		if (l.is_named() != r.is_named())
+			return l.is_named();
+		if (l.is_named())
+			return l.get_name().value() < r.get_name().value();
+		return l.get_id() < r.get_id();
+	};
+
+	auto& entries = directory.get_entries();
+	for (const auto& entry : entries)
+		validate_entry(entry);
+
+	//Entries are usually sorted already, if the directory was loaded
+	if (!directory.has_sorted_entries())
+		std::sort(entries.begin(), entries.end(), entry_less);
+	directory.set_sorted(true);
+
+	for (auto& entry : entries)
+	{
+		if (entry.has_directory())
+			sort_entries(entry.get_directory());
+	}
+}
+
+//Directory may be const, if only the size is required
+template<typename Directory>
+class resource_layout
+{
+	using data_entry_type = std::remove_reference_t<
+		decltype(std::declval<Directory&>().get_entries().front().get_data())>;
+	using entry_descriptor_type = typename std::remove_cvref_t<
+		decltype(std::declval<Directory&>().get_entries().front())>::descriptor_type;
+	using data_descriptor_type = typename std::remove_cv_t<
+		data_entry_type>::descriptor_type;
+
+	struct blob
+	{
+		std::span<const std::byte> physical_data;
+		std::uint32_t size{};
+		std::uint32_t offset{};
+	};
+
+public:
+	resource_layout(Directory& root, const builder_options& options)
+	{
+		utilities::safe_uint<std::uint32_t> offset;
+		directories_.push_back(&root);
+		for (std::size_t i = 0; i != directories_.size(); ++i)
+		{
+			auto& entries = get_ordered_entries(*directories_[i]);
+			auto named_count = std::count_if(entries.cbegin(), entries.cend(),
+				[](const auto& entry) { return entry.is_named(); });
+			if (static_cast<std::size_t>(named_count) > max_entry_count
+				|| entries.size() - named_count > max_entry_count)
+			{
+				throw pe_error(resource_directory_builder_errc::too_large_directory);
+			}
+
+			directory_offsets_.push_back(offset.value());
+			offset += directories_[i]->get_descriptor().packed_size;
+			offset += entry_descriptor_type::packed_size * entries.size();
+			for (auto& entry : entries)
+			{
+				validate_entry(entry);
+				if (entry.has_directory())
+					directories_.push_back(&entry.get_directory());
+				else
+					data_entries_.push_back(&entry.get_data());
+
+				if (entry.is_named())
+				{
+					auto name = std::u16string_view(entry.get_name().value());
+					if (name.size() > max_entry_count)
+						throw pe_error(resource_directory_builder_errc::invalid_entry);
+					if (name_offsets_.try_emplace(name).second)
+						names_.push_back(name);
+				}
+			}
+		}
+
+		data_entries_offset_ = offset.value();
+		offset += data_descriptor_type::packed_size * data_entries_.size();
+
+		for (auto name : names_)
+		{
+			name_offsets_[name] = offset.value();
+			offset += sizeof(std::uint16_t) + name.size() * sizeof(char16_t);
+		}
+
+		//Directory, name and data entry offsets are 31-bit
+		if (offset.value() & detail::resources::data_is_directory_flag)
+			throw pe_error(resource_directory_builder_errc::too_large_directory);
+
+		offset.align_up(options.data_alignment);
+		layout_data(offset, options);
+		size_ = offset.value();
+
+		//All data RVAs must fit
+		(void)(utilities::safe_uint(options.directory_rva) + size_);
+	}
+
+	[[nodiscard]]
+	std::uint32_t get_size() const noexcept
+	{
+		return size_;
+	}
+
+	//Updates descriptors and writes the directory to data,
+	//which must be at least get_size() bytes long and zero-initialized
+	void write(std::byte* data, rva_type directory_rva)
+		requires(!std::is_const_v<Directory>)
+	{
+		std::size_t next_directory = 1u, next_data_entry = 0u;
+		for (std::size_t i = 0; i != directories_.size(); ++i)
+		{
+			auto& directory = *directories_[i];
+			auto& entries = get_ordered_entries(directory);
+			auto& descriptor = directory.get_descriptor();
+			auto named_count = std::count_if(entries.cbegin(), entries.cend(),
+				[](const auto& entry) { return entry.is_named(); });
+			descriptor->number_of_named_entries = static_cast<std::uint16_t>(named_count);
+			descriptor->number_of_id_entries = static_cast<std::uint16_t>(
+				entries.size() - named_count);
+
+			auto* ptr = data + directory_offsets_[i];
+			ptr += descriptor.serialize(ptr, descriptor.packed_size, true);
+			for (auto& entry : entries)
+			{
+				auto& entry_descriptor = entry.get_descriptor();
+				if (entry.is_named())
+				{
+					entry_descriptor->name_or_id = name_offsets_.at(
+						entry.get_name().value())
+						| detail::resources::name_is_string_flag;
+				}
+				else
+				{
+					entry_descriptor->name_or_id = entry.get_id();
+				}
+
+				if (entry.has_directory())
+				{
+					entry_descriptor->offset_to_data_or_directory
+						= directory_offsets_[next_directory++]
+						| detail::resources::data_is_directory_flag;
+				}
+				else
+				{
+					entry_descriptor->offset_to_data_or_directory = static_cast<std::uint32_t>(
+						data_entries_offset_ + data_descriptor_type::packed_size * next_data_entry++);
+				}
+
+				ptr += entry_descriptor.serialize(ptr, entry_descriptor.packed_size, true);
+			}
+		}
+
+		auto* ptr = data + data_entries_offset_;
+		for (std::size_t i = 0; i != data_entries_.size(); ++i)
+		{
+			const auto& data_blob = blobs_[data_blob_indexes_[i]];
+			auto& descriptor = data_entries_[i]->get_descriptor();
+			descriptor->offset_to_data = directory_rva + data_blob.offset;
+			descriptor->size = data_blob.size;
+			ptr += descriptor.serialize(ptr, descriptor.packed_size, true);
+		}
+
+		for (auto name : names_)
+		{
+			ptr = data + name_offsets_.at(name);
+			write_word(ptr, static_cast<std::uint16_t>(name.size()));
+			for (auto ch : name)
+				write_word(ptr, static_cast<std::uint16_t>(ch));
+		}
+
+		for (const auto& data_blob : blobs_)
+		{
+			if (!data_blob.physical_data.empty())
+			{
+				std::memcpy(data + data_blob.offset, data_blob.physical_data.data(),
+					data_blob.physical_data.size());
+			}
+		}
+	}
+
+private:
+	void layout_data(utilities::safe_uint<std::uint32_t>& offset,
+		const builder_options& options)
+	{
+		data_blob_indexes_.reserve(data_entries_.size());
+		for (auto* data_entry : data_entries_)
+		{
+			const auto& raw_data = data_entry->get_raw_data();
+			auto size = raw_data.size();
+			auto physical_size = raw_data.physical_size();
+			if (size > (std::numeric_limits<std::uint32_t>::max)())
+				throw pe_error(resource_directory_builder_errc::too_large_directory);
+
+			//Contiguous buffers are referenced and copied to the result directly
+			std::span<const std::byte> physical_data;
+			if (physical_size)
+			{
+				const auto* ptr = raw_data.data()->get_raw_data(0u, physical_size);
+				if (!ptr)
+				{
+					auto& copy = copies_.emplace_back(physical_size);
+					raw_data.data()->read(0u, physical_size, copy.data());
+					ptr = copy.data();
+				}
+				physical_data = { ptr, physical_size };
+			}
+
+			std::size_t hash{};
+			if (options.deduplicate_data)
+			{
+				hash = std::hash<std::string_view>{}(std::string_view(
+					reinterpret_cast<const char*>(physical_data.data()),
+					physical_data.size())) ^ size;
+				auto [begin, end] = blobs_by_hash_.equal_range(hash);
+				auto it = std::find_if(begin, end, [this, size, physical_data](const auto& elem) {
+					const auto& other = blobs_[elem.second];
+					return other.size == size
+						&& std::ranges::equal(other.physical_data, physical_data);
+				});
+				if (it != end)
+				{
+					data_blob_indexes_.push_back(it->second);
+					continue;
+				}
+			}
+
+			data_blob_indexes_.push_back(blobs_.size());
+			if (options.deduplicate_data)
+				blobs_by_hash_.emplace(hash, blobs_.size());
+			blobs_.push_back({ physical_data, static_cast<std::uint32_t>(size),
+				offset.value() });
+			offset += size;
+			offset.align_up(options.data_alignment);
+		}
+	}
+
+	static void write_word(std::byte*& ptr, std::uint16_t value) noexcept
+	{
+		boost::endian::native_to_little_inplace(value);
+		std::memcpy(ptr, &value, sizeof(value));
+		ptr += sizeof(value);
+	}
+
+private:
+	static constexpr std::size_t max_entry_count
+		= (std::numeric_limits<std::uint16_t>::max)();
+
+private:
+	std::vector<Directory*> directories_;
+	std::vector<std::uint32_t> directory_offsets_;
+	std::vector<data_entry_type*> data_entries_;
+	std::uint32_t data_entries_offset_{};
+	std::vector<std::u16string_view> names_;
+	std::unordered_map<std::u16string_view, std::uint32_t> name_offsets_;
+	std::vector<blob> blobs_;
+	std::vector<std::size_t> data_blob_indexes_;
+	std::unordered_multimap<std::size_t, std::size_t> blobs_by_hash_;
+	std::vector<std::vector<std::byte>> copies_;
+	std::uint32_t size_{};
+};
+
+template<typename Directory>
+std::uint32_t build_new_impl(buffers::output_buffer_interface& buf, Directory& directory,
+	const builder_options& options)
+{
+	validate_options(options);
+	sort_entries(directory);
+
+	resource_layout<Directory> layout(directory, options);
+	std::vector<std::byte> data(layout.get_size());
+	layout.write(data.data(), options.directory_rva);
+	buf.write(data.size(), data.data());
+	return layout.get_size();
+}
+
+template<typename Directory>
+std::uint32_t build_new_impl(image::image& instance, Directory& directory,
+	const builder_options& options)
+{
+	assert(options.directory_rva);
+	auto buf = buffers::output_memory_ref_buffer(section_data_from_rva(
+		instance, options.directory_rva, true));
+	auto size = build_new_impl(buf, directory, options);
+	update_data_directory(instance, options, size);
+	return size;
+}
+
+template<typename Directory>
+std::uint32_t get_built_size_impl(const Directory& directory,
+	const builder_options& options)
+{
+	validate_options(options);
+	return resource_layout<const Directory>(directory, options).get_size();
+}
+
+} //namespace
+
+namespace pe_bliss::resources
+{
+
+std::error_code make_error_code(resource_directory_builder_errc e) noexcept
+{
+	return { static_cast<int>(e), resource_directory_builder_error_category_instance };
+}
+
+std::uint32_t build_new(image::image& instance, resource_directory_details& directory,
+	const builder_options& options)
+{
+	return build_new_impl(instance, directory, options);
+}
+
+std::uint32_t build_new(image::image& instance, resource_directory& directory,
+	const builder_options& options)
+{
+	return build_new_impl(instance, directory, options);
+}
+
+std::uint32_t build_new(buffers::output_buffer_interface& buf,
+	resource_directory_details& directory, const builder_options& options)
+{
+	return build_new_impl(buf, directory, options);
+}
+
+std::uint32_t build_new(buffers::output_buffer_interface& buf,
+	resource_directory& directory, const builder_options& options)
+{
+	return build_new_impl(buf, directory, options);
+}
+
+std::uint32_t get_built_size(const resource_directory_details& directory,
+	const builder_options& options)
+{
+	return get_built_size_impl(directory, options);
+}
+
+std::uint32_t get_built_size(const resource_directory& directory,
+	const builder_options& options)
+{
+	return get_built_size_impl(directory, options);
+}
+
+} //namespace pe_bliss::resources
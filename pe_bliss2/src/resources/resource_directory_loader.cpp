@@ -1,11 +1,15 @@
 #include "pe_bliss2/resources/resource_directory_loader.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <string>
 #include <system_error>
 #include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "pe_bliss2/core/data_directories.h"
 #include "pe_bliss2/detail/resources/image_resource_directory.h"
@@ -19,7 +23,6 @@
 #include "pe_bliss2/pe_types.h"
 #include "utilities/math.h"
 #include "utilities/safe_uint.h"
-#include "utilities/scoped_guard.h"
 
 namespace
 {
@@ -56,6 +59,10 @@ struct resource_directory_loader_error_category : std::error_category
 			return "Unsorted directory entries";
 		case duplicate_entries:
 			return "Duplicate directory entries";
+		case too_many_entries:
+			return "Too many resource directory entries";
+		case too_deep_directory_tree:
+			return "Resource directory tree is too deep";
 		default:
 			return {};
 		}
@@ -68,17 +75,51 @@ using namespace pe_bliss;
 using namespace pe_bliss::resources;
 
 using safe_rva_type = utilities::safe_uint<rva_type>;
-using visited_directories_set = std::unordered_set<rva_type>;
 
-bool is_sorted(const std::vector<resource_directory_entry_details>& entries)
+//(directory RVA, parent index) pairs
+using directory_path_list = std::vector<std::pair<rva_type, std::size_t>>;
+constexpr std::size_t no_parent = (std::numeric_limits<std::size_t>::max)();
+
+struct lazy_entry
 {
-	return std::is_sorted(entries.cbegin(), entries.cend(),
-		[](const auto& l, const auto& r)
+	resource_directory_entry_details* entry;
+	std::uint32_t depth;
+	std::size_t path;
+};
+
+struct loader_state
+{
+	//Paths from the root to the directories being loaded.
+	//Entries pointing to a directory on the current path (a loop) keep its RVA.
+	directory_path_list& paths;
+	//Index of the current directory in the paths list
+	std::size_t path;
+	//Set if loader_options::load_shared_directories_once is set:
+	//entries pointing to a directory which is already loaded keep its RVA.
+	std::unordered_set<rva_type>* loaded_directories;
+	std::uint32_t& remaining_entries;
+	std::uint64_t& max_rva;
+	std::uint32_t depth{};
+	//When set, entry contents are not loaded, and the entries
+	//are added to this list together with their directory depth and path
+	std::vector<lazy_entry>* lazy_entries{};
+};
+
+bool is_on_path(const loader_state& state, rva_type rva) noexcept
+{
+	for (auto index = state.path; index != no_parent;
+		index = state.paths[index].second)
 	{
-		if (l.is_named() == r.is_named())
-			return l.get_name_or_id() < r.get_name_or_id();
-		else
-			return l.is_named();
+		if (state.paths[index].first == rva)
+			return true;
+	}
+	return false;
+}
+
+bool has_names_and_ids(const std::vector<resource_directory_entry_details>& entries)
+{
+	return std::none_of(entries.cbegin(), entries.cend(), [](const auto& entry) {
+		return std::holds_alternative<std::monostate>(entry.get_name_or_id());
 	});
 }
 
@@ -128,12 +169,16 @@ void load_resource_data_entry(const image::image& instance, const loader_options
 }
 
 void load_resource_directory(const image::image& instance, const loader_options& options,
-	safe_rva_type resource_dir_rva, safe_rva_type current_rva, std::uint64_t& max_rva,
-	resource_directory_details& directory, visited_directories_set& visited_directories);
+	safe_rva_type resource_dir_rva, safe_rva_type current_rva,
+	resource_directory_details& directory, loader_state& state);
+
+void load_resource_directory_entry_contents(const image::image& instance,
+	const loader_options& options, safe_rva_type resource_dir_rva,
+	resource_directory_entry_details& entry, loader_state& state);
 
 bool load_resource_directory_entry(const image::image& instance, const loader_options& options,
-	safe_rva_type resource_dir_rva, safe_rva_type current_rva, std::uint64_t& max_rva,
-	resource_directory_entry_details& entry, visited_directories_set& visited_directories)
+	safe_rva_type resource_dir_rva, safe_rva_type current_rva,
+	resource_directory_entry_details& entry, loader_state& state)
 {
 	auto& entry_descriptor = entry.get_descriptor();
 
@@ -171,7 +216,7 @@ bool load_resource_directory_entry(const image::image& instance, const loader_op
 			return true;
 		}
 		
-		max_rva = (std::max)(max_rva,
+		state.max_rva = (std::max)(state.max_rva,
 			static_cast<std::uint64_t>(name_rva.value()) + name.data_size());
 	}
 	else
@@ -179,6 +224,19 @@ bool load_resource_directory_entry(const image::image& instance, const loader_op
 		entry.get_name_or_id().emplace<resource_id_type>(entry_descriptor->name_or_id);
 	}
 
+	if (state.lazy_entries)
+		state.lazy_entries->push_back({ &entry, state.depth, state.path });
+	else
+		load_resource_directory_entry_contents(instance, options, resource_dir_rva, entry, state);
+
+	return true;
+}
+
+void load_resource_directory_entry_contents(const image::image& instance,
+	const loader_options& options, safe_rva_type resource_dir_rva,
+	resource_directory_entry_details& entry, loader_state& state)
+{
+	const auto& entry_descriptor = entry.get_descriptor();
 	if (entry_descriptor->offset_to_data_or_directory
 		& detail::resources::data_is_directory_flag)
 	{
@@ -196,19 +254,40 @@ bool load_resource_directory_entry(const image::image& instance, const loader_op
 				resource_directory_details>();
 			directory.add_error(
 				resource_directory_loader_errc::invalid_resource_directory);
-			return true;
+			return;
 		}
 
-		if (!visited_directories.emplace(dir_rva.value()).second)
+		if (is_on_path(state, dir_rva.value())
+			|| (state.loaded_directories
+				&& state.loaded_directories->contains(dir_rva.value())))
 		{
 			entry.get_data_or_directory().emplace<rva_type>(dir_rva.value());
 		}
+		else if (state.depth == options.max_depth)
+		{
+			auto& directory = entry.get_data_or_directory().emplace<
+				resource_directory_details>();
+			directory.add_error(
+				resource_directory_loader_errc::too_deep_directory_tree);
+		}
 		else
 		{
+			if (state.loaded_directories)
+				state.loaded_directories->emplace(dir_rva.value());
+
+			const auto parent = state.path;
+			state.path = state.paths.size();
+			state.paths.emplace_back(dir_rva.value(), parent);
+			++state.depth;
 			load_resource_directory(instance, options,
-				resource_dir_rva, dir_rva, max_rva,
+				resource_dir_rva, dir_rva,
 				entry.get_data_or_directory().emplace<resource_directory_details>(),
-				visited_directories);
+				state);
+			--state.depth;
+			state.path = parent;
+			//Lazy entries keep references to their paths
+			if (!state.lazy_entries)
+				state.paths.pop_back();
 		}
 	}
 	else
@@ -220,7 +299,7 @@ bool load_resource_directory_entry(const image::image& instance, const loader_op
 			auto data_entry_rva = resource_dir_rva
 				+ entry_descriptor->offset_to_data_or_directory;
 			load_resource_data_entry(instance, options,
-				data_entry_rva, max_rva, data_entry);
+				data_entry_rva, state.max_rva, data_entry);
 		}
 		catch (const std::system_error&)
 		{
@@ -228,18 +307,12 @@ bool load_resource_directory_entry(const image::image& instance, const loader_op
 				resource_directory_loader_errc::invalid_resource_data_entry);
 		}
 	}
-
-	return true;
 }
 
 void load_resource_directory(const image::image& instance, const loader_options& options,
-	safe_rva_type resource_dir_rva, safe_rva_type current_rva, std::uint64_t& max_rva,
-	resource_directory_details& directory, visited_directories_set& visited_directories)
+	safe_rva_type resource_dir_rva, safe_rva_type current_rva,
+	resource_directory_details& directory, loader_state& state)
 {
-	utilities::scoped_guard guard([&visited_directories, current_rva] {
-		visited_directories.erase(current_rva.value());
-	});
-
 	auto& descriptor = directory.get_descriptor();
 	try
 	{
@@ -254,7 +327,7 @@ void load_resource_directory(const image::image& instance, const loader_options&
 		return;
 	}
 
-	max_rva = (std::max<std::uint64_t>)(max_rva, current_rva.value());
+	state.max_rva = (std::max<std::uint64_t>)(state.max_rva, current_rva.value());
 
 	std::uint32_t entry_count = descriptor->number_of_named_entries;
 	if (!utilities::math::add_if_safe<std::uint32_t>(entry_count,
@@ -266,11 +339,20 @@ void load_resource_directory(const image::image& instance, const loader_options&
 	}
 
 	std::uint32_t number_of_named_entries = 0;
+	directory.get_entries().reserve((std::min)(entry_count, state.remaining_entries));
 	for (std::uint32_t i = 0; i != entry_count; ++i)
 	{
+		if (!state.remaining_entries)
+		{
+			directory.add_error(
+				resource_directory_loader_errc::too_many_entries);
+			break;
+		}
+		--state.remaining_entries;
+
 		auto& entry = directory.get_entries().emplace_back();
 		if (!load_resource_directory_entry(instance, options, resource_dir_rva,
-			current_rva, max_rva, entry, visited_directories))
+			current_rva, entry, state))
 		{
 			break;
 		}
@@ -290,15 +372,22 @@ void load_resource_directory(const image::image& instance, const loader_options&
 		}
 	}
 
-	if (!is_sorted(directory.get_entries()))
+	const auto& entries = std::as_const(directory).get_entries();
+	if (!directory.has_sorted_entries())
 	{
 		directory.add_error(
 			resource_directory_loader_errc::unsorted_entries);
 	}
-	else if (has_duplicates(directory.get_entries()))
+	else
 	{
-		directory.add_error(
-			resource_directory_loader_errc::duplicate_entries);
+		//Whether entries with unreadable names are in order is unknown,
+		//such directories are searched linearly
+		directory.set_sorted(has_names_and_ids(entries));
+		if (has_duplicates(entries))
+		{
+			directory.add_error(
+				resource_directory_loader_errc::duplicate_entries);
+		}
 	}
 
 	if (number_of_named_entries != descriptor->number_of_named_entries)
@@ -307,7 +396,7 @@ void load_resource_directory(const image::image& instance, const loader_options&
 			resource_directory_loader_errc::invalid_number_of_named_and_id_entries);
 	}
 
-	max_rva = (std::max<std::uint64_t>)(max_rva, current_rva.value());
+	state.max_rva = (std::max<std::uint64_t>)(state.max_rva, current_rva.value());
 }
 
 } //namespace
@@ -336,10 +425,20 @@ std::optional<resource_directory_details> load(const image::image& instance,
 	if (!utilities::math::add_if_safe(last_rva, resource_dir_info->size))
 		directory.add_error(resource_directory_loader_errc::invalid_directory_size);
 
-	visited_directories_set visited_directories{ resource_dir_info->virtual_address };
+	directory_path_list paths{ { resource_dir_info->virtual_address, no_parent } };
+	std::unordered_set<rva_type> loaded_directories;
+	auto remaining_entries = options.max_total_entries;
 	std::uint64_t max_rva = resource_dir_info->virtual_address;
+	loader_state state{
+		.paths = paths,
+		.path = 0u,
+		.loaded_directories = options.load_shared_directories_once
+			? &loaded_directories : nullptr,
+		.remaining_entries = remaining_entries,
+		.max_rva = max_rva
+	};
 	load_resource_directory(instance, options, resource_dir_info->virtual_address,
-		resource_dir_info->virtual_address, max_rva, directory, visited_directories);
+		resource_dir_info->virtual_address, directory, state);
 
 	if (max_rva > last_rva)
 		directory.add_error(resource_directory_loader_errc::invalid_directory_size);
@@ -347,4 +446,118 @@ std::optional<resource_directory_details> load(const image::image& instance,
 	return result;
 }
 
+lazy_resource_directory::lazy_resource_directory(const image::image& instance,
+	const loader_options& options)
+	: instance_(instance)
+	, options_(options)
+	, remaining_entries_(options.max_total_entries)
+{
+	const auto& resource_dir_info = instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::resource);
+
+	resource_dir_rva_ = resource_dir_info->virtual_address;
+	last_rva_ = static_cast<std::uint64_t>(resource_dir_rva_) + resource_dir_info->size;
+	if (last_rva_ > (std::numeric_limits<rva_type>::max)())
+		root_.add_error(resource_directory_loader_errc::invalid_directory_size);
+
+	directory_paths_.emplace_back(resource_dir_rva_, no_parent);
+	max_rva_ = resource_dir_rva_;
+	load_directory(resource_dir_rva_, root_, 0u);
+}
+
+void lazy_resource_directory::load_directory(rva_type rva,
+	resource_directory_details& directory, std::uint32_t depth)
+{
+	std::vector<lazy_entry> lazy_entries;
+	loader_state state{
+		.paths = directory_paths_,
+		.path = 0u,
+		.loaded_directories = options_.load_shared_directories_once
+			? &loaded_directories_ : nullptr,
+		.remaining_entries = remaining_entries_,
+		.max_rva = max_rva_,
+		.depth = depth,
+		.lazy_entries = &lazy_entries
+	};
+	load_resource_directory(instance_, options_, resource_dir_rva_,
+		rva, directory, state);
+	check_size();
+
+	for (const auto& [entry, entry_depth, path] : lazy_entries)
+		pending_entries_.emplace(entry, pending_entry{ entry, entry_depth, path });
+}
+
+void lazy_resource_directory::check_size()
+{
+	if (max_rva_ > last_rva_
+		&& !root_.has_error(resource_directory_loader_errc::invalid_directory_size))
+	{
+		root_.add_error(resource_directory_loader_errc::invalid_directory_size);
+	}
+}
+
+const resource_directory_entry_details::data_or_directory_type&
+	lazy_resource_directory::resolve(const resource_directory_entry_details& entry)
+{
+	auto it = pending_entries_.find(&entry);
+	if (it == pending_entries_.end())
+		return entry.get_data_or_directory();
+
+	auto [pending, depth, path] = it->second;
+	pending_entries_.erase(it);
+
+	std::vector<lazy_entry> lazy_entries;
+	loader_state state{
+		.paths = directory_paths_,
+		.path = path,
+		.loaded_directories = options_.load_shared_directories_once
+			? &loaded_directories_ : nullptr,
+		.remaining_entries = remaining_entries_,
+		.max_rva = max_rva_,
+		.depth = depth,
+		.lazy_entries = &lazy_entries
+	};
+	load_resource_directory_entry_contents(instance_, options_,
+		resource_dir_rva_, *pending, state);
+	check_size();
+
+	for (const auto& [child, child_depth, child_path] : lazy_entries)
+	{
+		pending_entries_.emplace(child,
+			pending_entry{ child, child_depth, child_path });
+	}
+
+	return entry.get_data_or_directory();
+}
+
+const resource_directory_details& lazy_resource_directory::get_directory(
+	const resource_directory_entry_details& entry)
+{
+	(void)resolve(entry);
+	return entry.get_directory();
+}
+
+const resource_data_entry_details& lazy_resource_directory::get_data(
+	const resource_directory_entry_details& entry)
+{
+	(void)resolve(entry);
+	return entry.get_data();
+}
+
+const resource_directory_details& lazy_resource_directory::resolve_all()
+{
+	while (!pending_entries_.empty())
+		(void)resolve(*pending_entries_.begin()->first);
+	return root_;
+}
+
+std::optional<lazy_resource_directory> load_lazy(const image::image& instance,
+	const loader_options& options)
+{
+	std::optional<lazy_resource_directory> result;
+	if (instance.get_data_directories().has_resources())
+		result.emplace(instance, options);
+	return result;
+}
+
 } //namespace pe_bliss::resources
@@ -0,0 +1,238 @@
+#include "pe_bliss2/resources/resource_index.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+#include "pe_bliss2/error_list.h"
+
+namespace
+{
+
+template<typename Entry>
+auto to_tuple(const Entry& entry) noexcept
+{
+	return std::tie(entry.type, entry.name_or_id, entry.language);
+}
+
+template<typename NameOrId>
+struct type_less
+{
+	template<typename Entry>
+	bool operator()(const Entry& entry, const NameOrId& type) const noexcept
+	{
+		return entry.type < type;
+	}
+
+	template<typename Entry>
+	bool operator()(const NameOrId& type, const Entry& entry) const noexcept
+	{
+		return type < entry.type;
+	}
+};
+
+template<typename NameOrId>
+struct type_name_less
+{
+	template<typename Entry>
+	bool operator()(const Entry& entry, const NameOrId& key) const noexcept
+	{
+		return std::tie(entry.type, entry.name_or_id) < std::tie(key.first, key.second);
+	}
+
+	template<typename Entry>
+	bool operator()(const NameOrId& key, const Entry& entry) const noexcept
+	{
+		return std::tie(key.first, key.second) < std::tie(entry.type, entry.name_or_id);
+	}
+};
+
+} //namespace
+
+namespace pe_bliss::resources
+{
+
+template<typename... Bases>
+std::size_t resource_index_base<Bases...>::key_hash::operator()(
+	const key_type& key) const noexcept
+{
+	auto hash = std::hash<name_or_id_type>{}(key.name_or_id);
+	hash ^= std::hash<name_or_id_type>{}(key.type)
+		+ 0x9e3779b9u + (hash << 6u) + (hash >> 2u);
+	hash ^= std::hash<resource_id_type>{}(key.language)
+		+ 0x9e3779b9u + (hash << 6u) + (hash >> 2u);
+	return hash;
+}
+
+template<typename... Bases>
+resource_index_base<Bases...>::resource_index_base(const directory_type& root)
+{
+	for (const auto& type_entry : root.get_entries())
+	{
+		if (!type_entry.has_directory())
+			continue;
+
+		name_or_id_type type;
+		if (type_entry.has_id())
+			type = type_entry.get_id();
+		else if (type_entry.is_named())
+			type = std::u16string_view(type_entry.get_name().value());
+		else
+			continue;
+
+		for (const auto& name_id_entry : type_entry.get_directory().get_entries())
+		{
+			if (!name_id_entry.has_directory())
+				continue;
+
+			name_or_id_type name_or_id;
+			if (name_id_entry.has_id())
+				name_or_id = name_id_entry.get_id();
+			else if (name_id_entry.is_named())
+				name_or_id = std::u16string_view(name_id_entry.get_name().value());
+			else
+				continue;
+
+			for (const auto& language_entry
+				: name_id_entry.get_directory().get_entries())
+			{
+				if (!language_entry.has_id() || !language_entry.has_data())
+					continue;
+
+				entries_.push_back({ .type = type,
+					.name_or_id = name_or_id,
+					.language = language_entry.get_id(),
+					.data = &language_entry.get_data() });
+			}
+		}
+	}
+
+	std::stable_sort(entries_.begin(), entries_.end(),
+		[](const entry_type& l, const entry_type& r) {
+			return to_tuple(l) < to_tuple(r);
+		});
+
+	lookup_.reserve(entries_.size());
+	for (const auto& entry : entries_)
+	{
+		lookup_.try_emplace({ entry.type, entry.name_or_id, entry.language },
+			entry.data);
+	}
+}
+
+template<typename... Bases>
+const typename resource_index_base<Bases...>::data_entry_type*
+	resource_index_base<Bases...>::find(const key_type& key) const noexcept
+{
+	auto it = lookup_.find(key);
+	return it == lookup_.end() ? nullptr : it->second;
+}
+
+template<typename... Bases>
+const typename resource_index_base<Bases...>::data_entry_type*
+	resource_index_base<Bases...>::find(resource_type type, resource_id_type id,
+		resource_id_type language) const noexcept
+{
+	return find({ static_cast<resource_id_type>(type), id, language });
+}
+
+template<typename... Bases>
+const typename resource_index_base<Bases...>::data_entry_type*
+	resource_index_base<Bases...>::find(resource_type type, std::u16string_view name,
+		resource_id_type language) const noexcept
+{
+	return find({ static_cast<resource_id_type>(type), name, language });
+}
+
+template<typename... Bases>
+const typename resource_index_base<Bases...>::data_entry_type*
+	resource_index_base<Bases...>::find(std::u16string_view type_name,
+		resource_id_type id, resource_id_type language) const noexcept
+{
+	return find({ type_name, id, language });
+}
+
+template<typename... Bases>
+const typename resource_index_base<Bases...>::data_entry_type*
+	resource_index_base<Bases...>::find(std::u16string_view type_name,
+		std::u16string_view name, resource_id_type language) const noexcept
+{
+	return find({ type_name, name, language });
+}
+
+template<typename... Bases>
+typename resource_index_base<Bases...>::entry_range_type
+	resource_index_base<Bases...>::find_all(const name_or_id_type& type,
+		const name_or_id_type* name_or_id) const noexcept
+{
+	std::pair<typename entry_list_type::const_iterator,
+		typename entry_list_type::const_iterator> range;
+	if (name_or_id)
+	{
+		using key = std::pair<name_or_id_type, name_or_id_type>;
+		range = std::equal_range(entries_.cbegin(), entries_.cend(),
+			key{ type, *name_or_id }, type_name_less<key>{});
+	}
+	else
+	{
+		range = std::equal_range(entries_.cbegin(), entries_.cend(),
+			type, type_less<name_or_id_type>{});
+	}
+	return { range.first, range.second };
+}
+
+template<typename... Bases>
+typename resource_index_base<Bases...>::entry_range_type
+	resource_index_base<Bases...>::find_all(resource_type type) const noexcept
+{
+	return find_all(name_or_id_type(static_cast<resource_id_type>(type)), nullptr);
+}
+
+template<typename... Bases>
+typename resource_index_base<Bases...>::entry_range_type
+	resource_index_base<Bases...>::find_all(resource_type type,
+		resource_id_type id) const noexcept
+{
+	name_or_id_type name_or_id(id);
+	return find_all(name_or_id_type(static_cast<resource_id_type>(type)), &name_or_id);
+}
+
+template<typename... Bases>
+typename resource_index_base<Bases...>::entry_range_type
+	resource_index_base<Bases...>::find_all(resource_type type,
+		std::u16string_view name) const noexcept
+{
+	name_or_id_type name_or_id(name);
+	return find_all(name_or_id_type(static_cast<resource_id_type>(type)), &name_or_id);
+}
+
+template<typename... Bases>
+typename resource_index_base<Bases...>::entry_range_type
+	resource_index_base<Bases...>::find_all(
+		std::u16string_view type_name) const noexcept
+{
+	return find_all(name_or_id_type(type_name), nullptr);
+}
+
+template<typename... Bases>
+typename resource_index_base<Bases...>::entry_range_type
+	resource_index_base<Bases...>::find_all(std::u16string_view type_name,
+		resource_id_type id) const noexcept
+{
+	name_or_id_type name_or_id(id);
+	return find_all(name_or_id_type(type_name), &name_or_id);
+}
+
+template<typename... Bases>
+typename resource_index_base<Bases...>::entry_range_type
+	resource_index_base<Bases...>::find_all(std::u16string_view type_name,
+		std::u16string_view name) const noexcept
+{
+	name_or_id_type name_or_id(name);
+	return find_all(name_or_id_type(type_name), &name_or_id);
+}
+
+template class resource_index_base<>;
+template class resource_index_base<error_list>;
+
+} //namespace pe_bliss::resources
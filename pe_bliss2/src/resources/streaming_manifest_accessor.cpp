@@ -0,0 +1,762 @@
+#include "pe_bliss2/resources/streaming_manifest_accessor.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "pe_bliss2/pe_error.h"
+#include "utilities/string.h"
+
+namespace pe_bliss::resources::streaming
+{
+
+namespace impl
+{
+struct streaming_manifest_accessor_impl;
+} //namespace impl
+
+namespace
+{
+
+constexpr std::uint32_t npos = (std::numeric_limits<std::uint32_t>::max)();
+
+class attribute_impl final : public manifest_named_entity_interface
+{
+public:
+	attribute_impl(std::string_view ns, std::string_view name,
+		std::string_view value) noexcept
+		: ns_(ns)
+		, name_(name)
+		, value_(value)
+	{
+	}
+
+	virtual std::string_view get_name() const override
+	{
+		return name_;
+	}
+
+	virtual std::string_view get_namespace() const override
+	{
+		return ns_;
+	}
+
+	virtual std::string_view get_value() const override
+	{
+		return value_;
+	}
+
+private:
+	std::string_view ns_;
+	std::string_view name_;
+	std::string_view value_;
+};
+
+class node_impl;
+
+struct document
+{
+	std::vector<node_impl> nodes;
+	std::vector<attribute_impl> attributes;
+};
+
+class node_iterator_impl final : public manifest_node_iterator_interface
+{
+public:
+	node_iterator_impl(const document& doc, std::uint32_t first_child) noexcept
+		: doc_(doc)
+		, first_child_(first_child)
+	{
+	}
+
+	virtual const manifest_node_interface* first_child(
+		std::string_view ns_name, std::string_view name) override;
+
+	virtual const manifest_node_interface* next_child() override;
+
+private:
+	const manifest_node_interface* find(std::uint32_t from);
+
+private:
+	const document& doc_;
+	std::uint32_t first_child_;
+	std::uint32_t current_ = npos;
+	std::string_view ns_;
+	std::string_view name_;
+};
+
+class node_impl final : public manifest_node_interface
+{
+public:
+	node_impl(const document& doc, std::string_view ns,
+		std::string_view name, std::size_t index) noexcept
+		: doc_(&doc)
+		, ns_(ns)
+		, name_(name)
+		, index_(index)
+	{
+	}
+
+	virtual std::string_view get_name() const override
+	{
+		return name_;
+	}
+
+	virtual std::string_view get_namespace() const override
+	{
+		return ns_;
+	}
+
+	virtual std::string_view get_value() const override
+	{
+		return value_;
+	}
+
+	virtual std::size_t get_child_count() const override
+	{
+		return child_count_;
+	}
+
+	virtual std::size_t get_node_index() const noexcept override
+	{
+		return index_;
+	}
+
+	virtual manifest_node_iterator_interface_ptr get_iterator() const override
+	{
+		return std::make_unique<node_iterator_impl>(*doc_, first_child_);
+	}
+
+	virtual const manifest_named_entity_interface* get_attribute(
+		std::string_view ns_name, std::string_view name) const override
+	{
+		for (std::uint32_t i = first_attribute_,
+			end = first_attribute_ + attribute_count_; i != end; ++i)
+		{
+			const auto& attr = doc_->attributes[i];
+			if (attr.get_name() == name && attr.get_namespace() == ns_name)
+				return &attr;
+		}
+		return nullptr;
+	}
+
+private:
+	friend class node_iterator_impl;
+	friend class xml_parser;
+
+	const document* doc_;
+	std::string_view ns_;
+	std::string_view name_;
+	std::string_view value_;
+	std::size_t index_{};
+	std::size_t child_count_{};
+	std::uint32_t first_child_ = npos;
+	std::uint32_t next_sibling_ = npos;
+	std::uint32_t first_attribute_{};
+	std::uint32_t attribute_count_{};
+	bool has_value_ = false;
+};
+
+const manifest_node_interface* node_iterator_impl::find(std::uint32_t from)
+{
+	for (current_ = from; current_ != npos;
+		current_ = doc_.nodes[current_].next_sibling_)
+	{
+		const auto& node = doc_.nodes[current_];
+		if (node.name_ == name_ && node.ns_ == ns_)
+			return &node;
+	}
+	return nullptr;
+}
+
+const manifest_node_interface* node_iterator_impl::first_child(
+	std::string_view ns_name, std::string_view name)
+{
+	ns_ = ns_name;
+	name_ = name;
+	return find(first_child_);
+}
+
+const manifest_node_interface* node_iterator_impl::next_child()
+{
+	if (current_ == npos)
+		return nullptr;
+
+	return find(doc_.nodes[current_].next_sibling_);
+}
+
+[[noreturn]] void throw_invalid_xml()
+{
+	throw pe_error(manifest_loader_errc::invalid_xml);
+}
+
+[[nodiscard]] constexpr bool is_space(char ch) noexcept
+{
+	return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+[[nodiscard]] constexpr bool is_name_end(char ch) noexcept
+{
+	return is_space(ch) || ch == '/' || ch == '>' || ch == '=';
+}
+
+//Single forward pass over the manifest text. Text and attribute
+//values are decoded in place, the decoded value is never longer
+//than the source.
+class xml_parser
+{
+public:
+	xml_parser(char* begin, char* end, document& doc, error_list& errors) noexcept
+		: pos_(begin)
+		, end_(end)
+		, doc_(doc)
+		, errors_(errors)
+	{
+	}
+
+	void parse()
+	{
+		static constexpr std::string_view utf8_bom("\xef\xbb\xbf");
+		if (std::string_view(pos_, end_).starts_with(utf8_bom))
+			pos_ += utf8_bom.size();
+
+		auto markup_count = std::count(pos_, end_, '<');
+		doc_.nodes.reserve(markup_count + 1u);
+		doc_.attributes.reserve(std::count(pos_, end_, '='));
+
+		doc_.nodes.emplace_back(doc_, std::string_view{}, std::string_view{}, 0u);
+		open_elements_.emplace_back();
+
+		bool has_declaration = false, has_children = false;
+		while (pos_ != end_)
+		{
+			if (*pos_ != '<')
+			{
+				has_children |= parse_text();
+				continue;
+			}
+
+			std::string_view rest(pos_, end_);
+			if (rest.starts_with("<!--"))
+			{
+				skip_past("-->");
+				has_children = true;
+			}
+			else if (rest.starts_with("<![CDATA["))
+			{
+				pos_ += 9u;
+				auto* text_begin = pos_;
+				skip_past("]]>");
+				set_value(text_begin, decode_text(text_begin, pos_ - 3u, text_type::cdata));
+				has_children = true;
+			}
+			else if (rest.starts_with("<?"))
+			{
+				//Only the XML declaration is allowed,
+				//like in pugixml_manifest_accessor
+				auto name = rest.substr(2u, 4u);
+				if (name.size() != 4u || !name.starts_with("xml")
+					|| !(is_space(name[3]) || name[3] == '?')
+					|| open_elements_.size() != 1u || has_declaration || has_children)
+				{
+					throw_invalid_xml();
+				}
+				skip_past("?>");
+				has_declaration = has_children = true;
+			}
+			else if (rest.starts_with("<!") || open_elements_.empty())
+			{
+				//DOCTYPE (rejected like in pugixml_manifest_accessor)
+				//and markup after the closed document
+				throw_invalid_xml();
+			}
+			else if (rest.starts_with("</"))
+			{
+				parse_end_tag();
+			}
+			else
+			{
+				parse_start_tag();
+				has_children = true;
+			}
+		}
+
+		if (open_elements_.size() != 1u)
+			throw_invalid_xml();
+
+		if (doc_.nodes.front().child_count_ != 1u)
+			throw_invalid_xml();
+
+		if (!has_declaration)
+			errors_.add_error(manifest_loader_errc::absent_declaration);
+	}
+
+private:
+	enum class text_type
+	{
+		pcdata,
+		cdata,
+		attribute
+	};
+
+	struct open_element
+	{
+		std::uint32_t node{};
+		std::uint32_t last_child = npos;
+		std::string_view qualified_name;
+		std::size_t binding_count{};
+		bool has_default_namespace = false;
+	};
+
+	struct raw_attribute
+	{
+		std::string_view name;
+		std::string_view value;
+	};
+
+	struct binding
+	{
+		std::string_view alias;
+		std::string_view ns;
+	};
+
+private:
+	void skip_past(std::string_view terminator)
+	{
+		auto rest = std::string_view(pos_, end_);
+		auto found = rest.find(terminator);
+		if (found == std::string_view::npos)
+			throw_invalid_xml();
+		pos_ += found + terminator.size();
+	}
+
+	void skip_spaces() noexcept
+	{
+		while (pos_ != end_ && is_space(*pos_))
+			++pos_;
+	}
+
+	std::string_view parse_name()
+	{
+		auto* begin = pos_;
+		while (pos_ != end_ && !is_name_end(*pos_))
+			++pos_;
+		if (begin == pos_ || pos_ == end_)
+			throw_invalid_xml();
+		return { begin, static_cast<std::size_t>(pos_ - begin) };
+	}
+
+	bool parse_text()
+	{
+		auto* begin = pos_;
+		while (pos_ != end_ && *pos_ != '<')
+			++pos_;
+
+		if (std::all_of(begin, pos_, is_space))
+			return false;
+
+		set_value(begin, decode_text(begin, pos_, text_type::pcdata));
+		return true;
+	}
+
+	void set_value(char* begin, std::size_t size)
+	{
+		auto& node = doc_.nodes[open_elements_.back().node];
+		if (open_elements_.size() == 1u || node.has_value_)
+			return;
+
+		node.value_ = { begin, size };
+		node.has_value_ = true;
+	}
+
+	//Decodes entities (except CDATA) and line ends, returns the decoded size
+	static std::size_t decode_text(char* begin, char* end, text_type type)
+	{
+		const bool is_attribute = type == text_type::attribute;
+		auto* out = begin;
+		for (auto* in = begin; in != end;)
+		{
+			if (*in == '\r')
+			{
+				++in;
+				if (in != end && *in == '\n')
+					++in;
+				*out++ = is_attribute ? ' ' : '\n';
+			}
+			else if (*in == '&' && type != text_type::cdata)
+			{
+				in = decode_entity(in, end, out);
+			}
+			else
+			{
+				auto ch = *in++;
+				*out++ = (is_attribute && is_space(ch)) ? ' ' : ch;
+			}
+		}
+		return static_cast<std::size_t>(out - begin);
+	}
+
+	static char* decode_entity(char* in, char* end, char*& out)
+	{
+		auto entity = std::string_view(in, end);
+		auto terminator = entity.find(';');
+		if (terminator == std::string_view::npos)
+		{
+			*out++ = *in;
+			return in + 1;
+		}
+
+		entity = entity.substr(1u, terminator - 1u);
+		char32_t code_point = 0;
+		if (entity == "lt")
+			code_point = '<';
+		else if (entity == "gt")
+			code_point = '>';
+		else if (entity == "amp")
+			code_point = '&';
+		else if (entity == "apos")
+			code_point = '\'';
+		else if (entity == "quot")
+			code_point = '"';
+		else if (!parse_char_reference(entity, code_point))
+		{
+			//Unknown entities are kept as is
+			*out++ = *in;
+			return in + 1;
+		}
+
+		//At most as long as the shortest character reference
+		out = utilities::encode_utf8(code_point, out);
+		return in + terminator + 1u;
+	}
+
+	static bool parse_char_reference(std::string_view entity,
+		char32_t& code_point) noexcept
+	{
+		if (!entity.starts_with('#') || entity.size() < 2u)
+			return false;
+
+		entity.remove_prefix(1u);
+		std::uint32_t base = 10u;
+		if (entity.front() == 'x')
+		{
+			base = 16u;
+			entity.remove_prefix(1u);
+			if (entity.empty())
+				return false;
+		}
+
+		std::uint32_t value = 0;
+		for (auto ch : entity)
+		{
+			std::uint32_t digit;
+			if (ch >= '0' && ch <= '9')
+				digit = ch - '0';
+			else if (base == 16u && ch >= 'a' && ch <= 'f')
+				digit = ch - 'a' + 10u;
+			else if (base == 16u && ch >= 'A' && ch <= 'F')
+				digit = ch - 'A' + 10u;
+			else
+				return false;
+
+			value = value * base + digit;
+			if (value > 0x10ffffu)
+				return false;
+		}
+
+		code_point = value;
+		return true;
+	}
+
+	void parse_start_tag()
+	{
+		++pos_;
+		auto qualified_name = parse_name();
+
+		attributes_.clear();
+		while (true)
+		{
+			skip_spaces();
+			if (pos_ == end_)
+				throw_invalid_xml();
+			if (*pos_ == '/' || *pos_ == '>')
+				break;
+
+			auto name = parse_name();
+			skip_spaces();
+			if (pos_ == end_ || *pos_ != '=')
+				throw_invalid_xml();
+			++pos_;
+			skip_spaces();
+			if (pos_ == end_ || (*pos_ != '"' && *pos_ != '\''))
+				throw_invalid_xml();
+
+			auto quote = *pos_++;
+			auto* value_begin = pos_;
+			while (pos_ != end_ && *pos_ != quote)
+				++pos_;
+			if (pos_ == end_)
+				throw_invalid_xml();
+
+			auto size = decode_text(value_begin, pos_, text_type::attribute);
+			++pos_;
+			attributes_.push_back({ name, { value_begin, size } });
+		}
+
+		bool is_empty = *pos_ == '/';
+		if (is_empty)
+		{
+			++pos_;
+			if (pos_ == end_ || *pos_ != '>')
+				throw_invalid_xml();
+		}
+		++pos_;
+
+		add_element(qualified_name);
+		if (is_empty)
+			close_element();
+	}
+
+	void parse_end_tag()
+	{
+		pos_ += 2u;
+		auto qualified_name = parse_name();
+		skip_spaces();
+		if (pos_ == end_ || *pos_ != '>')
+			throw_invalid_xml();
+		++pos_;
+
+		if (open_elements_.size() == 1u
+			|| open_elements_.back().qualified_name != qualified_name)
+		{
+			throw_invalid_xml();
+		}
+		close_element();
+	}
+
+	void add_element(std::string_view qualified_name)
+	{
+		static constexpr std::string_view xmlns_prefix{ "xmlns:" };
+		static constexpr std::string_view default_ns_attr{ "xmlns" };
+
+		open_element element{ .qualified_name = qualified_name };
+		auto first_binding = bindings_.size();
+		for (const auto& attr : attributes_)
+		{
+			if (attr.name.starts_with(xmlns_prefix))
+			{
+				auto alias = attr.name.substr(xmlns_prefix.size());
+				if (alias.empty() || attr.value.empty())
+					throw_invalid_xml();
+				for (auto i = first_binding; i != bindings_.size(); ++i)
+				{
+					if (bindings_[i].alias == alias)
+						throw_invalid_xml();
+				}
+				bindings_.push_back({ alias, attr.value });
+			}
+			else if (attr.name == default_ns_attr)
+			{
+				if (attr.value.empty() || element.has_default_namespace)
+					throw_invalid_xml();
+				element.has_default_namespace = true;
+				default_namespaces_.push_back(attr.value);
+			}
+		}
+		element.binding_count = bindings_.size() - first_binding;
+
+		auto [ns, name] = resolve_name(qualified_name, true);
+		auto& parent = open_elements_.back();
+		auto& parent_node = doc_.nodes[parent.node];
+		auto index = static_cast<std::uint32_t>(doc_.nodes.size());
+		if (parent.last_child == npos)
+			parent_node.first_child_ = index;
+		else
+			doc_.nodes[parent.last_child].next_sibling_ = index;
+		parent.last_child = index;
+
+		//Document must have a single root element
+		if (open_elements_.size() == 1u && parent_node.child_count_)
+			throw_invalid_xml();
+
+		auto& node = doc_.nodes.emplace_back(doc_, ns, name,
+			doc_.nodes[parent.node].child_count_++);
+		node.first_attribute_ = static_cast<std::uint32_t>(doc_.attributes.size());
+		for (const auto& attr : attributes_)
+		{
+			if (attr.name.starts_with(xmlns_prefix) || attr.name == default_ns_attr)
+				continue;
+
+			auto [attr_ns, attr_name] = resolve_name(attr.name, false);
+			for (auto i = node.first_attribute_; i != doc_.attributes.size(); ++i)
+			{
+				const auto& other = doc_.attributes[i];
+				if (other.get_name() == attr_name && other.get_namespace() == attr_ns)
+					throw_invalid_xml();
+			}
+			doc_.attributes.emplace_back(attr_ns, attr_name, attr.value);
+		}
+		node.attribute_count_ = static_cast<std::uint32_t>(
+			doc_.attributes.size() - node.first_attribute_);
+
+		element.node = index;
+		open_elements_.push_back(element);
+	}
+
+	void close_element() noexcept
+	{
+		const auto& element = open_elements_.back();
+		bindings_.resize(bindings_.size() - element.binding_count);
+		if (element.has_default_namespace)
+			default_namespaces_.pop_back();
+		open_elements_.pop_back();
+	}
+
+	std::pair<std::string_view, std::string_view> resolve_name(
+		std::string_view qualified_name, bool is_element) const
+	{
+		auto ns_pos = qualified_name.find(':');
+		if (ns_pos == std::string_view::npos)
+		{
+			//Attributes do not inherit namespaces
+			return { is_element && !default_namespaces_.empty()
+				? default_namespaces_.back() : std::string_view{}, qualified_name };
+		}
+
+		auto alias = qualified_name.substr(0u, ns_pos);
+		auto name = qualified_name.substr(ns_pos + 1u);
+		if (alias.empty() || name.empty() || name.find(':') != std::string_view::npos)
+			throw_invalid_xml();
+
+		auto it = std::find_if(bindings_.crbegin(), bindings_.crend(),
+			[alias](const binding& b) { return b.alias == alias; });
+		if (it == bindings_.crend())
+			throw_invalid_xml();
+
+		return { it->ns, name };
+	}
+
+private:
+	char* pos_;
+	char* end_;
+	document& doc_;
+	error_list& errors_;
+	std::vector<open_element> open_elements_;
+	std::vector<raw_attribute> attributes_;
+	std::vector<binding> bindings_;
+	std::vector<std::string_view> default_namespaces_;
+};
+
+//Transcodes UTF-16 manifest text, detected by the byte order mark
+//or by the leading "<?" characters, to UTF-8 in place.
+//Returns false if the text is truncated.
+bool transcode_utf16(std::vector<char>& xml_text)
+{
+	static constexpr std::string_view le_bom("\xff\xfe"), be_bom("\xfe\xff");
+	static constexpr std::string_view le_decl("<\0?\0", 4u), be_decl("\0<\0?", 4u);
+
+	std::string_view text(xml_text.data(), xml_text.size());
+	bool is_big_endian = false;
+	if (text.starts_with(be_bom) || text.starts_with(be_decl))
+		is_big_endian = true;
+	else if (!text.starts_with(le_bom) && !text.starts_with(le_decl))
+		return true;
+
+	if (text.size() % sizeof(char16_t))
+		return false;
+
+	std::u16string utf16(text.size() / sizeof(char16_t), u'\0');
+	for (std::size_t i = 0; i != utf16.size(); ++i)
+	{
+		auto first = static_cast<std::uint8_t>(text[i * 2u]);
+		auto second = static_cast<std::uint8_t>(text[i * 2u + 1u]);
+		utf16[i] = static_cast<char16_t>(is_big_endian
+			? (first << 8u) | second : (second << 8u) | first);
+	}
+
+	//The byte order mark is transcoded to the UTF-8 one,
+	//which is skipped by the parser
+	std::string utf8;
+	utf8.reserve(utf16.size() + utf16.size() / 2u);
+	utilities::append_utf8(utf16, utf8);
+	xml_text.assign(utf8.begin(), utf8.end());
+	return true;
+}
+
+} //namespace
+
+namespace impl
+{
+struct streaming_manifest_accessor_impl
+{
+	std::vector<char> xml_text;
+	document doc;
+
+	bool parse(const buffers::input_buffer_ptr& buffer, error_list& errors)
+	{
+		try
+		{
+			xml_text.resize(buffer->physical_size());
+			buffer->read(0, xml_text.size(),
+				reinterpret_cast<std::byte*>(xml_text.data()));
+		}
+		catch (const std::system_error&)
+		{
+			errors.add_error(manifest_loader_errc::invalid_xml);
+			return false;
+		}
+
+		if (!transcode_utf16(xml_text))
+		{
+			errors.add_error(manifest_loader_errc::invalid_xml);
+			return false;
+		}
+
+		try
+		{
+			xml_parser(xml_text.data(), xml_text.data() + xml_text.size(),
+				doc, errors).parse();
+		}
+		catch (const pe_error& e)
+		{
+			errors.add_error(e.code());
+			return false;
+		}
+
+		return true;
+	}
+};
+} //namespace impl
+
+streaming_manifest_accessor::streaming_manifest_accessor(
+	const buffers::input_buffer_ptr& buffer)
+	: impl_(std::make_unique<impl::streaming_manifest_accessor_impl>())
+{
+	if (!impl_->parse(buffer, errors_))
+		impl_.reset();
+}
+
+streaming_manifest_accessor::~streaming_manifest_accessor() = default;
+
+const manifest_node_interface* streaming_manifest_accessor::get_root() const
+{
+	if (!impl_)
+		return nullptr;
+
+	return &impl_->doc.nodes.front();
+}
+
+manifest_accessor_interface_ptr parse_manifest(
+	const buffers::input_buffer_ptr& buffer)
+{
+	return std::make_shared<streaming_manifest_accessor>(buffer);
+}
+
+} //namespace pe_bliss::resources::streaming
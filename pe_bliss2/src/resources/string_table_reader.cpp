@@ -1,11 +1,85 @@
 #include "pe_bliss2/resources/string_table_reader.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <system_error>
+#include <tuple>
+#include <variant>
+
+#include <boost/endian/conversion.hpp>
 
 #include "buffers/input_buffer_stateful_wrapper.h"
+#include "buffers/ref_buffer.h"
+#include "pe_bliss2/error_list.h"
 #include "pe_bliss2/pe_error.h"
+#include "pe_bliss2/resources/resource_reader.h"
 #include "pe_bliss2/resources/resource_reader_errc.h"
 #include "pe_bliss2/resources/string_table.h"
+#include "utilities/string.h"
+
+namespace
+{
+
+using namespace pe_bliss;
+using namespace pe_bliss::resources;
+
+constexpr std::uint32_t max_string_table_id = 0x1000u;
+
+auto entry_key(const string_table_arena::entry_type& entry) noexcept
+{
+	return std::tie(entry.language, entry.string_id);
+}
+
+void read_string_table(const buffers::ref_buffer& data, resource_id_type language,
+	string_table::id_type table_id, const string_tables_read_options& options,
+	string_table_arena& result)
+{
+	auto buffer = data.data();
+	if (!buffer)
+		return;
+
+	buffers::input_buffer_stateful_wrapper_ref buf(*buffer);
+	auto& arena = result.get_utf16_data();
+	for (std::uint8_t i = 0; i != string_table::max_string_count; ++i)
+	{
+		std::uint16_t length{};
+		auto bytes_read = buf.read(sizeof(length), reinterpret_cast<std::byte*>(&length));
+		if (!options.allow_virtual_data && bytes_read != sizeof(length))
+			throw pe_error(resource_reader_errc::buffer_read_error);
+
+		boost::endian::little_to_native_inplace(length);
+		if (!length)
+			continue;
+
+		auto offset = arena.size();
+		arena.resize(offset + length);
+		auto* str = arena.data() + offset;
+		try
+		{
+			bytes_read = buf.read(length * sizeof(char16_t),
+				reinterpret_cast<std::byte*>(str));
+			if (!options.allow_virtual_data && bytes_read != length * sizeof(char16_t))
+				throw pe_error(resource_reader_errc::buffer_read_error);
+		}
+		catch (const std::system_error&)
+		{
+			arena.resize(offset);
+			throw;
+		}
+
+		for (std::uint16_t j = 0; j != length; ++j)
+			boost::endian::little_to_native_inplace(str[j]);
+
+		result.get_entries().push_back({
+			.language = language,
+			.string_id = string_table::table_to_string_id(table_id, i),
+			.offset = static_cast<std::uint32_t>(offset),
+			.length = length
+		});
+	}
+}
+
+} //namespace
 
 namespace pe_bliss::resources
 {
@@ -28,4 +102,111 @@ string_table string_table_from_resource(buffers::input_buffer_stateful_wrapper_r
 	return result;
 }
 
+const string_table_arena::entry_type* string_table_arena::find(
+	string_table::id_type string_id, resource_id_type language) const noexcept
+{
+	entry_type key{ .language = language, .string_id = string_id };
+	auto it = std::lower_bound(entries_.cbegin(), entries_.cend(), key,
+		[](const entry_type& l, const entry_type& r) {
+			return entry_key(l) < entry_key(r);
+		});
+	if (it == entries_.cend() || entry_key(*it) != entry_key(key))
+		return nullptr;
+
+	return &*it;
+}
+
+std::optional<std::u16string_view> string_table_arena::get_string(
+	string_table::id_type string_id, resource_id_type language) const noexcept
+{
+	std::optional<std::u16string_view> result;
+	if (const auto* entry = find(string_id, language); entry)
+		result.emplace(utf16_data_.data() + entry->offset, entry->length);
+	return result;
+}
+
+std::optional<std::string_view> string_table_arena::get_utf8_string(
+	string_table::id_type string_id, resource_id_type language) const noexcept
+{
+	std::optional<std::string_view> result;
+	if (utf8_data_.empty())
+		return result;
+
+	if (const auto* entry = find(string_id, language); entry)
+		result.emplace(utf8_data_.data() + entry->utf8_offset, entry->utf8_length);
+	return result;
+}
+
+template<typename... Bases>
+string_table_arena string_tables_from_resources(
+	const resource_directory_base<Bases...>& root,
+	const string_tables_read_options& options)
+{
+	string_table_arena result;
+
+	std::size_t table_count = 0, data_size = 0;
+	for_each_resource(root, resource_type::string,
+		[&table_count, &data_size](const resource_directory_entry_base<Bases...>&,
+			resource_id_type, const buffers::ref_buffer& data) {
+			++table_count;
+			data_size += data.size();
+			return false;
+		});
+
+	result.get_entries().reserve(table_count * string_table::max_string_count);
+	result.get_utf16_data().reserve(data_size / sizeof(char16_t));
+
+	for_each_resource(root, resource_type::string,
+		[&options, &result](const resource_directory_entry_base<Bases...>& entry,
+			resource_id_type language, const buffers::ref_buffer& data) {
+			const auto* table_id = std::get_if<resource_id_type>(
+				&entry.get_name_or_id());
+			if (!table_id || !*table_id || *table_id > max_string_table_id)
+				return false;
+
+			try
+			{
+				read_string_table(data, language,
+					static_cast<string_table::id_type>(*table_id), options, result);
+			}
+			catch (const std::system_error&)
+			{
+				result.add_error(resource_reader_errc::buffer_read_error, *table_id);
+			}
+			return false;
+		});
+
+	auto& entries = result.get_entries();
+	if (!std::is_sorted(entries.cbegin(), entries.cend(),
+		[](const auto& l, const auto& r) { return entry_key(l) < entry_key(r); }))
+	{
+		std::stable_sort(entries.begin(), entries.end(),
+			[](const auto& l, const auto& r) { return entry_key(l) < entry_key(r); });
+	}
+
+	if (options.decode_utf8)
+	{
+		const auto& utf16_data = result.get_utf16_data();
+		auto& utf8_data = result.get_utf8_data();
+		utf8_data.reserve(utf16_data.size() + utf16_data.size() / 2u);
+		for (auto& entry : entries)
+		{
+			entry.utf8_offset = static_cast<std::uint32_t>(utf8_data.size());
+			utilities::append_utf8({ utf16_data.data() + entry.offset, entry.length },
+				utf8_data);
+			entry.utf8_length = static_cast<std::uint32_t>(
+				utf8_data.size() - entry.utf8_offset);
+		}
+	}
+
+	return result;
+}
+
+template string_table_arena string_tables_from_resources<>(
+	const resource_directory_base<>& root,
+	const string_tables_read_options& options);
+template string_table_arena string_tables_from_resources<error_list>(
+	const resource_directory_base<error_list>& root,
+	const string_tables_read_options& options);
+
 } //namespace pe_bliss::resources
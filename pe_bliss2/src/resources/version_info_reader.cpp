@@ -2,10 +2,18 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <system_error>
+#include <variant>
 
 #include "buffers/input_buffer_section.h"
+#include "buffers/input_buffer_stateful_wrapper.h"
+#include "pe_bliss2/detail/resources/version_info.h"
+#include "pe_bliss2/packed_struct.h"
+#include "pe_bliss2/pe_error.h"
 #include "pe_bliss2/pe_types.h"
+#include "pe_bliss2/resources/resource_directory.h"
+#include "pe_bliss2/resources/resource_directory_loader.h"
 #include "pe_bliss2/resources/resource_reader_errc.h"
 #include "utilities/math.h"
 
@@ -55,6 +63,8 @@ const version_info_reader_error_category version_info_reader_error_category_inst
 using namespace pe_bliss;
 using namespace pe_bliss::resources;
 
+constexpr std::u16string_view root_block_key(u"VS_VERSION_INFO");
+
 bool align_buffer(
 	version_info_block_details& block,
 	buffers::input_buffer_stateful_wrapper& buf,
@@ -279,6 +289,19 @@ bool version_info_from_resource_impl(
 	return true;
 }
 
+template<typename Contents>
+const Contents* get_first_contents(lazy_resource_directory& directory,
+	const resource_directory_details& parent,
+	const std::optional<resource_id_type>& id = {})
+{
+	const auto* entry = id ? parent.try_entry_by_id(*id)
+		: (parent.get_entries().empty() ? nullptr : &parent.get_entries().front());
+	if (!entry)
+		return nullptr;
+
+	return std::get_if<Contents>(&directory.resolve(*entry));
+}
+
 } //namespace
 
 namespace pe_bliss::resources
@@ -300,4 +323,95 @@ version_info_block_details version_info_from_resource(
 	return result;
 }
 
+file_version_info fixed_file_info_from_resource(
+	buffers::input_buffer_stateful_wrapper_ref& buf,
+	bool allow_virtual_data)
+{
+	packed_struct<detail::resources::version_info_block> header;
+	bool is_valid_key = true;
+	try
+	{
+		header.deserialize(buf, allow_virtual_data);
+		for (auto expected : root_block_key)
+		{
+			packed_struct<std::uint16_t> key_char;
+			key_char.deserialize(buf, allow_virtual_data);
+			if (key_char.get() != expected)
+			{
+				is_valid_key = false;
+				break;
+			}
+		}
+
+		if (is_valid_key)
+		{
+			packed_struct<std::uint16_t> null_terminator;
+			null_terminator.deserialize(buf, allow_virtual_data);
+			is_valid_key = !null_terminator.get();
+		}
+	}
+	catch (const std::system_error&)
+	{
+		std::throw_with_nested(pe_error(version_info_reader_errc::key_read_error));
+	}
+
+	if (!is_valid_key)
+		throw pe_error(version_info_errc::incorrect_root_block_key);
+
+	if (header->type != detail::resources::version_info_block_value_type_binary
+		|| header->value_length < file_version_info::descriptor_type::packed_size)
+	{
+		throw pe_error(version_info_errc::absent_file_version_info);
+	}
+
+	file_version_info result;
+	try
+	{
+		auto file_offset = buf.get_buffer().absolute_offset() + buf.rpos();
+		auto aligned_file_offset = file_offset;
+		if (!utilities::math::align_up_if_safe(aligned_file_offset, sizeof(std::uint32_t)))
+			throw pe_error(resource_reader_errc::buffer_read_error);
+
+		buf.advance_rpos(static_cast<std::int32_t>(aligned_file_offset - file_offset));
+		result.get_descriptor().deserialize(buf, allow_virtual_data);
+	}
+	catch (const std::system_error&)
+	{
+		std::throw_with_nested(pe_error(version_info_errc::file_version_info_read_error));
+	}
+
+	return result;
+}
+
+std::optional<file_version_info> read_fixed_file_info(
+	const image::image& instance,
+	const fixed_file_info_read_options& options)
+{
+	std::optional<file_version_info> result;
+	auto directory = load_lazy(instance, {
+		.include_headers = options.include_headers,
+		.allow_virtual_data = options.allow_virtual_data });
+	if (!directory)
+		return result;
+
+	const auto* names = get_first_contents<resource_directory_details>(*directory,
+		directory->get_root(), static_cast<resource_id_type>(resource_type::version));
+	if (!names)
+		return result;
+
+	const auto* languages = get_first_contents<resource_directory_details>(
+		*directory, *names);
+	if (!languages)
+		return result;
+
+	const auto* data = get_first_contents<resource_data_entry_details>(
+		*directory, *languages, options.language);
+	if (!data || !data->get_raw_data().data())
+		return result;
+
+	buffers::input_buffer_stateful_wrapper_ref buf(*data->get_raw_data().data());
+	result.emplace(fixed_file_info_from_resource(buf, options.allow_virtual_data));
+	return result;
+}
+
 } //namespace pe_bliss::resources
@@ -70,3 +70,19 @@ TEST(Arm64ExceptionsLoaderTests, ExceptionLoaderPresentDirectory)
 	auto dir = exceptions::load(instance, {});
 	ensure_directory_loaded(dir);
 }
+
+TEST(Arm64ExceptionsLoaderTests, LazyAbsentDirectory)
+{
+	image::image instance;
+	EXPECT_FALSE(load_lazy(instance, {}));
+}
+
+TEST(Arm64ExceptionsLoaderTests, LazyPresentDirectory)
+{
+	auto instance = prepare_image();
+	auto dir = load_lazy(instance, {});
+	ASSERT_TRUE(dir);
+	EXPECT_TRUE(dir->empty());
+	expect_contains_errors(*dir,
+		exceptions::arm_common::exception_directory_loader_errc::unmatched_directory_size);
+}
@@ -5,11 +5,13 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <variant>
 #include <vector>
 
 #include "pe_bliss2/exceptions/arm_common/arm_common_unwind_info.h"
 #include "pe_bliss2/exceptions/arm_common/arm_common_exception_directory_loader.h"
+#include "pe_bliss2/exceptions/lazy_exception_directory.h"
 
 #include "tests/pe_bliss2/image_helper.h"
 #include "tests/pe_bliss2/pe_error_helper.h"
@@ -91,6 +93,24 @@ private:
 	exception_directory_list_type directories_;
 };
 
+struct lazy_loader_options
+{
+	static exception_directory_info get_exception_directory(
+		const image::image& /* instance */, const lazy_loader_options& options)
+	{
+		return { .rva = options.directory_rva, .size = options.directory_size };
+	}
+
+	std::uint32_t directory_rva{};
+	std::uint32_t directory_size{};
+	bool include_headers = false;
+	bool allow_virtual_data = false;
+};
+
+using lazy_exception_directory_type = pe_bliss::exceptions::lazy_exception_directory<
+	runtime_function_base_type<error_list>, lazy_loader_options,
+	exception_directory_loader_errc>;
+
 class ArmCommonExceptionsLoaderTestFixture : public ::testing::Test
 {
 public:
@@ -116,6 +136,18 @@ public:
 				instance, *this, container)));
 	}
 
+	std::optional<lazy_exception_directory_type> load_lazy_dir() const
+	{
+		const lazy_loader_options options{
+			.directory_rva = directory_rva,
+			.directory_size = directory_size,
+			.include_headers = include_headers,
+			.allow_virtual_data = allow_virtual_data
+		};
+		return load_lazy<lazy_loader_options, packed_unwind_data,
+			extended_unwind_record_type, lazy_exception_directory_type>(instance, options);
+	}
+
 	void add_directory()
 	{
 		auto it = instance.get_section_data_list()[0].copied_data().begin();
@@ -386,3 +418,91 @@ TEST_F(ArmCommonExceptionsLoaderTestFixture, VirtualPartError)
 	expect_contains_errors(func_list[1],
 		exception_directory_loader_errc::invalid_runtime_function_entry);
 }
+
+TEST_F(ArmCommonExceptionsLoaderTestFixture, LazyAbsentDirectory)
+{
+	EXPECT_FALSE(load_lazy_dir());
+}
+
+TEST_F(ArmCommonExceptionsLoaderTestFixture, LazyInvalidDirectorySize)
+{
+	directory_rva = 100u;
+	directory_size = (std::numeric_limits<std::uint32_t>::max)();
+	auto dir = load_lazy_dir();
+	ASSERT_TRUE(dir);
+	EXPECT_TRUE(dir->empty());
+	expect_contains_errors(*dir,
+		exception_directory_loader_errc::invalid_directory_size);
+}
+
+TEST_F(ArmCommonExceptionsLoaderTestFixture, LazyValidDirectory)
+{
+	directory_rva = runtime_function_rva;
+	directory_size = static_cast<std::uint32_t>(directory_part2.size());
+	add_directory();
+	auto dir = load_lazy_dir();
+	ASSERT_TRUE(dir);
+	expect_contains_errors(*dir);
+	ASSERT_EQ(dir->size(), runtime_function_count);
+	EXPECT_EQ(dir->get_descriptor(0u).unwind_data, extended_record_rva);
+	EXPECT_EQ(dir->get_descriptor(1u).unwind_data, 1u);
+	EXPECT_FALSE(dir->is_decoded(0u));
+
+	const auto& func0 = dir->get_runtime_function(0u);
+	EXPECT_TRUE(dir->is_decoded(0u));
+	EXPECT_FALSE(dir->is_decoded(1u));
+	EXPECT_EQ(func0.get_descriptor().get_state().relative_offset(),
+		runtime_function_rva - section_rva);
+	expect_contains_errors(func0,
+		exception_directory_loader_errc::unordered_epilog_scopes,
+		exception_directory_loader_errc::invalid_exception_handler_rva);
+	const auto* unwind0 = std::get_if<extended_unwind_record_type>(
+		&func0.get_unwind_info());
+	ASSERT_NE(unwind0, nullptr);
+	EXPECT_EQ(unwind0->get_epilog_info_list().size(), extended_epilog_count);
+	EXPECT_EQ(unwind0->get_unwind_code_list().size(), extended_code_words_count);
+	EXPECT_EQ(unwind0->get_exception_handler_rva().get(), exception_handler_rva);
+
+	const auto& func1 = dir->get_runtime_function(1u);
+	expect_contains_errors(func1);
+	const auto* unwind1 = std::get_if<packed_unwind_data>(&func1.get_unwind_info());
+	ASSERT_NE(unwind1, nullptr);
+	EXPECT_EQ(unwind1->unwind_data, 1u);
+}
+
+TEST_F(ArmCommonExceptionsLoaderTestFixture, LazyVirtualPartError)
+{
+	directory_rva = runtime_function_rva;
+	directory_size = static_cast<std::uint32_t>(directory_part2.size());
+	add_directory();
+	//3 last bytes are virtual
+	auto& data = instance.get_section_data_list()[0].copied_data();
+	data.resize(directory_part1.size() + directory_part2.size() - 3u);
+	auto dir = load_lazy_dir();
+	ASSERT_TRUE(dir);
+	expect_contains_errors(*dir,
+		exception_directory_loader_errc::invalid_runtime_function_entry);
+	EXPECT_TRUE(dir->has_error(
+		exception_directory_loader_errc::invalid_runtime_function_entry, 1u));
+	ASSERT_EQ(dir->size(), 1u);
+	EXPECT_TRUE(std::holds_alternative<extended_unwind_record_type>(
+		dir->get_runtime_function(0u).get_unwind_info()));
+}
+
+TEST_F(ArmCommonExceptionsLoaderTestFixture, LazyVirtualPart)
+{
+	directory_rva = runtime_function_rva;
+	directory_size = static_cast<std::uint32_t>(directory_part2.size());
+	add_directory();
+	//3 last bytes are virtual
+	auto& data = instance.get_section_data_list()[0].copied_data();
+	data.resize(directory_part1.size() + directory_part2.size() - 3u);
+	allow_virtual_data = true;
+	auto dir = load_lazy_dir();
+	ASSERT_TRUE(dir);
+	expect_contains_errors(*dir);
+	ASSERT_EQ(dir->size(), runtime_function_count);
+	EXPECT_EQ(dir->get_descriptor(1u).unwind_data, 1u);
+	EXPECT_EQ(dir->get_runtime_function(1u).get_descriptor().physical_size(),
+		dir->get_runtime_function(1u).get_descriptor().data_size() - 3u);
+}
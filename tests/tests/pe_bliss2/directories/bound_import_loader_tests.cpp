@@ -161,6 +161,69 @@ TEST_F(BoundImportLoaderTestFixture, LoadBoundImportDirectory)
 	EXPECT_EQ(entries[1].get_references().size(), module2_forwarders);
 }
 
+TEST_F(BoundImportLoaderTestFixture, LoadLazyBoundImportDirectory)
+{
+	add_bound_import_dir();
+	add_bound_import_descriptor_with_names();
+	auto result = bound_import::load_lazy(instance);
+	ASSERT_TRUE(result);
+	ASSERT_EQ(result->size(), 2u);
+	EXPECT_FALSE(result->is_resolved(0u));
+	EXPECT_TRUE(result->get_list()[0].get_references().empty());
+	expect_contains_errors(result->get_list()[1],
+		bound_import::bound_import_directory_loader_errc::name_offset_overlaps_descriptors);
+
+	auto index = result->find_library("MODULE1");
+	ASSERT_TRUE(index);
+	EXPECT_EQ(*index, 0u);
+
+	const auto& entry = result->get(*index);
+	EXPECT_TRUE(result->is_resolved(0u));
+	EXPECT_FALSE(result->is_resolved(1u));
+	expect_contains_errors(entry);
+	EXPECT_EQ(entry.get_library_name().value(), module1_name);
+	const auto& references = entry.get_references();
+	ASSERT_EQ(references.size(), module1_forwarders);
+	expect_contains_errors(references[0]);
+	expect_contains_errors(references[1]);
+	EXPECT_EQ(references[0].get_library_name().value(), module1_fwd1_name);
+	EXPECT_EQ(references[1].get_library_name().value(), module1_fwd2_name);
+
+	static constexpr std::uint32_t module_entry_size = 8u;
+	const auto& entries = result->resolve_all();
+	EXPECT_EQ(entries[1].get_descriptor().get_state().relative_offset(),
+		(module1_forwarders + 1u) * module_entry_size);
+	EXPECT_EQ(entries[1].get_references().size(), module2_forwarders);
+}
+
+TEST_F(BoundImportLoaderTestFixture, LoadLazyUnreadableReferences)
+{
+	//Library descriptor is the last physical entry of the section,
+	//its forwarder references are virtual
+	static constexpr std::uint32_t dir_offset = section_raw_size - 8u;
+	auto& data = instance.get_section_data_list()[0].copied_data();
+	std::copy(bound_import_dir.begin(), bound_import_dir.begin() + 8u,
+		data.begin() + dir_offset);
+	instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::bound_import).get()
+		= { .virtual_address = section_rva + dir_offset, .size = 0x500u };
+
+	auto eager = bound_import::load(instance);
+	auto lazy = bound_import::load_lazy(instance);
+	ASSERT_TRUE(eager);
+	ASSERT_TRUE(lazy);
+	ASSERT_EQ(eager->size(), 1u);
+	ASSERT_EQ(lazy->size(), eager->size());
+
+	const auto& entry = lazy->get(0u);
+	ASSERT_EQ(entry.get_references().size(), 1u);
+	ASSERT_EQ(eager->at(0).get_references().size(), 1u);
+	expect_contains_errors(entry.get_references()[0],
+		bound_import::bound_import_directory_loader_errc::invalid_bound_import_entry);
+	expect_contains_errors(eager->at(0).get_references()[0],
+		bound_import::bound_import_directory_loader_errc::invalid_bound_import_entry);
+}
+
 TEST_F(BoundImportLoaderTestFixture, LoadVirtualBoundImportDirectoryError)
 {
 	add_virtual_bound_import_dir();
@@ -0,0 +1,126 @@
+#include "pe_bliss2/exceptions/columnar_exception_directory.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::exceptions;
+
+namespace
+{
+x64::runtime_function_details create_x64_function(rva_type begin, rva_type end,
+	rva_type unwind_info)
+{
+	x64::runtime_function_details func;
+	func.get_descriptor()->begin_address = begin;
+	func.get_descriptor()->end_address = end;
+	func.get_descriptor()->unwind_info_address = unwind_info;
+	return func;
+}
+
+std::vector<x64::runtime_function_details> create_x64_list()
+{
+	std::vector<x64::runtime_function_details> list;
+	list.emplace_back(create_x64_function(0x1200u, 0x3000u, 0x8020u));
+	list.emplace_back(create_x64_function(0x1000u, 0x1010u, 0x8000u));
+	//Overlaps with the previous function
+	list.emplace_back(create_x64_function(0x1008u, 0x1100u, 0x8010u));
+	list.emplace_back(create_x64_function(0x5000u, 0x5004u, 0x8030u));
+	return list;
+}
+} //namespace
+
+TEST(ColumnarExceptionDirectoryTests, Empty)
+{
+	x64::columnar_exception_directory_details dir;
+	EXPECT_TRUE(dir.empty());
+	EXPECT_EQ(dir.size(), 0u);
+	EXPECT_EQ(dir.find(0u), std::nullopt);
+	EXPECT_EQ(dir.get_covered_size(), 0u);
+}
+
+TEST(ColumnarExceptionDirectoryTests, X64Columns)
+{
+	x64::columnar_exception_directory_details dir(create_x64_list());
+	ASSERT_EQ(dir.size(), 4u);
+	EXPECT_EQ(std::vector<rva_type>(dir.get_begin_rvas().begin(),
+		dir.get_begin_rvas().end()),
+		(std::vector<rva_type>{ 0x1000u, 0x1008u, 0x1200u, 0x5000u }));
+	EXPECT_EQ(std::vector<rva_type>(dir.get_end_rvas().begin(),
+		dir.get_end_rvas().end()),
+		(std::vector<rva_type>{ 0x1010u, 0x1100u, 0x3000u, 0x5004u }));
+	EXPECT_EQ(std::vector<std::uint32_t>(dir.get_unwind_data().begin(),
+		dir.get_unwind_data().end()),
+		(std::vector<std::uint32_t>{ 0x8000u, 0x8010u, 0x8020u, 0x8030u }));
+
+	const auto& list = dir.get_runtime_function_list();
+	ASSERT_EQ(list.size(), 4u);
+	for (std::size_t i = 0; i != list.size(); ++i)
+	{
+		EXPECT_EQ(list[i].get_descriptor()->begin_address, dir.get_begin_rvas()[i]);
+	}
+}
+
+TEST(ColumnarExceptionDirectoryTests, X64Find)
+{
+	x64::columnar_exception_directory_details dir(create_x64_list());
+	EXPECT_EQ(dir.find(0xfffu), std::nullopt);
+	EXPECT_EQ(dir.find(0x1000u), 0u);
+	EXPECT_EQ(dir.find(0x1008u), 1u);
+	EXPECT_EQ(dir.find(0x10ffu), 1u);
+	EXPECT_EQ(dir.find(0x1100u), std::nullopt);
+	EXPECT_EQ(dir.find(0x2fffu), 2u);
+	EXPECT_EQ(dir.find(0x3000u), std::nullopt);
+	EXPECT_EQ(dir.find(0x5003u), 3u);
+	EXPECT_EQ(dir.find(0xffffffffu), std::nullopt);
+}
+
+TEST(ColumnarExceptionDirectoryTests, X64CoveredSize)
+{
+	x64::columnar_exception_directory_details dir(create_x64_list());
+	EXPECT_EQ(dir.get_covered_size(), 0x100u + 0x1e00u + 0x4u);
+}
+
+TEST(ColumnarExceptionDirectoryTests, Release)
+{
+	x64::columnar_exception_directory_details dir(create_x64_list());
+	auto list = std::move(dir).release();
+	ASSERT_EQ(list.size(), 4u);
+	EXPECT_EQ(list[0].get_descriptor()->begin_address, 0x1000u);
+}
+
+TEST(ColumnarExceptionDirectoryTests, Arm64Columns)
+{
+	std::vector<arm64::runtime_function> list(3u);
+	list[0].get_descriptor()->begin_address = 0x2000u;
+	list[0].get_descriptor()->unwind_data = 0x4000u;
+	list[0].get_unwind_info().emplace<arm64::extended_unwind_record>()
+		.set_function_length(0x100u);
+	list[1].get_descriptor()->begin_address = 0x1000u;
+	//Packed, function length is 0x10 * 4 bytes
+	list[1].get_descriptor()->unwind_data = (0x10u << 2u) | 1u;
+	list[1].get_unwind_info().emplace<arm64::packed_unwind_data>(
+		(0x10u << 2u) | 1u);
+	//No unwind info
+	list[2].get_descriptor()->begin_address = 0x3000u;
+
+	arm64::columnar_exception_directory dir(std::move(list));
+	ASSERT_EQ(dir.size(), 3u);
+	EXPECT_EQ(dir.get_begin_rvas()[0], 0x1000u);
+	EXPECT_EQ(dir.get_end_rvas()[0], 0x1040u);
+	EXPECT_EQ(dir.get_unwind_data()[0], (0x10u << 2u) | 1u);
+	EXPECT_EQ(dir.get_begin_rvas()[1], 0x2000u);
+	EXPECT_EQ(dir.get_end_rvas()[1], 0x2100u);
+	EXPECT_EQ(dir.get_unwind_data()[1], 0x4000u);
+	EXPECT_EQ(dir.get_end_rvas()[2], 0x3000u);
+
+	EXPECT_EQ(dir.find(0x103fu), 0u);
+	EXPECT_EQ(dir.find(0x1040u), std::nullopt);
+	EXPECT_EQ(dir.find(0x20ffu), 1u);
+	EXPECT_EQ(dir.find(0x3000u), std::nullopt);
+	EXPECT_EQ(dir.get_covered_size(), 0x140u);
+}
@@ -0,0 +1,77 @@
+#include "pe_bliss2/relocations/compact_relocation_table.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "pe_bliss2/core/file_header.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::relocations;
+
+TEST(CompactRelocationTableTests, Entry)
+{
+	constexpr compact_relocation_entry entry(0xa123u);
+	EXPECT_EQ(entry.get_type(), relocation_type::dir64);
+	EXPECT_EQ(entry.get_address(), 0x123u);
+	EXPECT_EQ(entry.get_raw_value(), 0xa123u);
+	EXPECT_FALSE(entry.requires_parameter());
+	EXPECT_FALSE(entry.get_param());
+	EXPECT_EQ(entry.get_affected_size_in_bytes(
+		core::file_header::machine_type::amd64), sizeof(std::uint64_t));
+	EXPECT_EQ(entry.apply_to(0x1000u, 0x20u,
+		core::file_header::machine_type::amd64), 0x1020u);
+
+	constexpr compact_relocation_entry highadj(0x4321u, 0x1234u);
+	EXPECT_TRUE(highadj.requires_parameter());
+	ASSERT_TRUE(highadj.get_param());
+	EXPECT_EQ(*highadj.get_param(), 0x1234u);
+}
+
+TEST(CompactRelocationTableTests, Table)
+{
+	compact_relocation_table table;
+	EXPECT_TRUE(table.empty());
+	EXPECT_EQ(table.begin(), table.end());
+
+	constexpr std::array<std::uint16_t, 2u> block1{ 0x3004u, 0x0000u };
+	//highadj with parameter, highadj without parameter
+	constexpr std::array<std::uint16_t, 3u> block2{ 0x4010u, 0x5678u, 0x4020u };
+	table.add_block(0x1000u, block1);
+	table.add_block(0x2000u, {});
+	table.add_block(0x3000u, block2);
+
+	ASSERT_EQ(table.size(), 3u);
+	EXPECT_EQ(table.get_word_count(), block1.size() + block2.size());
+
+	std::vector<rva_type> rvas;
+	for (const auto block : table)
+		rvas.push_back(block.get_virtual_address());
+	EXPECT_EQ(rvas, (std::vector<rva_type>{ 0x1000u, 0x2000u, 0x3000u }));
+
+	auto relocs = table[0].get_relocations();
+	auto it = relocs.begin();
+	ASSERT_NE(it, relocs.end());
+	EXPECT_EQ((*it).get_type(), relocation_type::highlow);
+	EXPECT_EQ((*it).get_address(), 4u);
+	ASSERT_NE(++it, relocs.end());
+	EXPECT_EQ((*it).get_type(), relocation_type::absolute);
+	EXPECT_EQ(++it, relocs.end());
+
+	EXPECT_TRUE(table[1].get_relocations().empty());
+
+	relocs = table[2].get_relocations();
+	it = relocs.begin();
+	ASSERT_NE(it, relocs.end());
+	EXPECT_EQ((*it).get_type(), relocation_type::highadj);
+	EXPECT_EQ((*it).get_address(), 0x10u);
+	ASSERT_TRUE((*it).get_param());
+	EXPECT_EQ(*(*it).get_param(), 0x5678u);
+	ASSERT_NE(++it, relocs.end());
+	EXPECT_EQ((*it).get_address(), 0x20u);
+	EXPECT_FALSE((*it).get_param());
+	EXPECT_EQ(++it, relocs.end());
+}
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <string>
+
+#include "pe_bliss2/core/data_directories.h"
+#include "pe_bliss2/exports/export_directory.h"
+#include "pe_bliss2/exports/export_directory_builder.h"
+#include "pe_bliss2/exports/export_directory_loader.h"
+#include "pe_bliss2/image/image.h"
+
+#include "tests/pe_bliss2/image_helper.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+
+namespace
+{
+constexpr std::uint32_t section_rva = 0x1000u;
+constexpr std::uint32_t directory_rva = 0x1100u;
+constexpr const char library_name[] = "library.dll";
+} //namespace
+
+TEST(ExportDirectoryBuilderTests, BuildNew)
+{
+	auto instance = create_test_image({
+		.start_section_rva = section_rva,
+		.sections = { { 0x2000u, 0x2000u } } });
+
+	exports::export_directory directory;
+	directory.set_library_name(library_name);
+	directory.add(3u, "c", 0x1001u);
+	directory.add(0u, "b", "lib.func");
+	auto& with_two_names = directory.add(1u, "z", 0x1003u);
+	with_two_names.get_names().emplace_back().get_name() = std::string("a");
+	directory.add(5u, 0x1005u);
+
+	auto size = exports::build_new(instance, directory,
+		{ .directory_rva = directory_rva });
+	EXPECT_EQ(size, exports::get_built_size(directory));
+
+	const auto& dir = instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::exports);
+	EXPECT_EQ(dir->virtual_address, directory_rva);
+	EXPECT_EQ(dir->size, size);
+
+	auto loaded = exports::load(instance);
+	ASSERT_TRUE(loaded);
+	expect_contains_errors(*loaded);
+	EXPECT_EQ(loaded->get_library_name().value(), library_name);
+	EXPECT_EQ(loaded->get_descriptor()->number_of_functions, 6u);
+	EXPECT_EQ(loaded->get_descriptor()->number_of_names, 4u);
+
+	const auto& list = loaded->get_export_list();
+	ASSERT_EQ(list.size(), 4u);
+	for (const auto& symbol : list)
+		expect_contains_errors(symbol);
+
+	auto forwarded = loaded->symbol_by_name("b");
+	ASSERT_NE(forwarded, list.end());
+	EXPECT_EQ(forwarded->get_rva_ordinal(), 0u);
+	ASSERT_TRUE(forwarded->get_forwarded_name());
+	EXPECT_EQ(forwarded->get_forwarded_name()->value(), "lib.func");
+
+	auto two_names = loaded->symbol_by_ordinal(1u);
+	ASSERT_NE(two_names, list.end());
+	EXPECT_EQ(two_names->get_rva().get(), 0x1003u);
+	EXPECT_EQ(two_names->get_names().size(), 2u);
+	EXPECT_EQ(loaded->symbol_by_name("a"), two_names);
+	EXPECT_EQ(loaded->symbol_by_name("z"), two_names);
+
+	auto named = loaded->symbol_by_ordinal(3u);
+	ASSERT_NE(named, list.end());
+	EXPECT_EQ(named->get_rva().get(), 0x1001u);
+	EXPECT_EQ(loaded->symbol_by_name("c"), named);
+
+	auto unnamed = loaded->symbol_by_ordinal(5u);
+	ASSERT_NE(unnamed, list.end());
+	EXPECT_EQ(unnamed->get_rva().get(), 0x1005u);
+	EXPECT_TRUE(unnamed->get_names().empty());
+}
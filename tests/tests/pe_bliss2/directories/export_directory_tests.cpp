@@ -79,3 +79,14 @@ TEST(ExportDirectoryTests, ExportDirectoryModification)
 	EXPECT_EQ(dir.get_first_free_ordinal(), 1u);
 	EXPECT_EQ(dir.get_last_free_ordinal(), 4u);
 }
+
+TEST(ExportDirectoryTests, FirstFreeOrdinalWithDuplicates)
+{
+	exports::export_directory dir;
+	dir.add(2u, 0x1000u);
+	dir.add(0u, 0x1000u);
+	dir.add(1u, 0x1000u);
+	dir.add(0u, 0x1000u);
+	dir.add(5u, 0x1000u);
+	EXPECT_EQ(dir.get_first_free_ordinal(), 3u);
+}
@@ -0,0 +1,153 @@
+#include "pe_bliss2/exceptions/function_boundary_map.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/pe_error.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::exceptions;
+
+namespace
+{
+constexpr rva_type image_end_rva = 0x10000u;
+
+const std::vector<rva_type> runtime_begin_rvas{ 0x1000u, 0x1100u, 0x2000u, 0x3000u };
+const std::vector<rva_type> runtime_end_rvas{ 0x1080u, 0x1200u, 0x2100u, 0x3000u };
+const std::vector<rva_type> guard_rvas{ 0x1000u, 0x1040u, 0x2000u, 0x5000u };
+//Unsorted, with duplicates
+const std::vector<rva_type> export_rvas{ 0x5000u, 0x1100u, 0x800u, 0x1100u };
+
+function_boundary_map create_map()
+{
+	const function_start_list lists[]{
+		{
+			.begin_rvas = runtime_begin_rvas,
+			.end_rvas = runtime_end_rvas,
+			.source = function_start_source::runtime_function
+		},
+		{
+			.begin_rvas = guard_rvas,
+			.end_rvas = {},
+			.source = function_start_source::guard_cf_function
+		},
+		{
+			.begin_rvas = export_rvas,
+			.end_rvas = {},
+			.source = function_start_source::exported_function
+		}
+	};
+	return function_boundary_map(lists, image_end_rva);
+}
+} //namespace
+
+TEST(FunctionBoundaryMapTests, Empty)
+{
+	function_boundary_map map;
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.size(), 0u);
+	EXPECT_FALSE(map.contains(0u));
+	EXPECT_EQ(map.find(0u), std::nullopt);
+	EXPECT_TRUE(map.get_starts_in(0u, 0xffffffffu).empty());
+	EXPECT_EQ(map.get_covered_size(), 0u);
+}
+
+TEST(FunctionBoundaryMapTests, Merge)
+{
+	const auto map = create_map();
+	EXPECT_EQ(std::vector<rva_type>(map.get_starts().begin(), map.get_starts().end()),
+		(std::vector<rva_type>{ 0x800u, 0x1000u, 0x1040u, 0x1100u,
+			0x2000u, 0x3000u, 0x5000u }));
+	EXPECT_EQ(std::vector<std::uint8_t>(map.get_sources().begin(),
+		map.get_sources().end()),
+		(std::vector<std::uint8_t>{
+			function_start_source::exported_function,
+			function_start_source::runtime_function
+				| function_start_source::guard_cf_function,
+			function_start_source::guard_cf_function,
+			function_start_source::runtime_function
+				| function_start_source::exported_function,
+			function_start_source::runtime_function
+				| function_start_source::guard_cf_function,
+			function_start_source::runtime_function,
+			function_start_source::guard_cf_function
+				| function_start_source::exported_function }));
+}
+
+TEST(FunctionBoundaryMapTests, Ranges)
+{
+	const auto map = create_map();
+	ASSERT_EQ(map.size(), 7u);
+	//Unknown end, spans up to the next start
+	EXPECT_EQ(map.get_range(0u), (function_range{ 0x800u, 0x1000u }));
+	//Known end is clipped by the next start
+	EXPECT_EQ(map.get_range(1u), (function_range{ 0x1000u, 0x1040u }));
+	EXPECT_EQ(map.get_range(2u), (function_range{ 0x1040u, 0x1100u }));
+	EXPECT_EQ(map.get_range(3u), (function_range{ 0x1100u, 0x1200u }));
+	EXPECT_EQ(map.get_range(4u), (function_range{ 0x2000u, 0x2100u }));
+	//Invalid end is treated as unknown
+	EXPECT_EQ(map.get_range(5u), (function_range{ 0x3000u, 0x5000u }));
+	//The last function spans up to the image end
+	EXPECT_EQ(map.get_range(6u), (function_range{ 0x5000u, image_end_rva }));
+
+	EXPECT_EQ(map.get_covered_size(), 0x800u + 0x40u + 0xc0u + 0x100u
+		+ 0x100u + 0x2000u + 0xb000u);
+}
+
+TEST(FunctionBoundaryMapTests, Find)
+{
+	const auto map = create_map();
+	EXPECT_EQ(map.find(0x7ffu), std::nullopt);
+	EXPECT_EQ(map.find(0x800u), 0u);
+	EXPECT_EQ(map.find(0x103fu), 1u);
+	EXPECT_EQ(map.find(0x1040u), 2u);
+	EXPECT_EQ(map.find(0x11ffu), 3u);
+	EXPECT_EQ(map.find(0x1200u), std::nullopt);
+	EXPECT_EQ(map.find(0x20ffu), 4u);
+	EXPECT_EQ(map.find(0x2100u), std::nullopt);
+	EXPECT_EQ(map.find(0x4fffu), 5u);
+	EXPECT_EQ(map.find(image_end_rva - 1u), 6u);
+	EXPECT_EQ(map.find(image_end_rva), std::nullopt);
+
+	EXPECT_TRUE(map.contains(0x1040u));
+	EXPECT_FALSE(map.contains(0x1041u));
+}
+
+TEST(FunctionBoundaryMapTests, StartsIn)
+{
+	const auto map = create_map();
+	const auto starts = map.get_starts_in(0x1000u, 0x2001u);
+	EXPECT_EQ(std::vector<rva_type>(starts.begin(), starts.end()),
+		(std::vector<rva_type>{ 0x1000u, 0x1040u, 0x1100u, 0x2000u }));
+	EXPECT_TRUE(map.get_starts_in(0x1001u, 0x1040u).empty());
+	EXPECT_TRUE(map.get_starts_in(0x2000u, 0x2000u).empty());
+	EXPECT_TRUE(map.get_starts_in(0x3000u, 0x1000u).empty());
+}
+
+TEST(FunctionBoundaryMapTests, MismatchedEndRvaCount)
+{
+	const std::vector<rva_type> end_rvas{ 0x1080u };
+	const function_start_list lists[]{
+		{
+			.begin_rvas = runtime_begin_rvas,
+			.end_rvas = end_rvas,
+			.source = function_start_source::runtime_function
+		}
+	};
+	expect_throw_pe_error([&lists] {
+		(void)function_boundary_map(lists, image_end_rva);
+	}, function_boundary_map_errc::mismatched_end_rva_count);
+}
+
+TEST(FunctionBoundaryMapTests, BuildEmptyImage)
+{
+	image::image instance;
+	const auto map = build_function_boundary_map(instance);
+	EXPECT_TRUE(map.empty());
+	EXPECT_FALSE(map.has_errors());
+}
@@ -0,0 +1,134 @@
+#include "pe_bliss2/load_config/guard_table_view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/pe_error.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::load_config;
+
+namespace
+{
+void append_entry(std::vector<std::byte>& data, rva_type rva,
+	std::uint8_t stride, std::uint8_t flags = 0u)
+{
+	for (std::uint32_t i = 0; i != sizeof(rva_type); ++i)
+		data.push_back(static_cast<std::byte>(rva >> (i * 8u)));
+	for (std::uint8_t i = 0; i != stride; ++i)
+		data.push_back(i ? std::byte{ 0xccu } : static_cast<std::byte>(flags));
+}
+} //namespace
+
+TEST(GuardTableViewTests, Empty)
+{
+	guard_table_view view;
+	EXPECT_TRUE(view.empty());
+	EXPECT_EQ(view.size(), 0u);
+	EXPECT_FALSE(view.contains(0u));
+	EXPECT_EQ(view.find_flags(0u), std::nullopt);
+	EXPECT_FALSE(view.is_valid_call_target(0u));
+}
+
+TEST(GuardTableViewTests, NoStride)
+{
+	std::vector<std::byte> data;
+	append_entry(data, 0x1000u, 0u);
+	append_entry(data, 0x2000u, 0u);
+	append_entry(data, 0x12345678u, 0u);
+
+	guard_table_view view(data, 0u);
+	EXPECT_FALSE(view.has_errors());
+	EXPECT_EQ(view.get_stride(), 0u);
+	EXPECT_EQ(std::vector<rva_type>(view.get_rvas().begin(), view.get_rvas().end()),
+		(std::vector<rva_type>{ 0x1000u, 0x2000u, 0x12345678u }));
+	EXPECT_TRUE(view.get_flags().empty());
+
+	EXPECT_TRUE(view.contains(0x12345678u));
+	EXPECT_FALSE(view.contains(0x1001u));
+	EXPECT_EQ(view.find_flags(0x2000u), 0u);
+	EXPECT_EQ(view.find_flags(0x2001u), std::nullopt);
+	EXPECT_TRUE(view.is_valid_call_target(0x1000u));
+	EXPECT_FALSE(view.is_valid_call_target(0xfffu));
+	EXPECT_FALSE(view.is_export_suppressed(0x1000u));
+}
+
+TEST(GuardTableViewTests, Flags)
+{
+	static constexpr std::uint8_t stride = 2u;
+	std::vector<std::byte> data;
+	append_entry(data, 0x1000u, stride);
+	append_entry(data, 0x1010u, stride, gfids_flags::fid_suppressed);
+	append_entry(data, 0x1020u, stride, gfids_flags::export_suppressed);
+	append_entry(data, 0x1030u, stride, gfids_flags::fid_xfg);
+
+	guard_table_view view(data, stride);
+	EXPECT_FALSE(view.has_errors());
+	ASSERT_EQ(view.size(), 4u);
+	ASSERT_EQ(view.get_flags().size(), 4u);
+	EXPECT_EQ(view.get_rvas()[3], 0x1030u);
+
+	EXPECT_EQ(view.find_flags(0x1000u), 0u);
+	EXPECT_EQ(view.find_flags(0x1030u), gfids_flags::fid_xfg);
+	EXPECT_TRUE(view.is_valid_call_target(0x1000u));
+	EXPECT_FALSE(view.is_valid_call_target(0x1010u));
+	EXPECT_TRUE(view.is_valid_call_target(0x1020u));
+	EXPECT_TRUE(view.is_export_suppressed(0x1020u));
+	EXPECT_FALSE(view.is_export_suppressed(0x1030u));
+	EXPECT_FALSE(view.is_export_suppressed(0x1040u));
+}
+
+TEST(GuardTableViewTests, Unsorted)
+{
+	static constexpr std::uint8_t stride = 1u;
+	std::vector<std::byte> data;
+	append_entry(data, 0x3000u, stride, gfids_flags::export_suppressed);
+	append_entry(data, 0x1000u, stride);
+	append_entry(data, 0x2000u, stride, gfids_flags::fid_suppressed);
+
+	guard_table_view view(data, stride);
+	expect_contains_errors(view, load_config_directory_loader_errc::unsorted_cf_guard_table);
+	EXPECT_EQ(std::vector<rva_type>(view.get_rvas().begin(), view.get_rvas().end()),
+		(std::vector<rva_type>{ 0x1000u, 0x2000u, 0x3000u }));
+	EXPECT_EQ(std::vector<std::uint8_t>(view.get_flags().begin(),
+		view.get_flags().end()),
+		(std::vector<std::uint8_t>{ 0u, gfids_flags::fid_suppressed,
+			gfids_flags::export_suppressed }));
+	EXPECT_FALSE(view.is_valid_call_target(0x2000u));
+	EXPECT_TRUE(view.is_export_suppressed(0x3000u));
+}
+
+TEST(GuardTableViewTests, InvalidSize)
+{
+	std::vector<std::byte> data;
+	append_entry(data, 0x1000u, 1u);
+	expect_throw_pe_error([&data] {
+		(void)guard_table_view(data, 0u);
+	}, load_config_directory_loader_errc::invalid_cf_guard_table_size);
+}
+
+TEST(GuardTableViewTests, UnsortedTableError)
+{
+	std::vector<std::byte> data;
+	append_entry(data, 0x2000u, 0u);
+	append_entry(data, 0x1000u, 0u);
+
+	guard_table_view view(data, 0u,
+		load_config_directory_loader_errc::unsorted_guard_longjump_table);
+	expect_contains_errors(view,
+		load_config_directory_loader_errc::unsorted_guard_longjump_table);
+	EXPECT_EQ(std::vector<rva_type>(view.get_rvas().begin(), view.get_rvas().end()),
+		(std::vector<rva_type>{ 0x1000u, 0x2000u }));
+}
+
+TEST(GuardTableViewTests, LoadNoDirectory)
+{
+	image::image instance;
+	EXPECT_EQ(load_guard_table_views(instance), std::nullopt);
+}
@@ -0,0 +1,209 @@
+#include "pe_bliss2/resources/icon_cursor_extractor.h"
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "buffers/output_memory_buffer.h"
+#include "pe_bliss2/resources/icon_cursor_reader.h"
+#include "pe_bliss2/resources/icon_cursor_writer.h"
+#include "pe_bliss2/resources/resource_directory.h"
+#include "pe_bliss2/resources/resource_index.h"
+#include "pe_bliss2/resources/resource_reader.h"
+#include "pe_bliss2/resources/resource_writer.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss::resources;
+
+namespace
+{
+constexpr resource_id_type lang1 = 1u;
+constexpr resource_id_type lang2 = 2u;
+
+constexpr std::array data2{
+	std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}, std::byte{5}
+};
+
+constexpr std::array data3{
+	std::byte{4}, std::byte{5}, std::byte{6}, std::byte{7}
+};
+
+constexpr std::array icon_group_data{
+	std::byte{}, std::byte{}, //reserved
+	std::byte{1}, std::byte{}, //type
+	std::byte{2}, std::byte{}, //count
+
+	std::byte{16}, //width
+	std::byte{16}, //height
+	std::byte{16}, //color_count
+	std::byte{}, //reserved
+	std::byte{1}, std::byte{}, //planes
+	std::byte{8}, std::byte{}, //bit_count
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //size_in_bytes
+	std::byte{2}, std::byte{}, //number
+
+	std::byte{24}, //width
+	std::byte{24}, //height
+	std::byte{8}, //color_count
+	std::byte{}, //reserved
+	std::byte{1}, std::byte{}, //planes
+	std::byte{16}, std::byte{}, //bit_count
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //size_in_bytes
+	std::byte{3}, std::byte{} //number
+};
+
+constexpr std::array cursor_group_data{
+	std::byte{}, std::byte{}, //reserved
+	std::byte{2}, std::byte{}, //type
+	std::byte{2}, std::byte{}, //count
+
+	std::byte{16}, std::byte{}, //width
+	std::byte{32}, std::byte{}, //height
+	std::byte{1}, std::byte{}, //planes
+	std::byte{8}, std::byte{}, //bit_count
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //size_in_bytes
+	std::byte{2}, std::byte{}, //number
+
+	std::byte{32}, std::byte{}, //width
+	std::byte{64}, std::byte{}, //height
+	std::byte{1}, std::byte{}, //planes
+	std::byte{16}, std::byte{}, //bit_count
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //size_in_bytes
+	std::byte{3}, std::byte{}, //number
+};
+
+template<typename Directory, typename Array>
+void emplace(Directory& root, resource_type type,
+	resource_id_type id, resource_id_type language, const Array& data)
+{
+	try_emplace_resource_data_by_id(root, type, id, language)
+		.get_raw_data().copied_data().assign(data.begin(), data.end());
+}
+
+template<typename Directory = resource_directory_details>
+Directory create_directory()
+{
+	Directory root;
+	emplace(root, resource_type::icon, 2u, lang1, data2);
+	//Only present in the other language
+	emplace(root, resource_type::icon, 3u, lang2, data3);
+	emplace(root, resource_type::icon_group, 10u, lang1, icon_group_data);
+	try_emplace_resource_data_by_name(root, resource_type::icon_group, u"name", lang1)
+		.get_raw_data().copied_data().assign(icon_group_data.begin(), icon_group_data.end());
+	//Invalid group
+	try_emplace_resource_data_by_id(root, resource_type::icon_group, 11u, lang1);
+
+	emplace(root, resource_type::cursor, 2u, lang1, data2);
+	emplace(root, resource_type::cursor, 3u, lang1, data3);
+	emplace(root, resource_type::cursor_group, 20u, lang1, cursor_group_data);
+	//Group with absent cursor
+	auto absent_cursor_group_data = cursor_group_data;
+	absent_cursor_group_data[32] = std::byte{5};
+	emplace(root, resource_type::cursor_group, 21u, lang2, absent_cursor_group_data);
+	return root;
+}
+
+template<typename Group>
+std::vector<std::byte> write_file(const Group& group)
+{
+	std::vector<std::byte> result;
+	buffers::output_memory_buffer buf(result);
+	if constexpr (std::is_same_v<Group, icon_group>)
+		write_icon(to_file_format(group), buf);
+	else
+		write_cursor(to_file_format(group), buf);
+	return result;
+}
+
+template<typename Extractor>
+std::vector<std::byte> extract(const Extractor& extractor,
+	const typename Extractor::file_type& file)
+{
+	std::vector<std::byte> result(file.size);
+	extractor.write(file, result);
+	return result;
+}
+} //namespace
+
+TEST(IconCursorExtractorTests, Extract)
+{
+	auto root = create_directory();
+	resource_index_details index(root);
+	icon_cursor_extractor_details extractor(index);
+
+	expect_contains_errors(extractor,
+		icon_cursor_extractor_errc::unable_to_read_group,
+		icon_cursor_extractor_errc::absent_image);
+
+	const auto& files = extractor.get_files();
+	ASSERT_EQ(files.size(), 3u);
+	EXPECT_EQ(files[0].group_type, resource_type::icon_group);
+	EXPECT_EQ(std::get<resource_id_type>(files[0].name_or_id), 10u);
+	EXPECT_EQ(files[0].language, lang1);
+	EXPECT_EQ(files[1].group_type, resource_type::icon_group);
+	EXPECT_EQ(std::get<std::u16string_view>(files[1].name_or_id), u"name");
+	EXPECT_EQ(files[2].group_type, resource_type::cursor_group);
+	EXPECT_EQ(std::get<resource_id_type>(files[2].name_or_id), 20u);
+
+	const auto icon_size = 6u + 16u * 2u + data2.size() + data3.size();
+	const auto cursor_size = 6u + 16u * 2u + data2.size() - 4u;
+	EXPECT_EQ(files[0].size, icon_size);
+	EXPECT_EQ(files[1].size, icon_size);
+	EXPECT_EQ(files[2].size, cursor_size);
+	EXPECT_EQ(extractor.get_total_size(), icon_size * 2u + cursor_size);
+
+	auto reference_root = create_directory();
+	emplace(reference_root, resource_type::icon, 3u, lang1, data3);
+	auto icon = write_file(icon_group_from_resource_by_lang(reference_root, lang1, 10u));
+	EXPECT_EQ(extract(extractor, files[0]), icon);
+	EXPECT_EQ(extract(extractor, files[1]), icon);
+	EXPECT_EQ(extract(extractor, files[2]), write_file(
+		cursor_group_from_resource_by_lang(root, lang1, 20u)));
+
+	std::vector<std::byte> result;
+	buffers::output_memory_buffer buf(result);
+	extractor.write(files[0], buf);
+	EXPECT_EQ(result, icon);
+
+	std::vector<std::byte> too_small(files[0].size - 1u);
+	EXPECT_THROW(extractor.write(files[0], too_small), std::system_error);
+
+	auto invalid = files[0];
+	invalid.first_image = 10u;
+	expect_throw_pe_error([&] { extractor.write(invalid, result); },
+		icon_cursor_extractor_errc::invalid_file);
+}
+
+TEST(IconCursorExtractorTests, Options)
+{
+	auto root = create_directory();
+	resource_index_details index(root);
+
+	icon_cursor_extractor_details icons(index, { .extract_cursors = false });
+	ASSERT_EQ(icons.get_files().size(), 2u);
+	expect_contains_errors(icons, icon_cursor_extractor_errc::unable_to_read_group);
+
+	icon_cursor_extractor_details cursors(index, { .extract_icons = false });
+	ASSERT_EQ(cursors.get_files().size(), 1u);
+	EXPECT_EQ(cursors.get_files()[0].group_type, resource_type::cursor_group);
+	expect_contains_errors(cursors, icon_cursor_extractor_errc::absent_image);
+}
+
+TEST(IconCursorExtractorTests, NoErrorList)
+{
+	static_assert(!std::is_base_of_v<pe_bliss::error_list, icon_cursor_extractor>);
+	static_assert(std::is_base_of_v<pe_bliss::error_list, icon_cursor_extractor_details>);
+
+	auto root = create_directory<resource_directory>();
+	resource_index index(root);
+	icon_cursor_extractor extractor(index);
+	ASSERT_EQ(extractor.get_files().size(), 3u);
+	EXPECT_EQ(extract(extractor, extractor.get_files()[2]), write_file(
+		cursor_group_from_resource_by_lang(root, lang1, 20u)));
+}
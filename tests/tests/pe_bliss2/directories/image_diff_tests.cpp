@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pe_bliss2/core/optional_header.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/relocations/compact_relocation_table.h"
+#include "pe_bliss2/relocations/image_diff.h"
+#include "pe_bliss2/relocations/image_rebase.h"
+
+#include "tests/pe_bliss2/image_helper.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::relocations;
+
+namespace
+{
+class ImageDiffTestFixture : public ::testing::Test
+{
+public:
+	ImageDiffTestFixture()
+		: a(create_test_image({ .start_section_rva = section_rva,
+			.sections = { { 0x1000u, 0x1000u }, { 0x1000u, 0x800u } } }))
+	{
+		a.get_optional_header().initialize_with<
+			core::optional_header::optional_header_32_type>();
+		a.get_optional_header().set_raw_image_base(0x400000u);
+		for (auto& data : a.get_section_data_list())
+		{
+			auto& bytes = data.copied_data();
+			for (std::size_t i = 0; i != bytes.size(); ++i)
+				bytes[i] = static_cast<std::byte>(i * 3u + 1u);
+		}
+
+		relocs.resize(2u);
+		relocs[0].get_descriptor()->virtual_address = section_rva;
+		relocs[1].get_descriptor()->virtual_address = section_rva + 0x1000u;
+		for (std::uint16_t address : { 0x10u, 0x14u, 0x40u })
+			add(relocs[0], relocation_type::highlow, address);
+		add(relocs[0], relocation_type::absolute, 0x80u);
+		add(relocs[1], relocation_type::highlow, 0x7feu);
+
+		b = a;
+		rebase(b, relocs, { .new_base = 0x10000000u });
+	}
+
+	static void add(base_relocation& basereloc, relocation_type type,
+		std::uint16_t address)
+	{
+		auto& entry = basereloc.get_relocations().emplace_back();
+		entry.set_type(type);
+		entry.set_address(address);
+	}
+
+	std::byte& byte_at(image::image& instance, rva_type rva)
+	{
+		auto index = (rva - section_rva) / 0x1000u;
+		return instance.get_section_data_list()[index].copied_data()[
+			(rva - section_rva) % 0x1000u];
+	}
+
+public:
+	static constexpr rva_type section_rva = 0x1000u;
+
+	image::image a;
+	image::image b;
+	base_relocation_list relocs;
+};
+} //namespace
+
+TEST_F(ImageDiffTestFixture, Identical)
+{
+	EXPECT_TRUE(diff_images(a, a, relocs).empty());
+	EXPECT_TRUE(diff_images(a, b, relocs).empty());
+	EXPECT_FALSE(diff_images(a, b, base_relocation_list{}).empty());
+}
+
+TEST_F(ImageDiffTestFixture, Differences)
+{
+	//Relocated slots are ignored
+	byte_at(b, section_rva + 0x12u) ^= std::byte{ 0xff };
+	//Absolute entries do not mask anything
+	byte_at(b, section_rva + 0x80u) ^= std::byte{ 0xff };
+	//Adjacent bytes across the chunk boundary are merged
+	byte_at(b, section_rva + 0x3fu) ^= std::byte{ 0xff };
+	byte_at(b, section_rva + 0x44u) ^= std::byte{ 0xff };
+	byte_at(b, section_rva + 0x45u) ^= std::byte{ 0xff };
+	byte_at(b, section_rva + 0x1000u) ^= std::byte{ 0xff };
+
+	const image_difference_list expected{
+		{ section_rva + 0x3fu, 1u },
+		{ section_rva + 0x44u, 2u },
+		{ section_rva + 0x80u, 1u },
+		{ section_rva + 0x1000u, 1u }
+	};
+	EXPECT_EQ(diff_images(a, b, relocs), expected);
+
+	compact_relocation_table compact;
+	compact.add_block(section_rva, std::vector<std::uint16_t>{
+		0x3010u, 0x3014u, 0x3040u, 0x0080u });
+	compact.add_block(section_rva + 0x1000u, std::vector<std::uint16_t>{ 0x37feu });
+	EXPECT_EQ(diff_images(a, b, compact), expected);
+
+	EXPECT_EQ(diff_images(a, b, relocs, { .max_differences = 2u }),
+		(image_difference_list{ expected[0], expected[1] }));
+}
+
+TEST_F(ImageDiffTestFixture, DifferentSizes)
+{
+	//Missing data is compared as zeroes
+	b.get_section_data_list()[1].copied_data().resize(0x900u);
+	byte_at(b, section_rva + 0x1000u + 0x8ffu) = std::byte{ 1 };
+	EXPECT_EQ(diff_images(a, b, relocs),
+		(image_difference_list{ { section_rva + 0x1000u + 0x8ffu, 1u } }));
+}
+
+TEST_F(ImageDiffTestFixture, LayoutMismatch)
+{
+	b.get_section_table().get_section_headers()[1].set_rva(0x5000u);
+	expect_throw_pe_error([this] { (void)diff_images(a, b, relocs); },
+		image_diff_errc::section_layout_mismatch);
+}
@@ -0,0 +1,220 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "pe_bliss2/core/data_directories.h"
+#include "pe_bliss2/detail/imports/image_import_descriptor.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/imports/import_directory.h"
+#include "pe_bliss2/imports/import_directory_builder.h"
+#include "pe_bliss2/imports/import_directory_loader.h"
+
+#include "tests/pe_bliss2/image_helper.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+
+namespace
+{
+
+class ImportBuilderTestFixture : public ::testing::TestWithParam<core::optional_header::magic>
+{
+public:
+	ImportBuilderTestFixture()
+		: instance(create_test_image({
+			.is_x64 = is_x64(),
+			.start_section_rva = section_rva,
+			.sections = { { 0x2000u, 0x2000u } } }))
+	{
+	}
+
+	bool is_x64() const
+	{
+		return GetParam() == core::optional_header::magic::pe64;
+	}
+
+	template<typename Func>
+	void with_libraries(Func&& func)
+	{
+		if (is_x64())
+		{
+			func(directory.get_list().emplace<std::vector<imports::imported_library<
+				std::uint64_t, detail::imports::image_import_descriptor>>>());
+		}
+		else
+		{
+			func(directory.get_list().emplace<std::vector<imports::imported_library<
+				std::uint32_t, detail::imports::image_import_descriptor>>>());
+		}
+	}
+
+	template<typename Library>
+	static void add_library(std::vector<Library>& libraries, const std::string& name,
+		bool has_lookup_table)
+	{
+		using va_type = typename Library::imported_address_list::value_type::va_type;
+		auto& library = libraries.emplace_back();
+		library.get_library_name() = name;
+		if (has_lookup_table)
+			library.get_descriptor()->lookup_table = 1u;
+
+		auto& by_name = library.get_imports().emplace_back().get_import_info()
+			.template emplace<imports::imported_function_hint_and_name<va_type>>();
+		by_name.get_hint() = hint;
+		by_name.get_name() = std::string(import_name);
+
+		library.get_imports().emplace_back().get_import_info()
+			.template emplace<imports::imported_function_ordinal<va_type>>()
+			.set_ordinal(ordinal);
+	}
+
+	template<typename Library>
+	static void validate_library(const Library& library, const std::string& name)
+	{
+		using va_type = typename Library::imported_address_list::value_type::va_type;
+		expect_contains_errors(library);
+		EXPECT_EQ(library.get_library_name().value(), name);
+		const auto& list = library.get_imports();
+		ASSERT_EQ(list.size(), 2u);
+		expect_contains_errors(list[0]);
+		expect_contains_errors(list[1]);
+
+		const auto* by_name = std::get_if<imports::imported_function_hint_and_name<va_type>>(
+			&list[0].get_import_info());
+		ASSERT_NE(by_name, nullptr);
+		EXPECT_EQ(by_name->get_hint().get(), hint);
+		EXPECT_EQ(by_name->get_name().value(), import_name);
+
+		const auto* by_ordinal = std::get_if<imports::imported_function_ordinal<va_type>>(
+			&list[1].get_import_info());
+		ASSERT_NE(by_ordinal, nullptr);
+		EXPECT_EQ(by_ordinal->get_ordinal(), ordinal);
+	}
+
+	void build_and_validate(const imports::builder_options& options)
+	{
+		auto size = imports::get_built_size(directory, options);
+		auto result = imports::build_new(instance, directory, options);
+		EXPECT_EQ(size.directory_size, result.full_size);
+		if (options.iat_rva)
+		{
+			//Separate IAT is aligned to the thunk size
+			EXPECT_EQ(result.iat_rva % (is_x64() ? 8u : 4u), 0u);
+			EXPECT_EQ(size.iat_size, result.iat_size + result.iat_rva - *options.iat_rva);
+		}
+		else
+		{
+			EXPECT_EQ(size.iat_size, result.iat_size);
+		}
+
+		const auto& iat_dir = instance.get_data_directories().get_directory(
+			core::data_directories::directory_type::iat);
+		EXPECT_EQ(iat_dir->virtual_address, result.iat_rva);
+		EXPECT_EQ(iat_dir->size, result.iat_size);
+
+		auto loaded = imports::load(instance);
+		ASSERT_TRUE(loaded);
+		expect_contains_errors(*loaded);
+		std::visit([] (const auto& libraries) {
+			ASSERT_EQ(libraries.size(), 3u);
+			validate_library(libraries[0], library1_name);
+			validate_library(libraries[1], library2_name);
+			validate_library(libraries[2], library1_name);
+			EXPECT_TRUE(libraries[0].has_lookup_table());
+			EXPECT_FALSE(libraries[1].has_lookup_table());
+			EXPECT_TRUE(libraries[2].has_lookup_table());
+		}, loaded->get_list());
+	}
+
+public:
+	image::image instance;
+	imports::import_directory directory;
+
+public:
+	static constexpr std::uint32_t section_rva = 0x1000u;
+	static constexpr std::uint16_t hint = 0x1234u;
+	static constexpr std::uint16_t ordinal = 0x55u;
+	static constexpr const char import_name[] = "function";
+	static constexpr const char library1_name[] = "library1.dll";
+	static constexpr const char library2_name[] = "library2.dll";
+};
+
+} //namespace
+
+TEST_P(ImportBuilderTestFixture, BuildNew)
+{
+	with_libraries([](auto& libraries) {
+		add_library(libraries, library1_name, true);
+		add_library(libraries, library2_name, false);
+		add_library(libraries, library1_name, true);
+	});
+
+	build_and_validate({ .directory_rva = section_rva });
+}
+
+TEST_P(ImportBuilderTestFixture, BuildNewSeparateIat)
+{
+	with_libraries([](auto& libraries) {
+		add_library(libraries, library1_name, true);
+		add_library(libraries, library2_name, false);
+		add_library(libraries, library1_name, true);
+	});
+
+	build_and_validate({ .directory_rva = section_rva,
+		.iat_rva = section_rva + 0x1000u });
+}
+
+TEST_P(ImportBuilderTestFixture, BuildNewSeparateUnalignedIat)
+{
+	with_libraries([](auto& libraries) {
+		add_library(libraries, library1_name, true);
+		add_library(libraries, library2_name, false);
+		add_library(libraries, library1_name, true);
+	});
+
+	build_and_validate({ .directory_rva = section_rva,
+		.iat_rva = section_rva + 0x1001u });
+}
+
+TEST_P(ImportBuilderTestFixture, BuildNewDeduplicated)
+{
+	with_libraries([](auto& libraries) {
+		add_library(libraries, library1_name, true);
+		add_library(libraries, library2_name, false);
+		add_library(libraries, library1_name, true);
+	});
+
+	auto full_size = imports::get_built_size(directory,
+		{ .directory_rva = section_rva }).directory_size;
+	auto deduplicated_size = imports::get_built_size(directory,
+		{ .directory_rva = section_rva, .deduplicate_strings = true }).directory_size;
+	auto shared_size = imports::get_built_size(directory,
+		{ .directory_rva = section_rva, .deduplicate_strings = true,
+		.share_lookup_tables = true }).directory_size;
+	EXPECT_EQ(full_size - deduplicated_size,
+		sizeof(library1_name) + 2u * (sizeof(std::uint16_t) + sizeof(import_name)));
+	EXPECT_EQ(deduplicated_size - shared_size, 3u * (is_x64() ? 8u : 4u));
+
+	build_and_validate({ .directory_rva = section_rva,
+		.deduplicate_strings = true, .share_lookup_tables = true });
+
+	std::visit([] (const auto& libraries) {
+		EXPECT_EQ(libraries[0].get_descriptor()->name,
+			libraries[2].get_descriptor()->name);
+		EXPECT_EQ(libraries[0].get_descriptor()->lookup_table,
+			libraries[2].get_descriptor()->lookup_table);
+		EXPECT_NE(libraries[0].get_descriptor()->address_table,
+			libraries[2].get_descriptor()->address_table);
+	}, directory.get_list());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+	ImportBuilderTests,
+	ImportBuilderTestFixture,
+	::testing::Values(
+		core::optional_header::magic::pe32,
+		core::optional_header::magic::pe64
+	));
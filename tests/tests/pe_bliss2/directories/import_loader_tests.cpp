@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "pe_bliss2/core/data_directories.h"
+#include "pe_bliss2/delay_import/delay_import_directory_loader.h"
 #include "pe_bliss2/imports/import_directory.h"
 #include "pe_bliss2/imports/import_directory_loader.h"
 #include "pe_bliss2/image/image.h"
@@ -740,6 +741,135 @@ TEST_P(ImportLoaderTestFixture, VirtualPart)
 	}
 }
 
+TEST_P(ImportLoaderTestFixture, LoadMaxLibraries)
+{
+	add_import_directory();
+	add_import_directory_data();
+	add_library_names();
+	auto result = imports::load(instance, { .max_libraries = 2u });
+	ASSERT_TRUE(result);
+	expect_contains_errors(*result,
+		imports::import_directory_loader_errc::too_many_libraries);
+	with_imports(*result, [](const auto& list)
+	{
+		ASSERT_EQ(list.size(), 2u);
+		EXPECT_EQ(list[1].get_library_name().value(), lib13_name);
+	});
+}
+
+TEST_P(ImportLoaderTestFixture, LoadMaxImportsPerLibrary)
+{
+	add_import_directory();
+	add_import_directory_data();
+	add_library_names();
+	add_ilt(ilt13_offset);
+	add_ilt(iat13_offset);
+	add_hint_name();
+	auto result = imports::load(instance, { .max_imports_per_library = 1u });
+	ASSERT_TRUE(result);
+	expect_contains_errors(*result);
+	with_imports(*result, [](const auto& list)
+	{
+		ASSERT_EQ(list.size(), library_count);
+		expect_contains_errors(list[1],
+			imports::import_directory_loader_errc::too_many_imports);
+		expect_contains_errors(list[3],
+			imports::import_directory_loader_errc::too_many_imports);
+		EXPECT_EQ(list[1].get_imports().size(), 1u);
+		EXPECT_EQ(list[3].get_imports().size(), 1u);
+	});
+}
+
+TEST_P(ImportLoaderTestFixture, LoadMaxTotalImports)
+{
+	add_import_directory();
+	add_import_directory_data();
+	add_library_names();
+	add_ilt(ilt13_offset);
+	add_ilt(iat13_offset);
+	add_hint_name();
+	auto result = imports::load(instance, { .max_total_imports = 3u });
+	ASSERT_TRUE(result);
+	expect_contains_errors(*result,
+		imports::import_directory_loader_errc::too_many_total_imports);
+	with_imports(*result, [](const auto& list)
+	{
+		ASSERT_EQ(list.size(), 4u);
+		expect_contains_errors(list[1]);
+		expect_contains_errors(list[3]);
+		EXPECT_EQ(list[1].get_imports().size(), 2u);
+		EXPECT_EQ(list[3].get_imports().size(), 1u);
+	});
+}
+
+TEST_P(ImportLoaderTestFixture, LoadLazy)
+{
+	add_import_directory();
+	add_import_directory_data();
+	add_library_names();
+	add_ilt(ilt13_offset);
+	add_ilt(iat13_offset);
+	add_hint_name();
+	auto result = imports::load_lazy(instance);
+	ASSERT_TRUE(result);
+	ASSERT_EQ(result->get_library_count(), library_count);
+	EXPECT_FALSE(result->is_resolved(1u));
+	with_imports(result->get_directory(), [](const auto& list)
+	{
+		EXPECT_EQ(list[1].get_library_name().value(), lib13_name);
+		EXPECT_TRUE(list[1].get_imports().empty());
+	});
+
+	auto index = result->find_library(lib13_name);
+	ASSERT_TRUE(index);
+	EXPECT_EQ(*index, 1u);
+	EXPECT_FALSE(result->find_library("absent.dll"));
+
+	with_imports(result->resolve(*index), [this](const auto& list)
+	{
+		expect_contains_errors(list[1]);
+		validate_ilt13(list[1], { .with_iat = true, .with_name = true });
+		EXPECT_TRUE(list[3].get_imports().empty());
+	});
+	EXPECT_TRUE(result->is_resolved(1u));
+	EXPECT_FALSE(result->is_resolved(3u));
+
+	with_imports(result->resolve_all(), [this](const auto& list)
+	{
+		validate_ilt13(list[1], { .with_iat = true, .with_name = true });
+		validate_ilt13(list[3], { .is_bound = true,
+			.with_iat = true, .with_name = true });
+	});
+	expect_contains_errors(result->get_directory());
+}
+
+TEST_P(ImportLoaderTestFixture, LoadLazyMaxTotalImports)
+{
+	add_import_directory();
+	add_import_directory_data();
+	add_library_names();
+	add_ilt(ilt13_offset);
+	add_ilt(iat13_offset);
+	add_hint_name();
+	auto result = imports::load_lazy(instance, { .max_total_imports = 3u });
+	ASSERT_TRUE(result);
+	with_imports(result->resolve_all(), [](const auto& list)
+	{
+		ASSERT_EQ(list.size(), library_count);
+		EXPECT_EQ(list[1].get_imports().size(), 2u);
+		EXPECT_EQ(list[3].get_imports().size(), 1u);
+	});
+	expect_contains_errors(result->get_directory(),
+		imports::import_directory_loader_errc::too_many_total_imports);
+}
+
+TEST_P(ImportLoaderTestFixture, LoadLazyAbsentDelayedImportDirectory)
+{
+	add_import_directory();
+	EXPECT_FALSE(delay_import::load_lazy(instance, { .target_directory
+		= core::data_directories::directory_type::delay_import }));
+}
+
 TEST_P(ImportLoaderTestFixture, LoadZeroImportDirectoryFromHeadersError)
 {
 	add_import_directory_to_headers();
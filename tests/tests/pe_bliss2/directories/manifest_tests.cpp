@@ -10,6 +10,7 @@
 #include "pe_bliss2/resources/manifest.h"
 #include "pe_bliss2/resources/manifest_accessor_interface.h"
 #include "pe_bliss2/resources/pugixml_manifest_accessor.h"
+#include "pe_bliss2/resources/streaming_manifest_accessor.h"
 #include "tests/pe_bliss2/pe_error_helper.h"
 
 using namespace pe_bliss::resources;
@@ -975,12 +976,15 @@ buffers::input_buffer_ptr buf_from_string(std::string_view str)
 	return std::make_shared<buffers::input_memory_buffer>(ptr, str.size());
 }
 
-class ManifestTestFixture : public ::testing::Test
+using manifest_parser_type = manifest_accessor_interface_ptr(*)(
+	const buffers::input_buffer_ptr&);
+
+class ManifestTestFixture : public ::testing::TestWithParam<manifest_parser_type>
 {
 public:
 	void load(std::string_view xml)
 	{
-		accessor_ = pugixml::parse_manifest(buf_from_string(xml));
+		accessor_ = GetParam()(buf_from_string(xml));
 		manifest = parse_manifest(*accessor_);
 	}
 
@@ -1133,14 +1137,14 @@ private:
 };
 } //namespace
 
-TEST_F(ManifestTestFixture, Invalid)
+TEST_P(ManifestTestFixture, Invalid)
 {
 	load("<");
 	expect_contains_errors(manifest, manifest_errc::empty_manifest);
 	expect_empty();
 }
 
-TEST_F(ManifestTestFixture, Empty)
+TEST_P(ManifestTestFixture, Empty)
 {
 	load(empty_manifest);
 	expect_contains_errors(manifest, manifest_errc::invalid_manifest_version,
@@ -1149,13 +1153,13 @@ TEST_F(ManifestTestFixture, Empty)
 	expect_empty();
 }
 
-TEST_F(ManifestTestFixture, AssemblyIdentity)
+TEST_P(ManifestTestFixture, AssemblyIdentity)
 {
 	load(assembly_identity_manifest);
 	verify_assembly_identity();
 }
 
-TEST_F(ManifestTestFixture, EmptyAssemblyIdentity)
+TEST_P(ManifestTestFixture, EmptyAssemblyIdentity)
 {
 	load(empty_assembly_identity_manifest);
 	expect_contains_errors(manifest);
@@ -1169,7 +1173,7 @@ TEST_F(ManifestTestFixture, EmptyAssemblyIdentity)
 	expect_empty_assembly_identity();
 }
 
-TEST_F(ManifestTestFixture, WindowsSettings)
+TEST_P(ManifestTestFixture, WindowsSettings)
 {
 	test_bool_flags<&native_manifest_details::auto_elevate,
 		manifest_errc::invalid_auto_elevate_elem,
@@ -1202,14 +1206,14 @@ TEST_F(ManifestTestFixture, WindowsSettings)
 			"ws13:ultraHighResolutionScrollingAware");
 }
 
-TEST_F(ManifestTestFixture, Description)
+TEST_P(ManifestTestFixture, Description)
 {
 	load(description_manifest);
 	expect_contains_errors(manifest);
 	EXPECT_EQ(manifest.get_description(), "Description line 1\nDescription line 2");
 }
 
-TEST_F(ManifestTestFixture, WindowsSettingsHeapType)
+TEST_P(ManifestTestFixture, WindowsSettingsHeapType)
 {
 	using get_heap_type_func = const std::optional<heap_type>& (
 		native_manifest_details::*)() const& noexcept;
@@ -1222,7 +1226,7 @@ TEST_F(ManifestTestFixture, WindowsSettingsHeapType)
 	expect_contains_errors(manifest);
 }
 
-TEST_F(ManifestTestFixture, WindowsSettingsActiveCodePage)
+TEST_P(ManifestTestFixture, WindowsSettingsActiveCodePage)
 {
 	using get_active_code_page_func = const std::optional<active_code_page>& (
 		native_manifest_details::*)() const& noexcept;
@@ -1236,7 +1240,7 @@ TEST_F(ManifestTestFixture, WindowsSettingsActiveCodePage)
 	expect_contains_errors(manifest);
 }
 
-TEST_F(ManifestTestFixture, WindowsSettingsDpiAware)
+TEST_P(ManifestTestFixture, WindowsSettingsDpiAware)
 {
 	load(format_window_settings_manifest_xml_multiple_flags("ws05:dpiAware"));
 	ASSERT_FALSE(manifest.get_dpi_awareness().get_dpi_aware_raw());
@@ -1247,7 +1251,7 @@ TEST_F(ManifestTestFixture, WindowsSettingsDpiAware)
 	expect_contains_errors(manifest);
 }
 
-TEST_F(ManifestTestFixture, WindowsSettingsDpiAwareness)
+TEST_P(ManifestTestFixture, WindowsSettingsDpiAwareness)
 {
 	load(format_window_settings_manifest_xml_multiple_flags("ws16:dpiAwareness"));
 	ASSERT_FALSE(manifest.get_dpi_awareness().get_dpi_awareness_raw());
@@ -1258,7 +1262,7 @@ TEST_F(ManifestTestFixture, WindowsSettingsDpiAwareness)
 	expect_contains_errors(manifest);
 }
 
-TEST_F(ManifestTestFixture, MsixIdentity)
+TEST_P(ManifestTestFixture, MsixIdentity)
 {
 	load(msix_identity_manifest);
 	expect_contains_errors(manifest);
@@ -1270,7 +1274,7 @@ TEST_F(ManifestTestFixture, MsixIdentity)
 	EXPECT_EQ(manifest.get_msix_identity()->get_package_name(), "Package");
 }
 
-TEST_F(ManifestTestFixture, EmptyMsixIdentity)
+TEST_P(ManifestTestFixture, EmptyMsixIdentity)
 {
 	load(empty_msix_identity_manifest);
 	expect_contains_errors(manifest);
@@ -1285,7 +1289,7 @@ TEST_F(ManifestTestFixture, EmptyMsixIdentity)
 	EXPECT_EQ(manifest.get_msix_identity()->get_package_name(), "");
 }
 
-TEST_F(ManifestTestFixture, MultipleMsixIdentities)
+TEST_P(ManifestTestFixture, MultipleMsixIdentities)
 {
 	load(multiple_msix_identity_manifest);
 	expect_contains_errors(manifest,
@@ -1293,20 +1297,20 @@ TEST_F(ManifestTestFixture, MultipleMsixIdentities)
 	EXPECT_FALSE(manifest.get_msix_identity());
 }
 
-TEST_F(ManifestTestFixture, MultipleWindowsSettingsElements)
+TEST_P(ManifestTestFixture, MultipleWindowsSettingsElements)
 {
 	load(multiple_windows_settings_manifest);
 	expect_contains_errors(manifest,
 		manifest_errc::multiple_windows_settings_elements);
 }
 
-TEST_F(ManifestTestFixture, AssemblyIdentityWrongIndex)
+TEST_P(ManifestTestFixture, AssemblyIdentityWrongIndex)
 {
 	load(assembly_identity_wrong_index_manifest);
 	verify_assembly_identity<manifest_errc::invalid_assembly_identity_element_position>();
 }
 
-TEST_F(ManifestTestFixture, NoInherit)
+TEST_P(ManifestTestFixture, NoInherit)
 {
 	load(no_inherit_manifest);
 	expect_contains_errors(manifest);
@@ -1314,7 +1318,7 @@ TEST_F(ManifestTestFixture, NoInherit)
 	EXPECT_EQ(manifest.no_inherit(), assembly_no_inherit::no_inherit);
 }
 
-TEST_F(ManifestTestFixture, NoInheritable)
+TEST_P(ManifestTestFixture, NoInheritable)
 {
 	load(no_inheritable_manifest);
 	expect_contains_errors(manifest);
@@ -1322,7 +1326,7 @@ TEST_F(ManifestTestFixture, NoInheritable)
 	EXPECT_EQ(manifest.no_inherit(), assembly_no_inherit::no_inheritable);
 }
 
-TEST_F(ManifestTestFixture, MultipleNoInherit)
+TEST_P(ManifestTestFixture, MultipleNoInherit)
 {
 	load(multiple_no_inherit_manifest);
 	expect_contains_errors(manifest, manifest_errc::multiple_no_inherit_elements);
@@ -1331,7 +1335,7 @@ TEST_F(ManifestTestFixture, MultipleNoInherit)
 	EXPECT_EQ(manifest.no_inherit(), assembly_no_inherit::absent);
 }
 
-TEST_F(ManifestTestFixture, WrongNoInheritPos)
+TEST_P(ManifestTestFixture, WrongNoInheritPos)
 {
 	load(wrong_no_inherit_pos_manifest);
 	expect_contains_errors(manifest, manifest_errc::no_inherit_element_not_first);
@@ -1339,7 +1343,7 @@ TEST_F(ManifestTestFixture, WrongNoInheritPos)
 	EXPECT_EQ(manifest.no_inherit(), assembly_no_inherit::no_inherit);
 }
 
-TEST_F(ManifestTestFixture, NoInheritWrongAssemblyIdentityPos)
+TEST_P(ManifestTestFixture, NoInheritWrongAssemblyIdentityPos)
 {
 	load(no_inherit_wrong_assembly_identity_pos_manifest);
 	expect_contains_errors(manifest);
@@ -1348,7 +1352,7 @@ TEST_F(ManifestTestFixture, NoInheritWrongAssemblyIdentityPos)
 	EXPECT_EQ(manifest.no_inherit(), assembly_no_inherit::no_inherit);
 }
 
-TEST_F(ManifestTestFixture, SupportedOs)
+TEST_P(ManifestTestFixture, SupportedOs)
 {
 	load(supported_os_manifest);
 	expect_contains_errors(manifest);
@@ -1364,7 +1368,7 @@ TEST_F(ManifestTestFixture, SupportedOs)
 			"{e2011457-1546-43c5-a5fe-008deee3d3f0}"));
 }
 
-TEST_F(ManifestTestFixture, SupportedOsMultipleCompatibility)
+TEST_P(ManifestTestFixture, SupportedOsMultipleCompatibility)
 {
 	load(supported_os_manifest_multiple_compatibility);
 	expect_contains_errors(manifest,
@@ -1372,7 +1376,7 @@ TEST_F(ManifestTestFixture, SupportedOsMultipleCompatibility)
 	EXPECT_FALSE(manifest.get_supported_os_list());
 }
 
-TEST_F(ManifestTestFixture, TrustInfo)
+TEST_P(ManifestTestFixture, TrustInfo)
 {
 	load(trust_info_manifest);
 	expect_contains_errors(manifest);
@@ -1381,7 +1385,7 @@ TEST_F(ManifestTestFixture, TrustInfo)
 	EXPECT_EQ(manifest.get_requested_privileges()->get_ui_access_raw(), "false");
 }
 
-TEST_F(ManifestTestFixture, TrustInfoMultipleElements)
+TEST_P(ManifestTestFixture, TrustInfoMultipleElements)
 {
 	load(trust_info_multiple_elements_manifest);
 	expect_contains_errors(manifest,
@@ -1389,7 +1393,7 @@ TEST_F(ManifestTestFixture, TrustInfoMultipleElements)
 	EXPECT_FALSE(manifest.get_requested_privileges());
 }
 
-TEST_F(ManifestTestFixture, TrustInfoAbsentAttributes)
+TEST_P(ManifestTestFixture, TrustInfoAbsentAttributes)
 {
 	load(trust_info_absent_attributes_manifest);
 	expect_contains_errors(manifest,
@@ -1400,7 +1404,7 @@ TEST_F(ManifestTestFixture, TrustInfoAbsentAttributes)
 	EXPECT_TRUE(manifest.get_requested_privileges()->get_ui_access_raw().empty());
 }
 
-TEST_F(ManifestTestFixture, Dependencies)
+TEST_P(ManifestTestFixture, Dependencies)
 {
 	load(dependencies_manifest);
 	expect_contains_errors(manifest);
@@ -1417,7 +1421,7 @@ TEST_F(ManifestTestFixture, Dependencies)
 	EXPECT_EQ(manifest.get_dependencies()[2].get_name(), "dep3");
 }
 
-TEST_F(ManifestTestFixture, InvalidDependencies)
+TEST_P(ManifestTestFixture, InvalidDependencies)
 {
 	load(invalid_dependencies_manifest);
 	expect_contains_errors(manifest, manifest_errc::invalid_dependencies);
@@ -1429,7 +1433,7 @@ TEST_F(ManifestTestFixture, InvalidDependencies)
 	verify_dependencies();
 }
 
-TEST_F(ManifestTestFixture, ComInterfaceExternalProxyStub)
+TEST_P(ManifestTestFixture, ComInterfaceExternalProxyStub)
 {
 	load(com_external_proxy_stubs_manifest);
 	expect_contains_errors(manifest);
@@ -1463,7 +1467,7 @@ TEST_F(ManifestTestFixture, ComInterfaceExternalProxyStub)
 	EXPECT_FALSE(stub2.get_name());
 }
 
-TEST_F(ManifestTestFixture, File)
+TEST_P(ManifestTestFixture, File)
 {
 	load(files_manifest);
 	expect_contains_errors(manifest);
@@ -1596,3 +1600,8 @@ TEST_F(ManifestTestFixture, File)
 		EXPECT_FALSE(stub1.get_threading_model_raw());
 	}
 }
+
+INSTANTIATE_TEST_SUITE_P(
+	ManifestTestFixtureAccessors,
+	ManifestTestFixture,
+	::testing::Values(&pugixml::parse_manifest, &streaming::parse_manifest));
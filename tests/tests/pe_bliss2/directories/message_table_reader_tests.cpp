@@ -192,3 +192,63 @@ TEST(MessageTableReaderTests, ReadValidVirtual)
 	validate_block2(table);
 	validate_block3(table);
 }
+
+TEST(MessageTableReaderTests, IndexEmpty)
+{
+	expect_throw_pe_error([] {
+		(void)message_table_index(std::make_shared<buffers::input_container_buffer>());
+	}, resource_reader_errc::buffer_read_error);
+}
+
+TEST(MessageTableReaderTests, IndexValid)
+{
+	message_table_index index(std::make_shared<buffers::input_memory_buffer>(
+		table_data.data(), table_data.size()));
+	EXPECT_EQ(index.get_block_count(), 2u);
+	EXPECT_TRUE(index.has_overlapping_ids());
+
+	auto message1 = index.find(block1_low_id);
+	ASSERT_TRUE(message1);
+	EXPECT_EQ(message1->get_encoding(), message_encoding::ansi);
+	EXPECT_EQ(message1->get_ansi(), "abc");
+	EXPECT_TRUE(message1->get_utf8().empty());
+
+	auto message2 = index.find(block1_high_id);
+	ASSERT_TRUE(message2);
+	EXPECT_EQ(message2->get_utf8(), u8"xyz");
+
+	auto message3 = index.find(block2_high_id);
+	ASSERT_TRUE(message3);
+	EXPECT_EQ(message3->get_unicode(), u"abc");
+	auto decoded = message3->decode();
+	const auto* unicode = std::get_if<unicode_message>(&decoded);
+	ASSERT_NE(unicode, nullptr);
+	EXPECT_EQ(unicode->value(), u"abc");
+
+	EXPECT_FALSE(index.find(block1_low_id - 1u));
+	EXPECT_FALSE(index.find(block2_high_id + 1u));
+	EXPECT_FALSE(index.find(block3_low_id));
+}
+
+TEST(MessageTableReaderTests, IndexBlockLimit)
+{
+	message_table_index index(std::make_shared<buffers::input_memory_buffer>(
+		table_data.data(), table_data.size()), { .max_block_count = 1u });
+	EXPECT_EQ(index.get_block_count(), 1u);
+	EXPECT_FALSE(index.has_overlapping_ids());
+	ASSERT_TRUE(index.find(block1_high_id));
+	EXPECT_EQ(index.find(block1_high_id)->get_utf8(), u8"xyz");
+	EXPECT_FALSE(index.find(block2_high_id));
+}
+
+TEST(MessageTableReaderTests, IndexVirtual)
+{
+	auto buf = std::make_shared<buffers::input_memory_buffer>(table_data.data(),
+		table_data.size() - 2u); //last string bytes are virtual
+	auto vbuf = std::make_shared<buffers::input_virtual_buffer>(std::move(buf), 2u);
+	EXPECT_FALSE(message_table_index(vbuf).find(block2_high_id));
+
+	message_table_index index(vbuf, { .allow_virtual_data = true });
+	ASSERT_TRUE(index.find(block2_high_id));
+	EXPECT_EQ(index.find(block2_high_id)->get_unicode(), u"abc");
+}
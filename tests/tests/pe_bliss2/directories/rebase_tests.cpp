@@ -4,9 +4,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <climits>
+#include <vector>
 
 #include "pe_bliss2/core/optional_header.h"
 #include "pe_bliss2/detail/packed_serialization.h"
+#include "pe_bliss2/relocations/compact_relocation_table.h"
 #include "pe_bliss2/relocations/image_rebase.h"
 #include "pe_bliss2/image/image.h"
 
@@ -18,7 +20,37 @@ using namespace pe_bliss;
 namespace
 {
 
-class ImageRebaseTestFixture : public ::testing::Test
+enum class rebase_engine
+{
+	entry,
+	page,
+	parallel_page,
+	compact_entry,
+	compact_page
+};
+
+relocations::compact_relocation_table to_compact(
+	const relocations::base_relocation_list& relocs)
+{
+	relocations::compact_relocation_table result;
+	std::vector<std::uint16_t> words;
+	for (const auto& basereloc : relocs)
+	{
+		words.clear();
+		for (const auto& entry : basereloc.get_relocations())
+		{
+			words.push_back(static_cast<std::uint16_t>(
+				(static_cast<std::uint16_t>(entry.get_type()) << 12u)
+				| entry.get_address()));
+			if (entry.get_param())
+				words.push_back(entry.get_param()->get());
+		}
+		result.add_block(basereloc.get_descriptor()->virtual_address, words);
+	}
+	return result;
+}
+
+class ImageRebaseTestFixture : public ::testing::TestWithParam<rebase_engine>
 {
 public:
 	ImageRebaseTestFixture()
@@ -30,6 +62,37 @@ public:
 		instance.get_optional_header().set_raw_image_base(image_base);
 	}
 
+	template<typename RelocsList>
+	void rebase(const RelocsList& relocs, const relocations::rebase_options& options)
+	{
+		switch (GetParam())
+		{
+		case rebase_engine::entry:
+			relocations::rebase(instance, relocs, options);
+			break;
+		case rebase_engine::page:
+			relocations::rebase_pages(instance, relocs, {
+				.new_base = options.new_base,
+				.ignore_virtual_data = options.ignore_virtual_data });
+			break;
+		case rebase_engine::compact_entry:
+			relocations::rebase(instance, to_compact(relocs), options);
+			break;
+		case rebase_engine::compact_page:
+			relocations::rebase_pages(instance, to_compact(relocs), {
+				.new_base = options.new_base,
+				.ignore_virtual_data = options.ignore_virtual_data,
+				.thread_count = 2u });
+			break;
+		default:
+			relocations::rebase_pages(instance, relocs, {
+				.new_base = options.new_base,
+				.ignore_virtual_data = options.ignore_virtual_data,
+				.thread_count = 3u });
+			break;
+		}
+	}
+
 	void add_relocated_values()
 	{
 		auto& data = instance.get_section_data_list()[0].copied_data();
@@ -106,19 +169,19 @@ public:
 
 } //namespace
 
-TEST_F(ImageRebaseTestFixture, RebaseEmpty)
+TEST_P(ImageRebaseTestFixture, RebaseEmpty)
 {
-	EXPECT_NO_THROW(relocations::rebase(instance,
-		relocations::base_relocation_list{}, { .new_base = new_image_base }));
+	EXPECT_NO_THROW(rebase(relocations::base_relocation_list{},
+		{ .new_base = new_image_base }));
 	EXPECT_EQ(instance.get_section_data_list()[0].copied_data(),
 		std::vector<std::byte>(raw_section_size));
 }
 
-TEST_F(ImageRebaseTestFixture, Rebase)
+TEST_P(ImageRebaseTestFixture, Rebase)
 {
 	add_relocated_values();
-	EXPECT_NO_THROW(relocations::rebase(instance,
-		create_relocation_directory(), { .new_base = new_image_base }));
+	EXPECT_NO_THROW(rebase(create_relocation_directory(),
+		{ .new_base = new_image_base }));
 
 	relocated_values original;
 	relocated_values relocated;
@@ -141,20 +204,20 @@ TEST_F(ImageRebaseTestFixture, Rebase)
 	EXPECT_EQ(original.dir64, relocated.dir64 - delta);
 }
 
-TEST_F(ImageRebaseTestFixture, RebaseInvalid)
+TEST_P(ImageRebaseTestFixture, RebaseInvalid)
 {
 	auto dir = create_relocation_directory();
 	relocations::relocation_entry entry;
 	entry.set_type(relocations::relocation_type::thumb_mov32);
 	dir.emplace_back().get_relocations().emplace_back(entry);
 	expect_throw_pe_error([this, &dir] {
-		relocations::rebase(instance, dir, {});
+		rebase(dir, {});
 	}, relocations::relocation_entry_errc::unsupported_relocation_type);
 	EXPECT_EQ(instance.get_section_data_list()[0].copied_data(),
 		std::vector<std::byte>(raw_section_size));
 }
 
-TEST_F(ImageRebaseTestFixture, RebaseAbsentData)
+TEST_P(ImageRebaseTestFixture, RebaseAbsentData)
 {
 	auto dir = create_relocation_directory();
 
@@ -166,11 +229,11 @@ TEST_F(ImageRebaseTestFixture, RebaseAbsentData)
 	reloc.get_descriptor()->virtual_address = 0x50000u;
 
 	expect_throw_pe_error([this, &dir] {
-		relocations::rebase(instance, dir, { .ignore_virtual_data  = true });
+		rebase(dir, { .ignore_virtual_data  = true });
 	}, relocations::rebase_errc::unable_to_rebase_inexistent_data);
 }
 
-TEST_F(ImageRebaseTestFixture, RebaseVirtualDataError)
+TEST_P(ImageRebaseTestFixture, RebaseVirtualDataError)
 {
 	auto dir = create_relocation_directory();
 
@@ -183,11 +246,11 @@ TEST_F(ImageRebaseTestFixture, RebaseVirtualDataError)
 		= section_rva + virtual_section_size - 3u;
 
 	expect_throw_pe_error([this, &dir] {
-		relocations::rebase(instance, dir, { .ignore_virtual_data = true });
+		rebase(dir, { .ignore_virtual_data = true });
 	}, relocations::rebase_errc::unable_to_rebase_inexistent_data);
 }
 
-TEST_F(ImageRebaseTestFixture, RebaseVirtualDataIgnored)
+TEST_P(ImageRebaseTestFixture, RebaseVirtualDataIgnored)
 {
 	auto dir = create_relocation_directory();
 
@@ -200,10 +263,10 @@ TEST_F(ImageRebaseTestFixture, RebaseVirtualDataIgnored)
 		= section_rva + raw_section_size - 3u;
 
 	expect_throw_pe_error([this, &dir] {
-		relocations::rebase(instance, dir, { .ignore_virtual_data = false });
+		rebase(dir, { .ignore_virtual_data = false });
 	}, relocations::rebase_errc::unable_to_rebase_inexistent_data);
 
-	EXPECT_NO_THROW(relocations::rebase(instance, dir, {
+	EXPECT_NO_THROW(rebase(dir, {
 		.new_base = new_image_base,
 		.ignore_virtual_data = true
 	}));
@@ -216,3 +279,73 @@ TEST_F(ImageRebaseTestFixture, RebaseVirtualDataIgnored)
 	EXPECT_EQ(*--end, static_cast<std::byte>((delta & 0xff00ull) >> (CHAR_BIT * 1u)));
 	EXPECT_EQ(*--end, static_cast<std::byte>((delta & 0xffull)));
 }
+
+TEST_P(ImageRebaseTestFixture, RebaseManyBlocks)
+{
+	auto& data = instance.get_section_data_list()[0].copied_data();
+	for (std::size_t i = 0; i != data.size(); ++i)
+		data[i] = static_cast<std::byte>(i * 7u);
+
+	relocations::base_relocation_list dir(8u);
+	for (std::uint16_t i = 0; i != dir.size(); ++i)
+	{
+		dir[i].get_descriptor()->virtual_address = section_rva;
+		for (std::uint16_t j = 0; j != 32u; ++j)
+		{
+			relocations::relocation_entry entry;
+			entry.set_type(j < 16u || j % 5u == 0u
+				? relocations::relocation_type::dir64
+				: relocations::relocation_type::highlow);
+			entry.set_address(static_cast<std::uint16_t>(i * 0x200u + j * 8u));
+			dir[i].get_relocations().emplace_back(entry);
+		}
+	}
+
+	const auto original = data;
+	auto expected = instance;
+	relocations::rebase(expected, dir, { .new_base = new_image_base });
+	rebase(dir, { .new_base = new_image_base });
+	EXPECT_NE(data, original);
+	EXPECT_EQ(data, expected.get_section_data_list()[0].copied_data());
+	EXPECT_EQ(instance.get_optional_header().get_raw_image_base(), new_image_base);
+}
+
+TEST_P(ImageRebaseTestFixture, RebaseOverlappingBlocks)
+{
+	auto& data = instance.get_section_data_list()[0].copied_data();
+	for (std::size_t i = 0; i != data.size(); ++i)
+		data[i] = static_cast<std::byte>(i * 5u);
+
+	//Blocks share pages, and fixups of neighbouring blocks overlap
+	relocations::base_relocation_list dir(6u);
+	for (std::uint16_t i = 0; i != dir.size(); ++i)
+	{
+		dir[i].get_descriptor()->virtual_address
+			= section_rva + (i % 2u) * 0x400u;
+		for (std::uint16_t j = 0; j != 16u; ++j)
+		{
+			relocations::relocation_entry entry;
+			entry.set_type(relocations::relocation_type::dir64);
+			entry.set_address(static_cast<std::uint16_t>(0x3fcu + j * 4u));
+			dir[i].get_relocations().emplace_back(entry);
+		}
+	}
+
+	const auto original = data;
+	auto expected = instance;
+	relocations::rebase(expected, dir, { .new_base = new_image_base });
+	rebase(dir, { .new_base = new_image_base });
+	EXPECT_NE(data, original);
+	EXPECT_EQ(data, expected.get_section_data_list()[0].copied_data());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+	ImageRebaseTests,
+	ImageRebaseTestFixture,
+	::testing::Values(
+		rebase_engine::entry,
+		rebase_engine::page,
+		rebase_engine::parallel_page,
+		rebase_engine::compact_entry,
+		rebase_engine::compact_page
+	));
@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "buffers/output_memory_buffer.h"
+#include "pe_bliss2/core/data_directories.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/relocations/relocation_directory_builder.h"
+#include "pe_bliss2/relocations/relocation_directory_loader.h"
+#include "pe_bliss2/relocations/relocation_fixup_builder.h"
+
+#include "tests/pe_bliss2/image_helper.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::relocations;
+
+namespace
+{
+constexpr std::uint32_t section_rva = 0x1000u;
+constexpr std::uint32_t directory_rva = 0x1100u;
+
+const std::vector<relocation_fixup> fixups{
+	{ 0x12345008u, relocation_type::dir64 },
+	{ 0x1004u, relocation_type::highlow },
+	{ 0x12345000u, relocation_type::dir64 },
+	{ 0x1ff8u, relocation_type::highadj, 0xabcdu },
+	{ 0x1000u, relocation_type::highlow },
+	{ 0x3010u, relocation_type::low }
+};
+
+base_relocation_list create_expected_list()
+{
+	base_relocation_list list(3u);
+	auto add = [](base_relocation& basereloc, relocation_type type,
+		relocation_entry::address_type address) -> relocation_entry& {
+		auto& entry = basereloc.get_relocations().emplace_back();
+		entry.set_type(type);
+		entry.set_address(address);
+		return entry;
+	};
+
+	list[0].get_descriptor()->virtual_address = 0x1000u;
+	add(list[0], relocation_type::highlow, 0x000u);
+	add(list[0], relocation_type::highlow, 0x004u);
+	add(list[0], relocation_type::highadj, 0xff8u).get_param() = 0xabcdu;
+	list[1].get_descriptor()->virtual_address = 0x3000u;
+	add(list[1], relocation_type::low, 0x010u);
+	list[2].get_descriptor()->virtual_address = 0x12345000u;
+	add(list[2], relocation_type::dir64, 0x000u);
+	add(list[2], relocation_type::dir64, 0x008u);
+	return list;
+}
+
+std::vector<std::byte> build_expected(bool align)
+{
+	auto list = create_expected_list();
+	std::vector<std::byte> result;
+	buffers::output_memory_buffer buf(result);
+	(void)build_new(buf, list, { .directory_rva = directory_rva,
+		.align_base_relocation_structures = align });
+	return result;
+}
+} //namespace
+
+TEST(RelocationFixupBuilderTests, Empty)
+{
+	relocation_fixup_builder builder(std::vector<relocation_fixup>{});
+	EXPECT_EQ(builder.get_built_size(), 0u);
+	EXPECT_EQ(builder.get_block_count(), 0u);
+	EXPECT_TRUE(builder.build().empty());
+}
+
+TEST(RelocationFixupBuilderTests, Build)
+{
+	for (bool align : { true, false })
+	{
+		relocation_fixup_builder builder(fixups,
+			{ .align_base_relocation_structures = align });
+		EXPECT_EQ(builder.get_block_count(), 3u);
+		EXPECT_EQ(builder.get_built_size(),
+			get_built_size(create_expected_list(), {
+				.align_base_relocation_structures = align }));
+		ASSERT_EQ(builder.get_fixups().size(), fixups.size());
+		EXPECT_EQ(builder.get_fixups().front().rva, 0x1000u);
+		EXPECT_EQ(builder.get_fixups().back().rva, 0x12345008u);
+		EXPECT_EQ(builder.build(), build_expected(align));
+	}
+}
+
+TEST(RelocationFixupBuilderTests, BufferTooSmall)
+{
+	relocation_fixup_builder builder(fixups);
+	std::vector<std::byte> buf(builder.get_built_size() - 1u);
+	expect_throw_pe_error([&] { (void)builder.build(buf); },
+		utilities::generic_errc::buffer_overrun);
+}
+
+TEST(RelocationFixupBuilderTests, BuildNew)
+{
+	auto instance = create_test_image({
+		.start_section_rva = section_rva,
+		.sections = { { 0x1000u, 0x1000u } } });
+
+	relocation_fixup_builder builder(fixups, { .directory_rva = directory_rva });
+	auto size = build_new(instance, builder);
+	EXPECT_EQ(size, builder.get_built_size());
+
+	const auto& dir = instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::basereloc);
+	EXPECT_EQ(dir->virtual_address, directory_rva);
+	EXPECT_EQ(dir->size, size);
+
+	auto loaded = load(instance);
+	ASSERT_TRUE(loaded);
+	expect_contains_errors(loaded->errors);
+	ASSERT_EQ(loaded->relocations.size(), 3u);
+	//Padded with an absolute entry
+	ASSERT_EQ(loaded->relocations[1].get_relocations().size(), 2u);
+	EXPECT_EQ(loaded->relocations[1].get_relocations()[1].get_type(),
+		relocation_type::absolute);
+	const auto& highadj = loaded->relocations[0].get_relocations()[2];
+	ASSERT_TRUE(highadj.get_param());
+	EXPECT_EQ(highadj.get_param()->get(), 0xabcdu);
+}
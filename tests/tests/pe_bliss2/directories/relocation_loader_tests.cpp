@@ -3,6 +3,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "pe_bliss2/core/data_directories.h"
 #include "pe_bliss2/relocations/relocation_directory_loader.h"
@@ -243,3 +244,155 @@ TEST_F(RelocationLoaderTestFixture, VirtualDirectory)
 		relocations::relocation_directory_loader_errc::invalid_relocation_block_size,
 		relocations::relocation_directory_loader_errc::unaligned_relocation_entry);
 }
+
+TEST_F(RelocationLoaderTestFixture, CompactAbsentDirectory)
+{
+	EXPECT_FALSE(relocations::load_compact(instance));
+}
+
+TEST_F(RelocationLoaderTestFixture, CompactRelocDirectoryCutHighadj)
+{
+	add_relocation_dir(block1_size + block2_size);
+	add_relocations();
+	auto dir = relocations::load_compact(instance);
+	ASSERT_TRUE(dir);
+	expect_contains_errors(dir->errors,
+		relocations::relocation_directory_loader_errc::unaligned_relocation_entry,
+		relocations::relocation_entry_errc::unsupported_relocation_type,
+		relocations::relocation_entry_errc::relocation_param_is_absent);
+	EXPECT_TRUE(dir->errors.has_error(
+		relocations::relocation_directory_loader_errc::unaligned_relocation_entry, 1u));
+	ASSERT_EQ(dir->relocations.size(), 2u);
+	EXPECT_EQ(dir->relocations.get_word_count(), 1u + block2_elem_types.size() + 1u);
+
+	const auto block1 = dir->relocations[0];
+	EXPECT_EQ(block1.get_virtual_address(), block1_rva);
+	ASSERT_EQ(block1.get_words().size(), 1u);
+	EXPECT_EQ((*block1.get_relocations().begin()).get_type(), block1_elem1_type);
+
+	const auto block2 = dir->relocations[1];
+	EXPECT_EQ(block2.get_virtual_address(), block2_rva);
+	std::size_t i = 0;
+	for (const auto entry : block2.get_relocations())
+	{
+		ASSERT_LT(i, block2_elem_types.size());
+		EXPECT_EQ(entry.get_type(), block2_elem_types[i]);
+		EXPECT_EQ(entry.get_address(), block2_elem_addresses[i]);
+		if (i == 5u)
+		{
+			ASSERT_TRUE(entry.get_param());
+			EXPECT_EQ(*entry.get_param(), block2_highadj1_param);
+		}
+		else
+		{
+			EXPECT_FALSE(entry.get_param());
+		}
+		++i;
+	}
+	EXPECT_EQ(i, block2_elem_types.size());
+}
+
+TEST_F(RelocationLoaderTestFixture, CompactZeroDirectory)
+{
+	add_relocation_dir(block1_size + block2_size);
+	auto dir = relocations::load_compact(instance);
+	ASSERT_TRUE(dir);
+	EXPECT_TRUE(dir->errors.has_any_error(
+		relocations::relocation_directory_loader_errc::invalid_relocation_block_size));
+	EXPECT_TRUE(dir->errors.has_error(
+		relocations::relocation_directory_loader_errc::invalid_directory_size));
+	EXPECT_EQ(dir->relocations.size(), relocations::load(instance)->relocations.size());
+	EXPECT_EQ(dir->relocations.get_word_count(), 0u);
+}
+
+TEST_F(RelocationLoaderTestFixture, CompactVirtualDirectory)
+{
+	add_virtual_relocation_dir();
+	auto dir = relocations::load_compact(instance, { .allow_virtual_data = false });
+	ASSERT_TRUE(dir);
+	expect_contains_errors(dir->errors,
+		relocations::relocation_directory_loader_errc::invalid_relocation_entry);
+	EXPECT_TRUE(dir->relocations.empty());
+
+	dir = relocations::load_compact(instance, { .allow_virtual_data = true });
+	ASSERT_TRUE(dir);
+	expect_contains_errors(dir->errors,
+		relocations::relocation_directory_loader_errc::invalid_relocation_block_size,
+		relocations::relocation_directory_loader_errc::unaligned_relocation_entry);
+	EXPECT_EQ(dir->relocations.size(), 1u);
+}
+
+TEST_F(RelocationLoaderTestFixture, CompactRelocDirectoryCutBlock)
+{
+	//The last highadj entry of block 2 does not fit into the directory
+	add_relocation_dir(block1_size + block2_size - sizeof(std::uint16_t));
+	add_relocations();
+	auto dir = relocations::load_compact(instance);
+	ASSERT_TRUE(dir);
+	expect_contains_errors(dir->errors,
+		relocations::relocation_directory_loader_errc::unaligned_relocation_entry,
+		relocations::relocation_entry_errc::unsupported_relocation_type,
+		relocations::relocation_entry_errc::invalid_relocation_entry);
+	EXPECT_TRUE(dir->errors.has_error(
+		relocations::relocation_entry_errc::invalid_relocation_entry, 1u));
+	ASSERT_EQ(dir->relocations.size(), 2u);
+	EXPECT_EQ(dir->relocations.get_word_count(), 1u + block2_elem_types.size());
+
+	auto full_dir = relocations::load(instance);
+	ASSERT_TRUE(full_dir);
+	ASSERT_EQ(full_dir->relocations.size(), 2u);
+	//load() also keeps an erroneous entry, which does not fit
+	EXPECT_EQ(full_dir->relocations[1].get_relocations().size(),
+		block2_elem_types.size());
+
+	std::size_t i = 0;
+	for (const auto entry : dir->relocations[1].get_relocations())
+	{
+		ASSERT_LT(i, block2_elem_types.size() - 1u);
+		EXPECT_EQ(entry.get_type(), block2_elem_types[i]);
+		EXPECT_EQ(entry.get_address(), block2_elem_addresses[i]);
+		++i;
+	}
+	EXPECT_EQ(i, block2_elem_types.size() - 1u);
+}
+
+TEST_F(RelocationLoaderTestFixture, CompactVirtualTail)
+{
+	static constexpr std::uint32_t first_block_offset = section_raw_size - 28u;
+	static constexpr std::array block_data{
+		//Block 1, physical
+		std::byte{}, std::byte{0x10}, std::byte{}, std::byte{}, //virtual_address
+		std::byte{16}, std::byte{}, std::byte{}, std::byte{}, //size_of_block
+		std::byte{0x01}, std::byte{0x30}, //highlow
+		std::byte{0x02}, std::byte{0x30}, //highlow
+		std::byte{0x03}, std::byte{0x30}, //highlow
+		std::byte{0x04}, std::byte{0x30}, //highlow
+		//Block 2, the last two entries are virtual
+		std::byte{}, std::byte{0x20}, std::byte{}, std::byte{}, //virtual_address
+		std::byte{16}, std::byte{}, std::byte{}, std::byte{}, //size_of_block
+		std::byte{0x05}, std::byte{0x30}, //highlow
+		std::byte{0x06}, std::byte{0x30} //highlow
+	};
+	static_assert(first_block_offset + block_data.size() == section_raw_size);
+
+	auto& data = instance.get_section_data_list()[0].copied_data();
+	std::copy(block_data.begin(), block_data.end(), data.begin() + first_block_offset);
+	instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::basereloc).get()
+		= { .virtual_address = section_rva + first_block_offset, .size = 32u };
+
+	auto dir = relocations::load_compact(instance, { .allow_virtual_data = false });
+	ASSERT_TRUE(dir);
+	expect_contains_errors(dir->errors,
+		relocations::relocation_entry_errc::invalid_relocation_entry);
+	ASSERT_EQ(dir->relocations.size(), 2u);
+	EXPECT_TRUE(dir->relocations[1].get_words().empty());
+
+	dir = relocations::load_compact(instance, { .allow_virtual_data = true });
+	ASSERT_TRUE(dir);
+	expect_contains_errors(dir->errors);
+	ASSERT_EQ(dir->relocations.size(), 2u);
+	const auto words = dir->relocations[1].get_words();
+	EXPECT_EQ(std::vector<std::uint16_t>(words.begin(), words.end()),
+		(std::vector<std::uint16_t>{ 0x3005u, 0x3006u, 0u, 0u }));
+}
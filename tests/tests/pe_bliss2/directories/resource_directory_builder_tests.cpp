@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "buffers/output_memory_buffer.h"
+#include "pe_bliss2/core/data_directories.h"
+#include "pe_bliss2/image/image.h"
+#include "pe_bliss2/resources/resource_directory.h"
+#include "pe_bliss2/resources/resource_directory_builder.h"
+#include "pe_bliss2/resources/resource_directory_loader.h"
+#include "pe_bliss2/resources/resource_types.h"
+
+#include "tests/pe_bliss2/image_helper.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::resources;
+
+namespace
+{
+constexpr std::uint32_t section_rva = 0x1000u;
+constexpr std::uint32_t directory_rva = 0x1100u;
+constexpr resource_id_type language = 1033u;
+
+void add_resource(resource_directory& root, const std::u16string& name,
+	std::vector<std::byte> data)
+{
+	auto& type_dir = root.try_emplace_entry_by_id(
+		static_cast<resource_id_type>(resource_type::rcdata),
+		directory_entry_contents::directory).get_directory();
+	auto& name_dir = type_dir.try_emplace_entry_by_name(name,
+		directory_entry_contents::directory).get_directory();
+	name_dir.try_emplace_entry_by_id(language, directory_entry_contents::data)
+		.get_data().get_raw_data().copied_data() = std::move(data);
+}
+
+resource_directory create_directory()
+{
+	resource_directory root;
+	add_resource(root, u"B", { std::byte{1}, std::byte{2}, std::byte{3} });
+	add_resource(root, u"A", { std::byte{1}, std::byte{2}, std::byte{3} });
+	auto& type_dir = root.get_entries().front().get_directory();
+	type_dir.try_emplace_entry_by_id(5u, directory_entry_contents::directory)
+		.get_directory().try_emplace_entry_by_id(language, directory_entry_contents::data)
+		.get_data().get_raw_data().copied_data() = {
+			std::byte{4}, std::byte{5}, std::byte{6}, std::byte{7}, std::byte{8} };
+	return root;
+}
+
+const resource_data_entry_details& get_data(
+	const resource_directory_entry_details& entry)
+{
+	EXPECT_TRUE(entry.has_directory());
+	const auto& language_dir = entry.get_directory();
+	expect_contains_errors(language_dir);
+	EXPECT_EQ(language_dir.get_entries().size(), 1u);
+	return language_dir.entry_by_id(language).get_data();
+}
+} //namespace
+
+TEST(ResourceDirectoryBuilderTests, BuildNew)
+{
+	auto instance = create_test_image({
+		.start_section_rva = section_rva,
+		.sections = { { 0x2000u, 0x2000u } } });
+
+	auto directory = create_directory();
+	auto size = get_built_size(directory, { .directory_rva = directory_rva });
+	EXPECT_EQ(build_new(instance, directory, { .directory_rva = directory_rva }), size);
+	EXPECT_TRUE(directory.is_sorted());
+
+	const auto& dir = instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::resource);
+	EXPECT_EQ(dir->virtual_address, directory_rva);
+	EXPECT_EQ(dir->size, size);
+
+	auto loaded = load(instance, { .copy_raw_data = true });
+	ASSERT_TRUE(loaded);
+	expect_contains_errors(*loaded);
+	ASSERT_EQ(loaded->get_entries().size(), 1u);
+	const auto& type_dir = loaded->entry_by_id(
+		static_cast<resource_id_type>(resource_type::rcdata)).get_directory();
+	expect_contains_errors(type_dir);
+	ASSERT_EQ(type_dir.get_entries().size(), 3u);
+	EXPECT_EQ(type_dir.get_descriptor()->number_of_named_entries, 2u);
+	EXPECT_EQ(type_dir.get_descriptor()->number_of_id_entries, 1u);
+
+	const auto& a = get_data(type_dir.get_entries()[0]);
+	const auto& b = get_data(type_dir.get_entries()[1]);
+	const auto& id = get_data(type_dir.get_entries()[2]);
+	EXPECT_EQ(type_dir.get_entries()[0].get_name().value(), u"A");
+	EXPECT_EQ(type_dir.get_entries()[1].get_name().value(), u"B");
+	EXPECT_EQ(type_dir.get_entries()[2].get_id(), 5u);
+
+	EXPECT_EQ(a.get_descriptor()->offset_to_data, b.get_descriptor()->offset_to_data);
+	EXPECT_NE(a.get_descriptor()->offset_to_data, id.get_descriptor()->offset_to_data);
+	EXPECT_EQ(a.get_descriptor()->offset_to_data % 8u, 0u);
+	EXPECT_EQ(id.get_descriptor()->offset_to_data % 8u, 0u);
+	EXPECT_EQ(b.get_raw_data().copied_data(),
+		(std::vector{ std::byte{1}, std::byte{2}, std::byte{3} }));
+	EXPECT_EQ(id.get_raw_data().copied_data(), (std::vector{
+		std::byte{4}, std::byte{5}, std::byte{6}, std::byte{7}, std::byte{8} }));
+}
+
+TEST(ResourceDirectoryBuilderTests, BuildNewWithoutDeduplication)
+{
+	auto directory = create_directory();
+	auto deduplicated_size = get_built_size(directory, {});
+	auto full_size = get_built_size(directory, { .deduplicate_data = false });
+	EXPECT_EQ(full_size - deduplicated_size, 8u);
+	EXPECT_EQ(get_built_size(directory, { .data_alignment = 1u,
+		.deduplicate_data = false }), full_size - 8u - 5u);
+
+	std::vector<std::byte> data;
+	buffers::output_memory_buffer buf(data);
+	EXPECT_EQ(build_new(buf, directory, { .deduplicate_data = false }), full_size);
+	EXPECT_EQ(data.size(), full_size);
+}
+
+TEST(ResourceDirectoryBuilderTests, BuildNewErrors)
+{
+	auto directory = create_directory();
+	expect_throw_pe_error([&directory] {
+		(void)get_built_size(directory, { .data_alignment = 3u });
+	}, resource_directory_builder_errc::invalid_data_alignment);
+
+	directory.get_entries().emplace_back();
+	std::vector<std::byte> data;
+	buffers::output_memory_buffer buf(data);
+	expect_throw_pe_error([&directory, &buf] {
+		(void)build_new(buf, directory, {});
+	}, resource_directory_builder_errc::invalid_entry);
+}
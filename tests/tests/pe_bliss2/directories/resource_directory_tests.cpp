@@ -192,3 +192,89 @@ TEST(ResourceDirectoryTests, EmplaceDataEntryByName)
 		(void)dir.try_emplace_entry_by_name(directory_entry_contents::directory, u"abc");
 	}, resource_directory_errc::entry_does_not_contain_directory);
 }
+
+TEST(ResourceDirectoryTests, SortedEntryLookup)
+{
+	resource_directory dir;
+	dir.get_entries().emplace_back().get_name_or_id() = resource_name_type(u"abc");
+	dir.get_entries().emplace_back().get_name_or_id() = resource_name_type(u"def");
+	dir.get_entries().emplace_back().get_name_or_id() = 1u;
+	dir.get_entries().emplace_back().get_name_or_id() = 3u;
+	dir.get_entries().emplace_back().get_name_or_id() = 5u;
+	dir.set_sorted(true);
+	EXPECT_TRUE(dir.has_sorted_entries());
+
+	const auto& const_dir = dir;
+	const auto& entries = const_dir.get_entries();
+	EXPECT_EQ(const_dir.entry_iterator_by_id(1u), entries.begin() + 2u);
+	EXPECT_EQ(const_dir.entry_iterator_by_id(5u), entries.begin() + 4u);
+	EXPECT_EQ(const_dir.entry_iterator_by_id(0u), entries.end());
+	EXPECT_EQ(const_dir.entry_iterator_by_id(4u), entries.end());
+	EXPECT_EQ(const_dir.entry_iterator_by_id(6u), entries.end());
+
+	EXPECT_EQ(const_dir.entry_iterator_by_name(u"abc"), entries.begin());
+	EXPECT_EQ(const_dir.entry_iterator_by_name(u"def"), entries.begin() + 1u);
+	EXPECT_EQ(const_dir.entry_iterator_by_name(u"aaa"), entries.end());
+	EXPECT_EQ(const_dir.entry_iterator_by_name(u"abd"), entries.end());
+	EXPECT_EQ(const_dir.entry_iterator_by_name(u"xyz"), entries.end());
+	EXPECT_TRUE(dir.is_sorted());
+}
+
+TEST(ResourceDirectoryTests, SortedEntryLookupNoNameOrId)
+{
+	resource_directory dir;
+	dir.get_entries().emplace_back().get_name_or_id() = resource_name_type(u"abc");
+	dir.get_entries().emplace_back();
+	dir.get_entries().emplace_back().get_name_or_id() = 1u;
+	dir.set_sorted(true);
+	EXPECT_TRUE(dir.has_sorted_entries());
+
+	const auto& const_dir = dir;
+	const auto& entries = const_dir.get_entries();
+	EXPECT_EQ(const_dir.entry_iterator_by_id(1u), entries.begin() + 2u);
+	EXPECT_EQ(const_dir.entry_iterator_by_id(0u), entries.end());
+	EXPECT_EQ(const_dir.entry_iterator_by_name(u"abc"), entries.begin());
+	EXPECT_EQ(const_dir.entry_iterator_by_name(u"abd"), entries.end());
+}
+
+TEST(ResourceDirectoryTests, UnsortedEntries)
+{
+	resource_directory dir;
+	dir.get_entries().emplace_back().get_name_or_id() = 1u;
+	dir.get_entries().emplace_back();
+	EXPECT_FALSE(dir.has_sorted_entries());
+	dir.get_entries().back().get_name_or_id() = resource_name_type(u"abc");
+	EXPECT_FALSE(dir.has_sorted_entries());
+}
+
+TEST(ResourceDirectoryTests, MutableEntriesResetSorted)
+{
+	resource_directory dir;
+	dir.set_sorted(true);
+	(void)std::as_const(dir).get_entries();
+	EXPECT_TRUE(dir.is_sorted());
+	dir.get_entries().emplace_back().get_name_or_id() = 1u;
+	EXPECT_FALSE(dir.is_sorted());
+}
+
+TEST(ResourceDirectoryTests, SortedEmplace)
+{
+	resource_directory dir;
+	dir.set_sorted(true);
+	(void)dir.try_emplace_entry_by_id(5u, directory_entry_contents::data);
+	(void)dir.try_emplace_entry_by_name(u"def", directory_entry_contents::data);
+	(void)dir.try_emplace_entry_by_id(1u, directory_entry_contents::data);
+	(void)dir.try_emplace_entry_by_name(directory_entry_contents::data, u"abc");
+	(void)dir.try_emplace_entry_by_id(3u, directory_entry_contents::data);
+	EXPECT_TRUE(dir.is_sorted());
+
+	const auto& entries = dir.get_entries();
+	ASSERT_EQ(entries.size(), 5u);
+	EXPECT_EQ(entries[0].get_name().value(), u"abc");
+	EXPECT_EQ(entries[1].get_name().value(), u"def");
+	EXPECT_EQ(entries[2].get_id(), 1u);
+	EXPECT_EQ(entries[3].get_id(), 3u);
+	EXPECT_EQ(entries[4].get_id(), 5u);
+	EXPECT_EQ(dir.try_entry_by_id(3u), &entries[3]);
+	EXPECT_EQ(dir.try_entry_by_name(u"def"), &entries[1]);
+}
@@ -0,0 +1,129 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <string_view>
+
+#include "pe_bliss2/resources/resource_directory.h"
+#include "pe_bliss2/resources/resource_index.h"
+#include "pe_bliss2/resources/resource_types.h"
+
+using namespace pe_bliss::resources;
+
+namespace
+{
+constexpr resource_id_type lang1 = 1033u;
+constexpr resource_id_type lang2 = 1049u;
+
+resource_data_entry& emplace_resource(resource_directory& root, resource_type type,
+	resource_id_type id, resource_id_type language)
+{
+	return root.try_emplace_entry_by_id(static_cast<resource_id_type>(type),
+		directory_entry_contents::directory).get_directory()
+		.try_emplace_entry_by_id(id, directory_entry_contents::directory).get_directory()
+		.try_emplace_entry_by_id(language, directory_entry_contents::data).get_data();
+}
+
+resource_data_entry& emplace_resource(resource_directory& root, resource_type type,
+	std::u16string_view name, resource_id_type language)
+{
+	return root.try_emplace_entry_by_id(static_cast<resource_id_type>(type),
+		directory_entry_contents::directory).get_directory()
+		.try_emplace_entry_by_name(name, directory_entry_contents::directory).get_directory()
+		.try_emplace_entry_by_id(language, directory_entry_contents::data).get_data();
+}
+} //namespace
+
+TEST(ResourceIndexTests, Empty)
+{
+	resource_directory root;
+	resource_index index(root);
+	EXPECT_TRUE(index.get_entries().empty());
+	EXPECT_EQ(index.find(resource_type::icon, 1u, lang1), nullptr);
+	EXPECT_TRUE(index.find_all(resource_type::icon).empty());
+}
+
+TEST(ResourceIndexTests, Lookup)
+{
+	resource_directory root;
+	emplace_resource(root, resource_type::string, 2u, lang2);
+	emplace_resource(root, resource_type::string, 2u, lang1);
+	emplace_resource(root, resource_type::icon, 2u, lang1);
+	emplace_resource(root, resource_type::icon, 1u, lang1);
+	emplace_resource(root, resource_type::icon, u"main", lang1);
+	emplace_resource(root, resource_type::string, 3u, lang1);
+	//Data on the name level is not indexed
+	(void)root.try_emplace_entry_by_id(static_cast<resource_id_type>(resource_type::bitmap),
+		directory_entry_contents::directory).get_directory()
+		.try_emplace_entry_by_id(1u, directory_entry_contents::data);
+
+	const auto& string2 = emplace_resource(root, resource_type::string, 2u, lang2);
+	const auto& string1 = emplace_resource(root, resource_type::string, 2u, lang1);
+	const auto& icon2 = emplace_resource(root, resource_type::icon, 2u, lang1);
+	const auto& icon1 = emplace_resource(root, resource_type::icon, 1u, lang1);
+	const auto& named = emplace_resource(root, resource_type::icon, u"main", lang1);
+
+	resource_index index(root);
+	ASSERT_EQ(index.get_entries().size(), 6u);
+
+	EXPECT_EQ(index.find(resource_type::string, 2u, lang1), &string1);
+	EXPECT_EQ(index.find(resource_type::string, 2u, lang2), &string2);
+	EXPECT_EQ(index.find(resource_type::icon, 1u, lang1), &icon1);
+	EXPECT_EQ(index.find(resource_type::icon, u"main", lang1), &named);
+	EXPECT_EQ(index.find(resource_type::icon, u"main", lang2), nullptr);
+	EXPECT_EQ(index.find(resource_type::icon, 3u, lang1), nullptr);
+	EXPECT_EQ(index.find(resource_type::bitmap, 1u, lang1), nullptr);
+
+	auto languages = index.find_all(resource_type::string, 2u);
+	ASSERT_EQ(languages.size(), 2u);
+	EXPECT_EQ(languages[0].language, lang1);
+	EXPECT_EQ(languages[0].data, &string1);
+	EXPECT_EQ(languages[1].language, lang2);
+	EXPECT_EQ(languages[1].data, &string2);
+
+	auto icons = index.find_all(resource_type::icon);
+	ASSERT_EQ(icons.size(), 3u);
+	EXPECT_EQ(icons[0].data, &icon1);
+	EXPECT_EQ(icons[1].data, &icon2);
+	EXPECT_EQ(icons[2].data, &named);
+
+	auto named_icons = index.find_all(resource_type::icon, u"main");
+	ASSERT_EQ(named_icons.size(), 1u);
+	EXPECT_EQ(named_icons[0].data, &named);
+
+	EXPECT_TRUE(index.find_all(resource_type::string, u"main").empty());
+	EXPECT_TRUE(index.find_all(resource_type::cursor).empty());
+}
+
+TEST(ResourceIndexTests, NamedType)
+{
+	resource_directory root;
+	const auto& icon = emplace_resource(root, resource_type::icon, 1u, lang1);
+	auto& mui_type = root.try_emplace_entry_by_name(u"MUI",
+		directory_entry_contents::directory).get_directory();
+	const auto& mui = mui_type.try_emplace_entry_by_id(1u,
+		directory_entry_contents::directory).get_directory()
+		.try_emplace_entry_by_id(lang1, directory_entry_contents::data).get_data();
+	const auto& named_mui = mui_type.try_emplace_entry_by_name(u"config",
+		directory_entry_contents::directory).get_directory()
+		.try_emplace_entry_by_id(lang2, directory_entry_contents::data).get_data();
+
+	resource_index index(root);
+	ASSERT_EQ(index.get_entries().size(), 3u);
+	//ID types go before named types
+	EXPECT_EQ(index.get_entries()[0].data, &icon);
+
+	EXPECT_EQ(index.find(u"MUI", 1u, lang1), &mui);
+	EXPECT_EQ(index.find(u"MUI", u"config", lang2), &named_mui);
+	EXPECT_EQ(index.find(u"MUI", u"config", lang1), nullptr);
+	EXPECT_EQ(index.find(u"MUX", 1u, lang1), nullptr);
+	EXPECT_EQ(index.find(resource_type::icon, 1u, lang1), &icon);
+
+	auto mui_entries = index.find_all(u"MUI");
+	ASSERT_EQ(mui_entries.size(), 2u);
+	EXPECT_EQ(mui_entries[0].data, &mui);
+	EXPECT_EQ(mui_entries[1].data, &named_mui);
+	EXPECT_EQ(index.find_all(u"MUI", 1u).size(), 1u);
+	EXPECT_EQ(index.find_all(u"MUI", u"config").size(), 1u);
+	EXPECT_TRUE(index.find_all(u"MUI", 2u).empty());
+	EXPECT_EQ(index.find_all(resource_type::icon).size(), 1u);
+}
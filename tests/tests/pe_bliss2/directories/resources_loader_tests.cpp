@@ -4,6 +4,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
@@ -77,12 +78,26 @@ public:
 			dir0_entry1_name);
 	}
 
+	void add_shared_directory_entry()
+	{
+		//dir 0 - entry 1 offset_to_data_or_directory - dir 1
+		static constexpr std::array dir0_entry1_dir1{
+			std::byte{dir0_entry0_dir1_offset & 0xffu},
+			std::byte{(dir0_entry0_dir1_offset >> 8u) & 0xffu},
+			std::byte{(dir0_entry0_dir1_offset >> 16u) & 0xffu},
+			std::byte{(0x80u | (dir0_entry0_dir1_offset >> 24u)) & 0xffu},
+		};
+		add_data(directory_rva + resource_dir0.size() - dir0_entry1_dir1.size(),
+			dir0_entry1_dir1);
+	}
+
 public:
 	void validate_resources(const std::optional<resource_directory_details>& dir0,
 		bool copy_raw_data)
 	{
 		ASSERT_TRUE(dir0);
 		expect_contains_errors(*dir0, resource_directory_loader_errc::unsorted_entries);
+		EXPECT_FALSE(dir0->is_sorted());
 
 		const auto& dir0_entries = dir0->get_entries();
 		ASSERT_EQ(dir0_entries.size(), number_of_named_entries_0 + number_of_id_entries_0);
@@ -104,6 +119,7 @@ public:
 		expect_contains_errors(*dir1,
 			resource_directory_loader_errc::invalid_number_of_named_and_id_entries);
 		ASSERT_NE(dir1, nullptr);
+		EXPECT_TRUE(dir1->is_sorted());
 		const auto& dir1_entries = dir1->get_entries();
 		ASSERT_EQ(dir1_entries.size(), number_of_named_entries_1 + number_of_id_entries_1);
 		expect_contains_errors(dir1_entries[0]);
@@ -290,3 +306,205 @@ TEST_F(ResourcesLoaderTestFixture, VirtualDir)
 	EXPECT_TRUE(dir->get_entries().empty());
 	EXPECT_EQ(dir->get_descriptor().physical_size(), physical_part_size);
 }
+
+TEST_F(ResourcesLoaderTestFixture, UnreadableEntryName)
+{
+	//Named entry first, then ID entry, the name is out of the physical data
+	static constexpr std::size_t header_size = 16u;
+	static constexpr std::size_t entry_size = 8u;
+	static constexpr std::uint32_t name_offset = section_raw_size + 0x100u;
+	auto dir0 = resource_dir0;
+	std::rotate(dir0.begin() + header_size, dir0.begin() + header_size + entry_size,
+		dir0.end());
+	dir0[header_size] = std::byte{ name_offset & 0xffu };
+	dir0[header_size + 1u] = std::byte{ (name_offset >> 8u) & 0xffu };
+
+	add_resource_dir();
+	add_resource_dir_descriptors();
+	add_data(directory_rva, dir0);
+
+	const auto dir = resources::load(instance);
+	ASSERT_TRUE(dir);
+	//The entry with the unreadable name is not counted as named
+	expect_contains_errors(*dir,
+		resource_directory_loader_errc::invalid_number_of_named_and_id_entries);
+	EXPECT_FALSE(dir->is_sorted());
+	EXPECT_TRUE(dir->has_sorted_entries());
+
+	const auto& entries = dir->get_entries();
+	ASSERT_EQ(entries.size(), 2u);
+	EXPECT_TRUE(std::holds_alternative<std::monostate>(entries[0].get_name_or_id()));
+	expect_contains_errors(entries[0],
+		resource_directory_loader_errc::invalid_resource_directory_entry_name);
+	EXPECT_EQ(dir->entry_iterator_by_id(dir0_entry0_id), entries.begin() + 1u);
+	EXPECT_EQ(dir->entry_iterator_by_id(dir1_entry0_id), entries.end());
+}
+
+TEST_F(ResourcesLoaderTestFixture, SharedDirectory)
+{
+	add_resource_dir();
+	add_resource_dir_descriptors();
+	add_shared_directory_entry();
+
+	auto dir = resources::load(instance);
+	ASSERT_TRUE(dir);
+	const auto& entries = dir->get_entries();
+	ASSERT_EQ(entries.size(), 2u);
+	for (const auto& entry : entries)
+	{
+		ASSERT_TRUE(entry.has_directory());
+		const auto& shared_entries = entry.get_directory().get_entries();
+		ASSERT_EQ(shared_entries.size(), 1u);
+		const auto* loop = std::get_if<rva_type>(
+			&shared_entries[0].get_data_or_directory());
+		ASSERT_NE(loop, nullptr);
+		EXPECT_EQ(*loop, directory_rva);
+	}
+}
+
+TEST_F(ResourcesLoaderTestFixture, SharedDirectoryLoadedOnce)
+{
+	add_resource_dir();
+	add_resource_dir_descriptors();
+	add_shared_directory_entry();
+
+	auto dir = resources::load(instance, { .load_shared_directories_once = true });
+	ASSERT_TRUE(dir);
+	const auto& entries = dir->get_entries();
+	ASSERT_EQ(entries.size(), 2u);
+	EXPECT_TRUE(entries[0].has_directory());
+	const auto* shared = std::get_if<rva_type>(&entries[1].get_data_or_directory());
+	ASSERT_NE(shared, nullptr);
+	EXPECT_EQ(*shared, directory_rva + dir0_entry0_dir1_offset);
+}
+
+TEST_F(ResourcesLoaderTestFixture, LazySharedDirectory)
+{
+	add_resource_dir();
+	add_resource_dir_descriptors();
+	add_shared_directory_entry();
+
+	auto dir = resources::load_lazy(instance);
+	ASSERT_TRUE(dir);
+	const auto& entries = dir->get_root().get_entries();
+	ASSERT_EQ(entries.size(), 2u);
+	for (const auto& entry : entries)
+	{
+		const auto& shared_entries = dir->get_directory(entry).get_entries();
+		ASSERT_EQ(shared_entries.size(), 1u);
+		const auto* loop = std::get_if<rva_type>(&dir->resolve(shared_entries[0]));
+		ASSERT_NE(loop, nullptr);
+		EXPECT_EQ(*loop, directory_rva);
+	}
+}
+
+TEST_F(ResourcesLoaderTestFixture, MaxTotalEntries)
+{
+	add_resource_dir();
+	add_resource_dir_descriptors();
+	auto dir = resources::load(instance, { .max_total_entries = 1u });
+	ASSERT_TRUE(dir);
+	expect_contains_errors(*dir,
+		resource_directory_loader_errc::too_many_entries,
+		resource_directory_loader_errc::invalid_number_of_named_and_id_entries);
+	ASSERT_EQ(dir->get_entries().size(), 1u);
+	const auto& dir1 = dir->get_entries()[0].get_directory();
+	expect_contains_errors(dir1,
+		resource_directory_loader_errc::too_many_entries,
+		resource_directory_loader_errc::invalid_number_of_named_and_id_entries);
+	EXPECT_TRUE(dir1.get_entries().empty());
+}
+
+TEST_F(ResourcesLoaderTestFixture, MaxDepth)
+{
+	add_resource_dir();
+	add_resource_dir_descriptors();
+	auto dir = resources::load(instance, { .max_depth = 0u });
+	ASSERT_TRUE(dir);
+	expect_contains_errors(*dir, resource_directory_loader_errc::unsorted_entries);
+	ASSERT_EQ(dir->get_entries().size(), 2u);
+	const auto& dir1 = dir->get_entries()[0].get_directory();
+	expect_contains_errors(dir1,
+		resource_directory_loader_errc::too_deep_directory_tree);
+	EXPECT_TRUE(dir1.get_entries().empty());
+}
+
+TEST_F(ResourcesLoaderTestFixture, LazyAbsentDirectory)
+{
+	EXPECT_FALSE(resources::load_lazy(instance));
+}
+
+TEST_F(ResourcesLoaderTestFixture, LazyDirectory)
+{
+	add_resource_dir();
+	add_resource_dir_descriptors();
+	auto dir = resources::load_lazy(instance);
+	ASSERT_TRUE(dir);
+	const auto& root = dir->get_root();
+	expect_contains_errors(root, resource_directory_loader_errc::unsorted_entries);
+	const auto& entries = root.get_entries();
+	ASSERT_EQ(entries.size(), number_of_named_entries_0 + number_of_id_entries_0);
+	EXPECT_EQ(entries[1].get_name().value(), u"abc");
+	EXPECT_FALSE(dir->is_resolved(entries[0]));
+	EXPECT_FALSE(dir->is_resolved(entries[1]));
+	EXPECT_FALSE(entries[0].has_directory());
+	EXPECT_FALSE(entries[1].has_data());
+
+	const auto& dir1 = dir->get_directory(entries[0]);
+	EXPECT_TRUE(dir->is_resolved(entries[0]));
+	EXPECT_FALSE(dir->is_resolved(entries[1]));
+	expect_contains_errors(dir1,
+		resource_directory_loader_errc::invalid_number_of_named_and_id_entries);
+	ASSERT_EQ(dir1.get_entries().size(), 1u);
+	EXPECT_EQ(dir1.get_entries()[0].get_id(), dir1_entry0_id);
+	const auto* dir1_loop0 = std::get_if<rva_type>(
+		&dir->resolve(dir1.get_entries()[0]));
+	ASSERT_NE(dir1_loop0, nullptr);
+	EXPECT_EQ(*dir1_loop0, directory_rva);
+
+	const auto& data1 = dir->get_data(entries[1]);
+	expect_contains_errors(data1);
+	std::array<std::byte, resource_data.size()> data{};
+	ASSERT_EQ(data1.get_raw_data().data()->read(0,
+		resource_data.size(), data.data()), resource_data.size());
+	EXPECT_EQ(data, resource_data);
+
+	EXPECT_EQ(&dir->resolve_all(), &root);
+	expect_contains_errors(root, resource_directory_loader_errc::unsorted_entries);
+}
+
+TEST_F(ResourcesLoaderTestFixture, LazyDirectoryResolveAll)
+{
+	add_resource_dir();
+	add_resource_dir_descriptors();
+	auto dir = resources::load_lazy(instance);
+	ASSERT_TRUE(dir);
+	const auto& root = dir->resolve_all();
+	ASSERT_EQ(root.get_entries().size(), 2u);
+	EXPECT_TRUE(root.get_entries()[0].has_directory());
+	EXPECT_TRUE(root.get_entries()[1].has_data());
+	EXPECT_TRUE(dir->is_resolved(root.get_entries()[0].get_directory().get_entries()[0]));
+}
+
+TEST_F(ResourcesLoaderTestFixture, LazyDirectoryInvalidSize)
+{
+	static_assert(!std::is_copy_constructible_v<lazy_resource_directory>);
+	static_assert(!std::is_copy_assignable_v<lazy_resource_directory>);
+
+	add_resource_dir();
+	instance.get_data_directories().get_directory(
+		core::data_directories::directory_type::resource)->size
+		= dir0_entry1_data_offset;
+	add_resource_dir_descriptors();
+	auto dir = resources::load_lazy(instance);
+	ASSERT_TRUE(dir);
+	expect_contains_errors(dir->get_root(),
+		resource_directory_loader_errc::unsorted_entries);
+
+	const auto& root = dir->resolve_all();
+	expect_contains_errors(root,
+		resource_directory_loader_errc::unsorted_entries,
+		resource_directory_loader_errc::invalid_directory_size);
+	ASSERT_NE(root.get_errors(), nullptr);
+	EXPECT_EQ(root.get_errors()->size(), 2u);
+}
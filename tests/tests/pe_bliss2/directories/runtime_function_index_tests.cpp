@@ -0,0 +1,136 @@
+#include "pe_bliss2/exceptions/runtime_function_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::exceptions;
+
+namespace
+{
+x64::runtime_function create_x64_function(rva_type begin, rva_type end)
+{
+	x64::runtime_function func;
+	func.get_descriptor()->begin_address = begin;
+	func.get_descriptor()->end_address = end;
+	return func;
+}
+
+void chain(x64::runtime_function& func, rva_type begin, rva_type end)
+{
+	func.get_unwind_info().get_descriptor()->flags_and_version
+		= static_cast<std::uint8_t>(x64::unwind_flags::chaininfo << 3u);
+	auto parent = std::make_unique<x64::runtime_function>(
+		create_x64_function(begin, end));
+	func.get_additional_info() = std::move(parent);
+}
+
+std::vector<x64::runtime_function> create_x64_list()
+{
+	std::vector<x64::runtime_function> list;
+	list.emplace_back(create_x64_function(0x1000u, 0x1010u));
+	list.emplace_back(create_x64_function(0x1010u, 0x1100u));
+	//Gap
+	list.emplace_back(create_x64_function(0x1200u, 0x3000u));
+	list.emplace_back(create_x64_function(0x5000u, 0x5004u));
+	chain(list.emplace_back(create_x64_function(0x5100u, 0x5200u)),
+		0x1200u, 0x3000u);
+	//Chained to absent function
+	chain(list.emplace_back(create_x64_function(0x5200u, 0x5300u)),
+		0x4000u, 0x4010u);
+	return list;
+}
+} //namespace
+
+class RuntimeFunctionIndexTests : public ::testing::TestWithParam<bool>
+{
+};
+
+TEST_P(RuntimeFunctionIndexTests, X64Find)
+{
+	auto list = create_x64_list();
+	for (bool sorted : { true, false })
+	{
+		if (!sorted)
+			std::swap(list[0], list[4]);
+
+		x64::runtime_function_index index(list, { .build_page_table = GetParam() });
+		EXPECT_EQ(index.has_page_table(), GetParam());
+		EXPECT_EQ(&index.get_runtime_function_list(), &list);
+
+		auto begin_of = [&index](rva_type rva) -> std::int64_t {
+			const auto* func = index.find(rva);
+			return func ? std::int64_t{ func->get_descriptor()->begin_address } : -1;
+		};
+		EXPECT_EQ(begin_of(0x0u), -1);
+		EXPECT_EQ(begin_of(0xfffu), -1);
+		EXPECT_EQ(begin_of(0x1000u), 0x1000);
+		EXPECT_EQ(begin_of(0x100fu), 0x1000);
+		EXPECT_EQ(begin_of(0x1010u), 0x1010);
+		EXPECT_EQ(begin_of(0x1150u), -1);
+		EXPECT_EQ(begin_of(0x2fffu), 0x1200);
+		EXPECT_EQ(begin_of(0x3000u), -1);
+		EXPECT_EQ(begin_of(0x5003u), 0x5000);
+		EXPECT_EQ(begin_of(0x52ffu), 0x5200);
+		EXPECT_EQ(begin_of(0x5300u), -1);
+		EXPECT_EQ(begin_of(0xffffffffu), -1);
+
+		ASSERT_NE(index.find_by_begin_rva(0x1200u), nullptr);
+		EXPECT_EQ(index.find_by_begin_rva(0x1201u), nullptr);
+	}
+}
+
+TEST_P(RuntimeFunctionIndexTests, X64Chained)
+{
+	const auto list = create_x64_list();
+	x64::runtime_function_index index(list, { .build_page_table = GetParam() });
+	EXPECT_EQ(x64::find_primary_function(index, 0x5150u), &list[2]);
+	EXPECT_EQ(x64::find_primary_function(index, list[4]), &list[2]);
+	EXPECT_EQ(x64::find_primary_function(index, 0x1005u), &list[0]);
+	EXPECT_EQ(x64::find_primary_function(index, 0x5250u), nullptr);
+	EXPECT_EQ(x64::find_primary_function(index, 0x4000u), nullptr);
+
+	auto broken = create_x64_function(0x6000u, 0x6010u);
+	chain(broken, 0x1000u, 0x1010u);
+	broken.get_additional_info() = {};
+	EXPECT_EQ(x64::find_primary_function(index, broken), nullptr);
+}
+
+TEST_P(RuntimeFunctionIndexTests, Arm64Find)
+{
+	std::vector<arm64::runtime_function> list(3u);
+	list[0].get_descriptor()->begin_address = 0x1000u;
+	//Packed, function length is 0x10 * 4 bytes
+	list[0].get_unwind_info().emplace<arm64::packed_unwind_data>(
+		(0x10u << 2u) | 1u);
+	list[1].get_descriptor()->begin_address = 0x2000u;
+	list[1].get_unwind_info().emplace<arm64::extended_unwind_record>()
+		.set_function_length(0x100u);
+	//No unwind info
+	list[2].get_descriptor()->begin_address = 0x3000u;
+
+	arm64::runtime_function_index index(list, { .build_page_table = GetParam() });
+	EXPECT_EQ(index.find(0x1000u), &list[0]);
+	EXPECT_EQ(index.find(0x103fu), &list[0]);
+	EXPECT_EQ(index.find(0x1040u), nullptr);
+	EXPECT_EQ(index.find(0x20ffu), &list[1]);
+	EXPECT_EQ(index.find(0x2100u), nullptr);
+	EXPECT_EQ(index.find(0x3000u), nullptr);
+	EXPECT_EQ(index.find_by_begin_rva(0x3000u), &list[2]);
+}
+
+TEST_P(RuntimeFunctionIndexTests, Empty)
+{
+	const std::vector<x64::runtime_function_details> list;
+	x64::runtime_function_index_details index(list, { .build_page_table = GetParam() });
+	EXPECT_FALSE(index.has_page_table());
+	EXPECT_EQ(index.find(0x1000u), nullptr);
+	EXPECT_EQ(x64::find_primary_function(index, 0x1000u), nullptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(RuntimeFunctionIndexPageTable,
+	RuntimeFunctionIndexTests, ::testing::Values(false, true));
@@ -0,0 +1,310 @@
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+#include "buffers/input_memory_buffer.h"
+#include "pe_bliss2/resources/streaming_manifest_accessor.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::resources;
+
+namespace
+{
+constexpr std::string_view empty_manifest(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly />)"
+);
+
+constexpr std::string_view manifest_no_decl(
+	R"(<assembly />)"
+);
+
+constexpr std::string_view double_decl(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly />)"
+);
+
+constexpr std::string_view double_root(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly />)"
+	R"(<assembly />)"
+);
+
+constexpr std::string_view xml_error(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly>)"
+);
+
+constexpr std::string_view duplicate_ns(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly xmlns:x="a" xmlns:x="b" />)"
+);
+
+constexpr std::string_view duplicate_default_ns(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly xmlns="a" xmlns="b" />)"
+);
+
+constexpr std::string_view empty_ns_name(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly xmlns:="b" />)"
+);
+
+constexpr std::string_view unknown_alias(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly unknown:attr="b" />)"
+);
+
+constexpr std::string_view empty_ns_value(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly xmlns:p="" />)"
+);
+
+constexpr std::string_view nested(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly xmlns="xmlns1ns" xmlns:xmlns2="xmlns2ns">)"
+	R"(<xmlns2:nested xmlns="xmlns3ns">)"
+	R"(<tag xmlns2:attr="val1" xmlns:xmlns2="xmlns2ovr"/>)"
+	R"(</xmlns2:nested>)"
+	R"(<nested>)"
+	R"(<tag attr="val2"/>)"
+	R"(</nested>)"
+	R"(<nested>nestedValue</nested>)"
+	R"(</assembly>)"
+);
+
+constexpr std::string_view doctype(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<!DOCTYPE assembly>)"
+	R"(<assembly />)"
+);
+
+constexpr std::string_view nested_pi(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly><?pi?></assembly>)"
+);
+
+constexpr std::string_view mismatched_tag(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly></nested>)"
+);
+
+constexpr std::string_view duplicate_attribute(
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	R"(<assembly xmlns:a="x" xmlns:b="x" a:attr="1" b:attr="2" />)"
+);
+
+constexpr std::string_view text(
+	"\xef\xbb\xbf"
+	R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+	"<!-- comment -->"
+	"<assembly attr=\"a&lt;\tb\r\nc&#x41;&unknown;\">"
+	"<a>\r\n  </a>"
+	"<b> <![CDATA[<&amp;>]]>text</b>"
+	"<c>x&amp;y&#1046;\r\nz</c>"
+	"</assembly>"
+);
+
+buffers::input_buffer_ptr buf_from_string(std::string_view str)
+{
+	const auto* ptr = reinterpret_cast<const std::byte*>(str.data());
+	return std::make_shared<buffers::input_memory_buffer>(ptr, str.size());
+}
+
+std::string to_utf16(std::u16string_view str, bool is_big_endian)
+{
+	std::string result;
+	for (auto ch : str)
+	{
+		auto low = static_cast<char>(ch & 0xffu);
+		auto high = static_cast<char>(ch >> 8u);
+		result.push_back(is_big_endian ? high : low);
+		result.push_back(is_big_endian ? low : high);
+	}
+	return result;
+}
+
+void expect_invalid_xml(std::string_view xml)
+{
+	auto accessor = streaming::parse_manifest(buf_from_string(xml));
+	expect_contains_errors(accessor->get_errors(), manifest_loader_errc::invalid_xml);
+	EXPECT_EQ(accessor->get_root(), nullptr) << xml;
+}
+} //namespace
+
+TEST(StreamingManifestAccessorTests, Empty)
+{
+	auto accessor = streaming::parse_manifest(buf_from_string(empty_manifest));
+	expect_contains_errors(accessor->get_errors());
+
+	const auto* root = accessor->get_root();
+	ASSERT_NE(root, nullptr);
+	EXPECT_EQ(root->get_child_count(), 1u);
+	auto assembly_it = root->get_iterator();
+	const auto* assembly = assembly_it->first_child("", "assembly");
+	ASSERT_NE(assembly, nullptr);
+	EXPECT_EQ(assembly->get_child_count(), 0u);
+	EXPECT_EQ(assembly->get_name(), "assembly");
+	EXPECT_EQ(assembly->get_namespace(), "");
+	EXPECT_EQ(assembly->get_node_index(), 0u);
+	EXPECT_EQ(assembly->get_value(), "");
+	EXPECT_EQ(assembly_it->next_child(), nullptr);
+}
+
+TEST(StreamingManifestAccessorTests, Invalid)
+{
+	auto accessor = streaming::parse_manifest(buf_from_string(manifest_no_decl));
+	expect_contains_errors(accessor->get_errors(), manifest_loader_errc::absent_declaration);
+	EXPECT_NE(accessor->get_root(), nullptr) << manifest_no_decl;
+
+	expect_invalid_xml(double_decl);
+	expect_invalid_xml(double_root);
+	expect_invalid_xml("");
+	expect_invalid_xml(xml_error);
+	expect_invalid_xml(duplicate_ns);
+	expect_invalid_xml(duplicate_default_ns);
+	expect_invalid_xml(empty_ns_name);
+	expect_invalid_xml(empty_ns_value);
+	expect_invalid_xml(unknown_alias);
+	expect_invalid_xml(doctype);
+	expect_invalid_xml(nested_pi);
+	expect_invalid_xml(mismatched_tag);
+	expect_invalid_xml(duplicate_attribute);
+}
+
+TEST(StreamingManifestAccessorTests, Nested)
+{
+	auto accessor = streaming::parse_manifest(buf_from_string(nested));
+	expect_contains_errors(accessor->get_errors());
+
+	const auto* root = accessor->get_root();
+	ASSERT_NE(root, nullptr);
+	const auto* assembly = root->get_iterator()->first_child("xmlns1ns", "assembly");
+	ASSERT_NE(assembly, nullptr);
+	EXPECT_EQ(assembly->get_child_count(), 3u);
+
+	auto nested_it = assembly->get_iterator();
+	const auto* xmlns1_nested = nested_it->first_child("xmlns1ns", "nested");
+	ASSERT_NE(xmlns1_nested, nullptr);
+	EXPECT_EQ(xmlns1_nested->get_child_count(), 1u);
+	EXPECT_EQ(xmlns1_nested->get_value(), "");
+	EXPECT_EQ(xmlns1_nested->get_name(), "nested");
+	EXPECT_EQ(xmlns1_nested->get_namespace(), "xmlns1ns");
+
+	auto xmlns1_nested1_it = xmlns1_nested->get_iterator();
+
+	xmlns1_nested = nested_it->next_child();
+	ASSERT_NE(xmlns1_nested, nullptr);
+	EXPECT_EQ(xmlns1_nested->get_child_count(), 0u);
+	EXPECT_EQ(xmlns1_nested->get_value(), "nestedValue");
+	EXPECT_EQ(xmlns1_nested->get_name(), "nested");
+	EXPECT_EQ(xmlns1_nested->get_namespace(), "xmlns1ns");
+
+	const auto* xmlns1_tag = xmlns1_nested1_it->first_child("xmlns1ns", "tag");
+	ASSERT_NE(xmlns1_tag, nullptr);
+	EXPECT_EQ(xmlns1_tag->get_child_count(), 0u);
+	EXPECT_EQ(xmlns1_tag->get_value(), "");
+	EXPECT_EQ(xmlns1_tag->get_name(), "tag");
+	EXPECT_EQ(xmlns1_tag->get_namespace(), "xmlns1ns");
+
+	EXPECT_EQ(xmlns1_nested1_it->next_child(), nullptr);
+
+	const auto* tag_attr = xmlns1_tag->get_attribute({}, "attr");
+	ASSERT_NE(tag_attr, nullptr);
+	EXPECT_EQ(tag_attr->get_name(), "attr");
+	EXPECT_EQ(tag_attr->get_namespace(), "");
+	EXPECT_EQ(tag_attr->get_value(), "val2");
+
+	EXPECT_EQ(nested_it->next_child(), nullptr);
+
+	const auto* xmlns2_nested = nested_it->first_child("xmlns2ns", "nested");
+	ASSERT_NE(xmlns2_nested, nullptr);
+	EXPECT_EQ(xmlns2_nested->get_child_count(), 1u);
+	EXPECT_EQ(xmlns2_nested->get_value(), "");
+	EXPECT_EQ(xmlns2_nested->get_name(), "nested");
+	EXPECT_EQ(xmlns2_nested->get_namespace(), "xmlns2ns");
+
+	auto xmlns2_nested_it = xmlns2_nested->get_iterator();
+	const auto* xmlns3_tag = xmlns2_nested_it->first_child("xmlns3ns", "tag");
+	ASSERT_NE(xmlns3_tag, nullptr);
+	EXPECT_EQ(xmlns3_tag->get_child_count(), 0u);
+	EXPECT_EQ(xmlns3_tag->get_value(), "");
+	EXPECT_EQ(xmlns3_tag->get_name(), "tag");
+	EXPECT_EQ(xmlns3_tag->get_namespace(), "xmlns3ns");
+
+	EXPECT_EQ(xmlns2_nested_it->next_child(), nullptr);
+
+	tag_attr = xmlns3_tag->get_attribute("xmlns2ovr", "attr");
+	ASSERT_NE(tag_attr, nullptr);
+	EXPECT_EQ(tag_attr->get_name(), "attr");
+	EXPECT_EQ(tag_attr->get_namespace(), "xmlns2ovr");
+	EXPECT_EQ(tag_attr->get_value(), "val1");
+
+	EXPECT_EQ(xmlns3_tag->get_attribute("xmlns3ns", "attr"), nullptr);
+}
+
+TEST(StreamingManifestAccessorTests, Text)
+{
+	auto accessor = streaming::parse_manifest(buf_from_string(text));
+	expect_contains_errors(accessor->get_errors());
+
+	const auto* root = accessor->get_root();
+	ASSERT_NE(root, nullptr);
+	EXPECT_EQ(root->get_child_count(), 1u);
+	const auto* assembly = root->get_iterator()->first_child("", "assembly");
+	ASSERT_NE(assembly, nullptr);
+	EXPECT_EQ(assembly->get_child_count(), 3u);
+
+	const auto* attr = assembly->get_attribute("", "attr");
+	ASSERT_NE(attr, nullptr);
+	EXPECT_EQ(attr->get_value(), "a< b cA&unknown;");
+
+	auto it = assembly->get_iterator();
+	const auto* a = it->first_child("", "a");
+	ASSERT_NE(a, nullptr);
+	EXPECT_EQ(a->get_value(), "");
+	EXPECT_EQ(a->get_node_index(), 0u);
+
+	const auto* b = it->first_child("", "b");
+	ASSERT_NE(b, nullptr);
+	EXPECT_EQ(b->get_value(), "<&amp;>");
+	EXPECT_EQ(b->get_node_index(), 1u);
+
+	const auto* c = it->first_child("", "c");
+	ASSERT_NE(c, nullptr);
+	EXPECT_EQ(c->get_value(), "x&y\xd0\x96\nz");
+	EXPECT_EQ(c->get_node_index(), 2u);
+}
+
+TEST(StreamingManifestAccessorTests, Utf16)
+{
+	static constexpr std::u16string_view manifest(
+		u"<?xml version=\"1.0\" encoding=\"UTF-16\"?>"
+		u"<assembly attr=\"\u0416\U0001f600\" />");
+
+	for (bool is_big_endian : { false, true })
+	{
+		for (bool has_bom : { false, true })
+		{
+			auto xml = to_utf16(has_bom ? u"\ufeff" : u"", is_big_endian)
+				+ to_utf16(manifest, is_big_endian);
+			auto accessor = streaming::parse_manifest(buf_from_string(xml));
+			expect_contains_errors(accessor->get_errors());
+
+			const auto* root = accessor->get_root();
+			ASSERT_NE(root, nullptr);
+			const auto* assembly = root->get_iterator()->first_child("", "assembly");
+			ASSERT_NE(assembly, nullptr);
+			const auto* attr = assembly->get_attribute("", "attr");
+			ASSERT_NE(attr, nullptr);
+			EXPECT_EQ(attr->get_value(), "\xd0\x96\xf0\x9f\x98\x80");
+
+			xml.pop_back();
+			expect_invalid_xml(xml);
+		}
+	}
+}
@@ -1,9 +1,18 @@
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include "buffers/input_buffer_stateful_wrapper.h"
 #include "buffers/input_container_buffer.h"
 #include "buffers/output_memory_buffer.h"
+#include "pe_bliss2/resources/resource_directory.h"
 #include "pe_bliss2/resources/resource_reader_errc.h"
+#include "pe_bliss2/resources/resource_types.h"
 #include "pe_bliss2/resources/string_table.h"
 #include "pe_bliss2/resources/string_table_reader.h"
 #include "pe_bliss2/resources/string_table_writer.h"
@@ -74,3 +83,98 @@ TEST(StringTableReaderTests, ReadValid)
 	EXPECT_NO_THROW(write_string_table(table, out));
 	EXPECT_EQ(buf.get_container(), vec);
 }
+
+namespace
+{
+using string_list = std::vector<std::pair<std::uint8_t, std::u16string_view>>;
+
+void add_string_table(resource_directory& root, string_table::id_type table_id,
+	resource_id_type language, const string_list& strings)
+{
+	auto& data = root.try_emplace_entry_by_id(
+		static_cast<resource_id_type>(resource_type::string),
+		directory_entry_contents::directory).get_directory()
+		.try_emplace_entry_by_id(table_id, directory_entry_contents::directory)
+		.get_directory()
+		.try_emplace_entry_by_id(language, directory_entry_contents::data)
+		.get_data().get_raw_data().copied_data();
+
+	auto write_word = [&data](std::uint16_t value) {
+		data.emplace_back(static_cast<std::byte>(value & 0xffu));
+		data.emplace_back(static_cast<std::byte>(value >> 8u));
+	};
+	for (std::uint8_t i = 0; i != string_table::max_string_count; ++i)
+	{
+		auto it = std::find_if(strings.cbegin(), strings.cend(),
+			[i](const auto& str) { return str.first == i; });
+		if (it == strings.cend())
+		{
+			write_word(0u);
+			continue;
+		}
+
+		write_word(static_cast<std::uint16_t>(it->second.size()));
+		for (auto ch : it->second)
+			write_word(ch);
+	}
+}
+} //namespace
+
+TEST(StringTableReaderTests, ReadArena)
+{
+	resource_directory root;
+	add_string_table(root, 2u, 1049u,
+		{ { 1u, u"abc" }, { 15u, u"\u00e9\u4e2d\U0001f600" } });
+	add_string_table(root, 2u, 1033u,
+		{ { 1u, u"x" }, { 15u, u"\u00e9\u4e2d\U0001f600" } });
+	add_string_table(root, 1u, 1033u, { { 0u, u"first" } });
+
+	auto arena = string_tables_from_resources(root, { .decode_utf8 = true });
+	ASSERT_EQ(arena.get_entries().size(), 5u);
+	EXPECT_EQ(arena.get_entries()[0].language, 1033u);
+	EXPECT_EQ(arena.get_entries()[0].string_id, 0u);
+
+	EXPECT_EQ(arena.get_string(0u, 1033u), u"first");
+	EXPECT_EQ(arena.get_string(17u, 1033u), u"x");
+	EXPECT_EQ(arena.get_string(17u, 1049u), u"abc");
+	EXPECT_EQ(arena.get_string(31u, 1049u), u"\u00e9\u4e2d\U0001f600");
+	EXPECT_FALSE(arena.get_string(16u, 1049u));
+	EXPECT_FALSE(arena.get_string(0u, 1049u));
+
+	EXPECT_EQ(arena.get_utf8_string(17u, 1049u), "abc");
+	EXPECT_EQ(arena.get_utf8_string(31u, 1049u),
+		"\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80");
+}
+
+TEST(StringTableReaderTests, ReadArenaWithoutUtf8)
+{
+	resource_directory root;
+	add_string_table(root, 1u, 1033u, { { 3u, u"abc" } });
+
+	auto arena = string_tables_from_resources(root);
+	EXPECT_EQ(arena.get_utf16_data(), u"abc");
+	EXPECT_EQ(arena.get_string(3u, 1033u), u"abc");
+	EXPECT_TRUE(arena.get_utf8_data().empty());
+	EXPECT_FALSE(arena.get_utf8_string(3u, 1033u));
+}
+
+TEST(StringTableReaderTests, ReadArenaInvalidTable)
+{
+	resource_directory root;
+	add_string_table(root, 1u, 1033u, { { 0u, u"first" } });
+	add_string_table(root, 2u, 1033u, { { 0u, u"abc" }, { 1u, u"truncated" } });
+	auto& data = root.entry_by_id(static_cast<resource_id_type>(resource_type::string))
+		.get_directory().entry_by_id(2u).get_directory().entry_by_id(1033u)
+		.get_data().get_raw_data().copied_data();
+	//Length and the first character of the string 1 are kept
+	data.resize(2u + 3u * sizeof(char16_t) + 2u + sizeof(char16_t));
+
+	auto arena = string_tables_from_resources(root, { .decode_utf8 = true });
+	expect_contains_errors(arena, resource_reader_errc::buffer_read_error);
+	ASSERT_EQ(arena.get_entries().size(), 2u);
+	EXPECT_EQ(arena.get_string(0u, 1033u), u"first");
+	EXPECT_EQ(arena.get_string(16u, 1033u), u"abc");
+	EXPECT_FALSE(arena.get_string(17u, 1033u));
+	EXPECT_EQ(arena.get_utf16_data(), u"firstabc");
+	EXPECT_EQ(arena.get_utf8_string(16u, 1033u), "abc");
+}
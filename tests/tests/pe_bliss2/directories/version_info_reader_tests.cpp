@@ -202,3 +202,71 @@ TEST(VersionInfoReaderTests, VirtualInfoError)
 	const auto& grandchild1 = child1.get_children()[0];
 	expect_contains_errors(grandchild1, version_info_reader_errc::key_read_error);
 }
+
+namespace
+{
+std::array fixed_file_info_data{
+	std::byte{92}, std::byte{}, //length
+	std::byte{52}, std::byte{}, //value_length
+	std::byte{}, std::byte{}, //type: binary
+	//key: VS_VERSION_INFO
+	std::byte{'V'}, std::byte{}, std::byte{'S'}, std::byte{}, std::byte{'_'}, std::byte{},
+	std::byte{'V'}, std::byte{}, std::byte{'E'}, std::byte{}, std::byte{'R'}, std::byte{},
+	std::byte{'S'}, std::byte{}, std::byte{'I'}, std::byte{}, std::byte{'O'}, std::byte{},
+	std::byte{'N'}, std::byte{}, std::byte{'_'}, std::byte{}, std::byte{'I'}, std::byte{},
+	std::byte{'N'}, std::byte{}, std::byte{'F'}, std::byte{}, std::byte{'O'}, std::byte{},
+	std::byte{}, std::byte{},
+	std::byte{}, std::byte{}, //padding
+	//VS_FIXEDFILEINFO
+	std::byte{0xbd}, std::byte{0x04}, std::byte{0xef}, std::byte{0xfe}, //signature
+	std::byte{}, std::byte{}, std::byte{1}, std::byte{}, //struc_version
+	std::byte{2}, std::byte{}, std::byte{1}, std::byte{}, //file_version_ms
+	std::byte{4}, std::byte{}, std::byte{3}, std::byte{}, //file_version_ls
+	std::byte{6}, std::byte{}, std::byte{5}, std::byte{}, //product_version_ms
+	std::byte{8}, std::byte{}, std::byte{7}, std::byte{}, //product_version_ls
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //file_flags_mask
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //file_flags
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //file_os
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //file_type
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //file_subtype
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //file_date_ms
+	std::byte{}, std::byte{}, std::byte{}, std::byte{}, //file_date_ls
+};
+} //namespace
+
+TEST(VersionInfoReaderTests, FixedFileInfo)
+{
+	buffers::input_memory_buffer buf(
+		fixed_file_info_data.data(), fixed_file_info_data.size());
+	buffers::input_buffer_stateful_wrapper_ref wrapper(buf);
+	auto info = fixed_file_info_from_resource(wrapper);
+	EXPECT_EQ(info.get_file_version_string(), "1.2.3.4");
+	EXPECT_EQ(info.get_product_version_string(), "5.6.7.8");
+	EXPECT_EQ(wrapper.rpos(), fixed_file_info_data.size());
+}
+
+TEST(VersionInfoReaderTests, FixedFileInfoErrors)
+{
+	auto data = fixed_file_info_data;
+	data[8] = std::byte{'X'};
+	buffers::input_memory_buffer invalid_key(data.data(), data.size());
+	expect_throw_pe_error([&invalid_key] {
+		buffers::input_buffer_stateful_wrapper_ref wrapper(invalid_key);
+		(void)fixed_file_info_from_resource(wrapper);
+	}, version_info_errc::incorrect_root_block_key);
+
+	data = fixed_file_info_data;
+	data[2] = std::byte{};
+	buffers::input_memory_buffer no_value(data.data(), data.size());
+	expect_throw_pe_error([&no_value] {
+		buffers::input_buffer_stateful_wrapper_ref wrapper(no_value);
+		(void)fixed_file_info_from_resource(wrapper);
+	}, version_info_errc::absent_file_version_info);
+
+	buffers::input_memory_buffer truncated(
+		fixed_file_info_data.data(), fixed_file_info_data.size() - 1u);
+	expect_throw_pe_error([&truncated] {
+		buffers::input_buffer_stateful_wrapper_ref wrapper(truncated);
+		(void)fixed_file_info_from_resource(wrapper);
+	}, version_info_errc::file_version_info_read_error);
+}
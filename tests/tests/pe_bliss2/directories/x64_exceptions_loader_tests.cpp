@@ -3,6 +3,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <stdexcept>
 #include <variant>
 
 #include "pe_bliss2/core/data_directories.h"
@@ -300,3 +301,58 @@ TEST_F(X64ExceptionLoaderTestFixture, ExceptionLoaderValidDirectory)
 	dir = exceptions::load(instance, {});
 	validate_dir(get_x64_dir());
 }
+
+TEST_F(X64ExceptionLoaderTestFixture, LazyAbsentDirectory)
+{
+	EXPECT_FALSE(load_lazy(instance, {}));
+}
+
+TEST_F(X64ExceptionLoaderTestFixture, LazyValidDirectory)
+{
+	add_exception_dir();
+	add_exception_dir_descriptors();
+	auto loaded = load_lazy(instance, {});
+	ASSERT_TRUE(loaded);
+	expect_contains_errors(*loaded);
+	ASSERT_EQ(loaded->size(), number_of_runtime_functions + 1u);
+	EXPECT_EQ(loaded->get_rva(2u), directory_rva + 24u);
+	EXPECT_EQ(loaded->get_descriptor(2u).unwind_info_address, unwind_info1_rva);
+	EXPECT_FALSE(loaded->is_decoded(0u));
+	EXPECT_FALSE(loaded->is_decoded(1u));
+	EXPECT_FALSE(loaded->is_decoded(2u));
+
+	const auto& function0 = loaded->get_runtime_function(1u);
+	EXPECT_TRUE(loaded->is_decoded(1u));
+	EXPECT_FALSE(loaded->is_decoded(2u));
+	EXPECT_EQ(&function0, &loaded->get_runtime_function(1u));
+	expect_contains_errors(function0,
+		exception_directory_loader_errc::push_nonvol_uwop_out_of_order);
+	EXPECT_EQ(function0.get_unwind_info().get_version(), unwind0_version);
+	EXPECT_EQ(function0.get_unwind_info().get_unwind_code_list().size(), 3u);
+	EXPECT_TRUE(std::holds_alternative<runtime_function_details::runtime_function_ptr>(
+		function0.get_additional_info()));
+
+	const auto& function1 = loaded->get_runtime_function(2u);
+	expect_contains_errors(function1,
+		exception_directory_loader_errc::invalid_exception_handler_rva);
+	EXPECT_EQ(function1.get_unwind_info().get_version(), unwind1_version);
+	const auto* handler = std::get_if<runtime_function_details::exception_handler_rva_type>(
+		&function1.get_additional_info());
+	ASSERT_NE(handler, nullptr);
+	EXPECT_EQ(handler->get(), exception_handler_rva_1);
+
+	EXPECT_THROW((void)loaded->get_runtime_function(3u), std::out_of_range);
+}
+
+TEST_F(X64ExceptionLoaderTestFixture, LazyHeaderDirectoryError)
+{
+	add_exception_dir_to_headers();
+	auto loaded = load_lazy(instance, { .include_headers = false });
+	ASSERT_TRUE(loaded);
+	expect_contains_errors(*loaded,
+		exception_directory_loader_errc::unmatched_directory_size,
+		exception_directory_loader_errc::invalid_runtime_function_entry);
+	EXPECT_TRUE(loaded->has_error(
+		exception_directory_loader_errc::invalid_runtime_function_entry, 0u));
+	EXPECT_TRUE(loaded->empty());
+}
@@ -0,0 +1,409 @@
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "pe_bliss2/core/file_header.h"
+#include "pe_bliss2/core/optional_header.h"
+#include "pe_bliss2/exceptions/x64/x64_exception_directory.h"
+#include "pe_bliss2/exceptions/x64/x64_exception_directory_loader.h"
+#include "pe_bliss2/exceptions/x64/x64_unwinder.h"
+#include "pe_bliss2/image/image.h"
+#include "tests/pe_bliss2/image_helper.h"
+#include "tests/pe_bliss2/pe_error_helper.h"
+
+using namespace pe_bliss;
+using namespace pe_bliss::exceptions::x64;
+
+namespace
+{
+
+template<typename Code>
+Code& add_code(runtime_function_details& func, std::uint8_t offset_in_prolog)
+{
+	auto& code = std::get<Code>(func.get_unwind_info().get_unwind_code_list()
+		.emplace_back(std::in_place_type<Code>));
+	code.get_descriptor()->offset_in_prolog = offset_in_prolog;
+	return code;
+}
+
+void set_range(runtime_function_details& func, rva_type begin, rva_type end)
+{
+	func.get_descriptor()->begin_address = begin;
+	func.get_descriptor()->end_address = end;
+}
+
+//push rbx; sub rsp, 0x20
+void add_push_alloc_codes(runtime_function_details& func)
+{
+	add_code<alloc_small>(func, 5u).set_allocation_size(0x20u);
+	add_code<push_nonvol>(func, 1u).set_register(register_id::rbx);
+}
+
+class X64UnwinderTestFixture : public ::testing::Test
+{
+public:
+	X64UnwinderTestFixture()
+		: stack(stack_size)
+		, unwinder_instance([this] (std::uint64_t address, std::span<std::byte> data) {
+			if (address < stack_base || address - stack_base > stack.size()
+				|| stack.size() - (address - stack_base) < data.size())
+			{
+				return false;
+			}
+			std::memcpy(data.data(), stack.data() + (address - stack_base), data.size());
+			return true;
+		})
+	{
+	}
+
+	void write_stack(std::uint64_t address, std::uint64_t value)
+	{
+		ASSERT_GE(address, stack_base);
+		ASSERT_LE(address - stack_base + sizeof(value), stack.size());
+		for (std::size_t i = 0; i != sizeof(value); ++i)
+		{
+			stack[address - stack_base + i]
+				= static_cast<std::byte>((value >> (i * 8u)) & 0xffu);
+		}
+	}
+
+	void add_image(exception_directory_details&& directory)
+	{
+		unwinder_instance.add_image(image_base, image_size, std::move(directory));
+	}
+
+	void add_default_image()
+	{
+		exception_directory_details directory;
+		auto& list = directory.get_runtime_function_list();
+
+		auto& func = list.emplace_back();
+		set_range(func, function_begin, function_end);
+		add_push_alloc_codes(func);
+
+		auto& chained = list.emplace_back();
+		set_range(chained, chained_begin, chained_end);
+		chained.get_unwind_info().set_unwind_flags(unwind_flags::chaininfo);
+		auto primary = std::make_unique<runtime_function_details>();
+		set_range(*primary, function_begin, function_end);
+		add_push_alloc_codes(*primary);
+		chained.get_additional_info() = std::move(primary);
+
+		add_image(std::move(directory));
+	}
+
+	unwind_context create_context(rva_type rva) const
+	{
+		unwind_context context;
+		context.rip = image_base + rva;
+		context.get_rsp() = stack_pointer;
+		context.get_register(register_id::rbx) = 0xdeadu;
+		return context;
+	}
+
+	void write_push_alloc_frame()
+	{
+		write_stack(stack_pointer + 0x20u, saved_rbx);
+		write_stack(stack_pointer + 0x28u, image_base + leaf_rva);
+		write_stack(stack_pointer + 0x30u, 0u);
+	}
+
+public:
+	static constexpr std::uint64_t image_base = 0x140000000ull;
+	static constexpr std::uint32_t image_size = 0x10000u;
+	static constexpr std::uint64_t stack_base = 0x7ff000ull;
+	static constexpr std::size_t stack_size = 0x1000u;
+	static constexpr std::uint64_t stack_pointer = stack_base + 0x100u;
+	static constexpr rva_type function_begin = 0x1000u;
+	static constexpr rva_type function_end = 0x1100u;
+	static constexpr rva_type chained_begin = 0x1200u;
+	static constexpr rva_type chained_end = 0x1210u;
+	static constexpr rva_type leaf_rva = 0x2010u;
+	static constexpr std::uint64_t saved_rbx = 0x1111u;
+
+public:
+	std::vector<std::byte> stack;
+	unwinder unwinder_instance;
+};
+
+} //namespace
+
+TEST_F(X64UnwinderTestFixture, FunctionBody)
+{
+	add_default_image();
+	write_push_alloc_frame();
+
+	auto context = create_context(function_begin + 0x50u);
+	const auto* func = unwinder_instance.unwind(context);
+	ASSERT_NE(func, nullptr);
+	EXPECT_EQ(func->get_descriptor()->begin_address, function_begin);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 0x30u);
+	EXPECT_EQ(context.get_register(register_id::rbx), saved_rbx);
+}
+
+TEST_F(X64UnwinderTestFixture, Prolog)
+{
+	add_default_image();
+	write_stack(stack_pointer, saved_rbx);
+	write_stack(stack_pointer + 8u, image_base + leaf_rva);
+
+	//push rbx is executed, sub rsp is not
+	auto context = create_context(function_begin + 3u);
+	ASSERT_NE(unwinder_instance.unwind(context), nullptr);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 0x10u);
+	EXPECT_EQ(context.get_register(register_id::rbx), saved_rbx);
+
+	//Nothing is executed
+	context = create_context(function_begin);
+	write_stack(stack_pointer, image_base + leaf_rva);
+	ASSERT_NE(unwinder_instance.unwind(context), nullptr);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 8u);
+	EXPECT_EQ(context.get_register(register_id::rbx), 0xdeadu);
+}
+
+TEST_F(X64UnwinderTestFixture, ChainedFunction)
+{
+	add_default_image();
+	write_push_alloc_frame();
+
+	//Chained codes are always executed
+	auto context = create_context(chained_begin);
+	const auto* func = unwinder_instance.unwind(context);
+	ASSERT_NE(func, nullptr);
+	EXPECT_EQ(func->get_descriptor()->begin_address, chained_begin);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 0x30u);
+	EXPECT_EQ(context.get_register(register_id::rbx), saved_rbx);
+}
+
+TEST_F(X64UnwinderTestFixture, FramePointer)
+{
+	exception_directory_details directory;
+	auto& func = directory.get_runtime_function_list().emplace_back();
+	set_range(func, function_begin, function_end);
+	//push rbp; sub rsp, 0x40; lea rbp, [rsp + 0x20]
+	func.get_unwind_info().set_frame_register(register_id::rbp);
+	func.get_unwind_info().set_scaled_frame_register_offset(0x20u);
+	add_code<set_fpreg>(func, 10u);
+	add_code<alloc_small>(func, 5u).set_allocation_size(0x40u);
+	add_code<push_nonvol>(func, 1u).set_register(register_id::rbp);
+	add_image(std::move(directory));
+
+	static constexpr std::uint64_t saved_rbp = 0x2222u;
+	write_stack(stack_pointer + 0x40u, saved_rbp);
+	write_stack(stack_pointer + 0x48u, image_base + leaf_rva);
+
+	auto context = create_context(function_begin + 0x30u);
+	//Dynamic stack allocation
+	context.get_rsp() = stack_pointer - 0x80u;
+	context.get_register(register_id::rbp) = stack_pointer + 0x20u;
+	ASSERT_NE(unwinder_instance.unwind(context), nullptr);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 0x50u);
+	EXPECT_EQ(context.get_register(register_id::rbp), saved_rbp);
+}
+
+TEST_F(X64UnwinderTestFixture, FramePointerSaveNonvol)
+{
+	exception_directory_details directory;
+	auto& func = directory.get_runtime_function_list().emplace_back();
+	set_range(func, function_begin, function_end);
+	//push rbp; sub rsp, 0x40; lea rbp, [rsp + 0x20];
+	//mov [rsp + 0x30], rbx; movaps [rsp + 0x10], xmm6
+	func.get_unwind_info().set_frame_register(register_id::rbp);
+	func.get_unwind_info().set_scaled_frame_register_offset(0x20u);
+	auto& xmm = add_code<save_xmm128>(func, 20u);
+	xmm.set_register(register_id::rsi);
+	xmm.set_stack_offset(0x10u);
+	auto& nonvol = add_code<save_nonvol>(func, 15u);
+	nonvol.set_register(register_id::rbx);
+	nonvol.set_stack_offset(0x30u);
+	add_code<set_fpreg>(func, 10u);
+	add_code<alloc_small>(func, 5u).set_allocation_size(0x40u);
+	add_code<push_nonvol>(func, 1u).set_register(register_id::rbp);
+	add_image(std::move(directory));
+
+	static constexpr std::uint64_t saved_rbp = 0x2222u;
+	write_stack(stack_pointer + 0x10u, 0x4444u);
+	write_stack(stack_pointer + 0x18u, 0x5555u);
+	write_stack(stack_pointer + 0x30u, saved_rbx);
+	write_stack(stack_pointer + 0x40u, saved_rbp);
+	write_stack(stack_pointer + 0x48u, image_base + leaf_rva);
+
+	auto context = create_context(function_begin + 0x30u);
+	//Dynamic stack allocation
+	context.get_rsp() = stack_pointer - 0x80u;
+	context.get_register(register_id::rbp) = stack_pointer + 0x20u;
+	ASSERT_NE(unwinder_instance.unwind(context), nullptr);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 0x50u);
+	EXPECT_EQ(context.get_register(register_id::rbp), saved_rbp);
+	EXPECT_EQ(context.get_register(register_id::rbx), saved_rbx);
+	EXPECT_EQ(context.xmm[6], (xmm_register{ 0x4444u, 0x5555u }));
+}
+
+TEST_F(X64UnwinderTestFixture, SaveNonvolAndXmm)
+{
+	exception_directory_details directory;
+	auto& func = directory.get_runtime_function_list().emplace_back();
+	set_range(func, function_begin, function_end);
+	auto& xmm = add_code<save_xmm128>(func, 12u);
+	xmm.set_register(register_id::rbx);
+	xmm.set_stack_offset(0x20u);
+	auto& nonvol = add_code<save_nonvol>(func, 8u);
+	nonvol.set_register(register_id::rsi);
+	nonvol.set_stack_offset(0x10u);
+	add_code<alloc_small>(func, 4u).set_allocation_size(0x38u);
+	add_image(std::move(directory));
+
+	write_stack(stack_pointer + 0x10u, 0x3333u);
+	write_stack(stack_pointer + 0x20u, 0x4444u);
+	write_stack(stack_pointer + 0x28u, 0x5555u);
+	write_stack(stack_pointer + 0x38u, image_base + leaf_rva);
+
+	auto context = create_context(function_begin + 0x20u);
+	ASSERT_NE(unwinder_instance.unwind(context), nullptr);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 0x40u);
+	EXPECT_EQ(context.get_register(register_id::rsi), 0x3333u);
+	EXPECT_EQ(context.xmm[3], (xmm_register{ 0x4444u, 0x5555u }));
+}
+
+TEST_F(X64UnwinderTestFixture, MachineFrame)
+{
+	exception_directory_details directory;
+	auto& func = directory.get_runtime_function_list().emplace_back();
+	set_range(func, function_begin, function_end);
+	add_code<push_machframe>(func, 0u).set_push_error_code(true);
+	add_image(std::move(directory));
+
+	write_stack(stack_pointer + 8u, image_base + leaf_rva);
+	write_stack(stack_pointer + 32u, stack_pointer + 0x200u);
+
+	auto context = create_context(function_begin + 0x10u);
+	ASSERT_NE(unwinder_instance.unwind(context), nullptr);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 0x200u);
+}
+
+TEST_F(X64UnwinderTestFixture, Walk)
+{
+	add_default_image();
+	write_push_alloc_frame();
+
+	auto trace = unwinder_instance.walk(create_context(function_begin + 0x50u));
+	expect_contains_errors(trace);
+	const auto& frames = trace.get_frames();
+	ASSERT_EQ(frames.size(), 2u);
+	EXPECT_EQ(frames[0].rip, image_base + function_begin + 0x50u);
+	EXPECT_EQ(frames[0].rsp, stack_pointer);
+	ASSERT_NE(frames[0].function, nullptr);
+	EXPECT_EQ(frames[0].function->get_descriptor()->begin_address, function_begin);
+	EXPECT_EQ(frames[1].rip, image_base + leaf_rva);
+	EXPECT_EQ(frames[1].rsp, stack_pointer + 0x30u);
+	EXPECT_EQ(frames[1].function, nullptr);
+
+	trace = unwinder_instance.walk(create_context(function_begin + 0x50u),
+		{ .max_frames = 1u });
+	expect_contains_errors(trace);
+	EXPECT_EQ(trace.get_frames().size(), 1u);
+}
+
+TEST_F(X64UnwinderTestFixture, WalkErrors)
+{
+	add_default_image();
+	write_push_alloc_frame();
+	//Return address outside of registered images
+	write_stack(stack_pointer + 0x30u, 0x1000u);
+
+	auto trace = unwinder_instance.walk(create_context(function_begin + 0x50u));
+	expect_contains_errors(trace, unwinder_errc::unknown_instruction_pointer);
+	EXPECT_TRUE(trace.has_error(unwinder_errc::unknown_instruction_pointer, 2u));
+	EXPECT_EQ(trace.get_frames().size(), 3u);
+
+	auto context = create_context(leaf_rva);
+	context.get_rsp() = stack_base + stack_size;
+	trace = unwinder_instance.walk(context);
+	expect_contains_errors(trace, unwinder_errc::unable_to_read_memory);
+	EXPECT_EQ(trace.get_frames().size(), 1u);
+}
+
+TEST_F(X64UnwinderTestFixture, InvalidUnwindInfo)
+{
+	exception_directory_details directory;
+	auto& func = directory.get_runtime_function_list().emplace_back();
+	set_range(func, function_begin, function_end);
+	func.add_error(exception_directory_loader_errc::invalid_unwind_info);
+	auto& func_fp = directory.get_runtime_function_list().emplace_back();
+	set_range(func_fp, function_end, function_end + 0x10u);
+	//No frame register
+	add_code<set_fpreg>(func_fp, 0u);
+	add_image(std::move(directory));
+
+	auto context = create_context(function_begin);
+	expect_throw_pe_error([&] { (void)unwinder_instance.unwind(context); },
+		unwinder_errc::invalid_unwind_info);
+	EXPECT_EQ(context.rip, image_base + function_begin);
+
+	context = create_context(function_end);
+	expect_throw_pe_error([&] { (void)unwinder_instance.unwind(context); },
+		unwinder_errc::invalid_unwind_info);
+}
+
+TEST_F(X64UnwinderTestFixture, UnwindProgramCache)
+{
+	add_default_image();
+	const auto& func = *unwinder_instance.walk(create_context(function_begin))
+		.get_frames()[0].function;
+	const auto& program = unwinder_instance.get_unwind_program(func);
+	EXPECT_FALSE(program.error);
+	ASSERT_EQ(program.operations.size(), 2u);
+	EXPECT_EQ(program.operations[0].operation, unwind_operation::type::allocate);
+	EXPECT_EQ(program.operations[0].value, 0x20u);
+	EXPECT_EQ(program.operations[1].operation, unwind_operation::type::push_register);
+	EXPECT_EQ(&program, &unwinder_instance.get_unwind_program(func));
+
+	runtime_function_details unknown;
+	expect_throw_pe_error([&] { (void)unwinder_instance.get_unwind_program(unknown); },
+		unwinder_errc::unknown_runtime_function);
+}
+
+TEST_F(X64UnwinderTestFixture, OverlappingImages)
+{
+	add_image({});
+	expect_throw_pe_error([&] {
+		unwinder_instance.add_image(image_base + image_size - 1u, 1u, {}); },
+		unwinder_errc::overlapping_images);
+	expect_throw_pe_error([&] {
+		unwinder_instance.add_image(image_base - 1u, 2u, {}); },
+		unwinder_errc::overlapping_images);
+	EXPECT_NO_THROW(unwinder_instance.add_image(image_base + image_size, 1u, {}));
+	EXPECT_NO_THROW(unwinder_instance.add_image(image_base - 1u, 1u, {}));
+	EXPECT_EQ(unwinder_instance.get_image_count(), 3u);
+}
+
+TEST_F(X64UnwinderTestFixture, AddImage)
+{
+	auto instance = create_test_image({ .is_x64 = true });
+	instance.get_file_header().set_machine_type(
+		core::file_header::machine_type::amd64);
+	instance.get_optional_header().set_raw_size_of_image(image_size);
+	unwinder_instance.add_image(instance, image_base);
+	EXPECT_EQ(unwinder_instance.get_image_count(), 1u);
+
+	write_stack(stack_pointer, image_base + leaf_rva);
+	auto context = create_context(0x10u);
+	EXPECT_EQ(unwinder_instance.unwind(context), nullptr);
+	EXPECT_EQ(context.rip, image_base + leaf_rva);
+	EXPECT_EQ(context.get_rsp(), stack_pointer + 8u);
+}
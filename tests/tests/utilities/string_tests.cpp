@@ -57,3 +57,24 @@ TEST(StringTests, Trim)
 	trim(s2);
 	EXPECT_EQ(s2, "");
 }
+
+TEST(StringTests, EncodeUtf8)
+{
+	char buf[4]{};
+	EXPECT_EQ(encode_utf8(U'a', buf), buf + 1);
+	EXPECT_EQ(buf[0], 'a');
+	EXPECT_EQ(encode_utf8(0x10ffffu, buf), buf + 4);
+	EXPECT_EQ(std::string(buf, 4), "\xf4\x8f\xbf\xbf");
+}
+
+TEST(StringTests, AppendUtf8)
+{
+	std::string result("x");
+	append_utf8(u"a\u00e9\u4e2d\U0001f600", result);
+	EXPECT_EQ(result, "xa\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80");
+
+	result.clear();
+	//Unpaired high and low surrogates
+	append_utf8(std::u16string_view(u"\xd83d" u"a" u"\xde00", 3u), result);
+	EXPECT_EQ(result, "\xef\xbf\xbd" "a" "\xef\xbf\xbd");
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <string>
 #include <string_view>
 
@@ -49,4 +51,57 @@ constexpr std::string_view trim_copy(std::string_view str) noexcept
 	return str;
 }
 
+//Writes UTF-8 representation (1 to 4 bytes) of the code point
+//to the output iterator. The code point must not exceed 0x10ffff.
+template<typename OutputIt>
+constexpr OutputIt encode_utf8(char32_t code_point, OutputIt out)
+{
+	if (code_point < 0x80u)
+	{
+		*out++ = static_cast<char>(code_point);
+	}
+	else if (code_point < 0x800u)
+	{
+		*out++ = static_cast<char>(0xc0u | (code_point >> 6u));
+		*out++ = static_cast<char>(0x80u | (code_point & 0x3fu));
+	}
+	else if (code_point < 0x10000u)
+	{
+		*out++ = static_cast<char>(0xe0u | (code_point >> 12u));
+		*out++ = static_cast<char>(0x80u | ((code_point >> 6u) & 0x3fu));
+		*out++ = static_cast<char>(0x80u | (code_point & 0x3fu));
+	}
+	else
+	{
+		*out++ = static_cast<char>(0xf0u | (code_point >> 18u));
+		*out++ = static_cast<char>(0x80u | ((code_point >> 12u) & 0x3fu));
+		*out++ = static_cast<char>(0x80u | ((code_point >> 6u) & 0x3fu));
+		*out++ = static_cast<char>(0x80u | (code_point & 0x3fu));
+	}
+	return out;
+}
+
+//Appends UTF-8 representation of the UTF-16 string to the result.
+//Unpaired surrogates are replaced with U+FFFD.
+inline void append_utf8(std::u16string_view str, std::string& result)
+{
+	auto out = std::back_inserter(result);
+	for (std::size_t i = 0; i != str.size(); ++i)
+	{
+		char32_t code_point = str[i];
+		if (code_point >= 0xd800u && code_point <= 0xdbffu && i + 1u != str.size()
+			&& str[i + 1u] >= 0xdc00u && str[i + 1u] <= 0xdfffu)
+		{
+			code_point = 0x10000u + ((code_point - 0xd800u) << 10u)
+				+ (str[++i] - 0xdc00u);
+		}
+		else if (code_point >= 0xd800u && code_point <= 0xdfffu)
+		{
+			code_point = 0xfffdu;
+		}
+
+		out = encode_utf8(code_point, out);
+	}
+}
+
 } //namespace utilities